@@ -0,0 +1,301 @@
+#include <stdlib.h>
+#include "batch.h"
+#include "geometry.h"
+#include "parallel.h"
+#include "scratch.h"
+
+/** Minimum number of vertices a thread takes from its range at once */
+#define BATCH_GRAIN_VERTICES 4096
+
+/**
+ * @struct RingRange
+ * @brief Range of rings still to be processed by one thread
+ */
+typedef struct {
+    Mutex lock;
+    int64_t begin;
+    int64_t end;
+} RingRange;
+
+/**
+ * @struct StealContext
+ * @brief State shared by the threads of a parallel batch
+ */
+typedef struct {
+    const BatchJob* job;
+    RingRange* ranges;
+    int* status;
+    int num_threads;
+} StealContext;
+
+/**
+ * @brief Find the first ring in [lo, hi] whose offset is at least value
+ *
+ * @param offsets Ring offsets
+ * @param lo      First candidate ring
+ * @param hi      Last candidate ring
+ * @param value   Offset to search for
+ * @return int64_t Ring index in [lo, hi]
+ */
+static int64_t ring_lower_bound(const int64_t* offsets, int64_t lo, int64_t hi,
+                                int64_t value) {
+    while (lo < hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        if (offsets[mid] < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief Take the next chunk of rings from the front of a thread's range
+ *
+ * @param job   Batch job description
+ * @param range Range owned by the calling thread
+ * @param begin Receives the first ring of the chunk
+ * @param end   Receives one past the last ring of the chunk
+ * @return int 1 if a chunk was taken, 0 if the range is empty
+ */
+static int take_chunk(const BatchJob* job, RingRange* range,
+                      int64_t* begin, int64_t* end) {
+    int taken = 0;
+    mutex_lock(&range->lock);
+    if (range->begin < range->end) {
+        *begin = range->begin;
+        *end = ring_lower_bound(job->offsets, *begin + 1, range->end,
+                                job->offsets[*begin] + BATCH_GRAIN_VERTICES);
+        range->begin = *end;
+        taken = 1;
+    }
+    mutex_unlock(&range->lock);
+    return taken;
+}
+
+/**
+ * @brief Move the back half of another thread's range to the calling thread
+ *
+ * The victim range is split by vertex count rather than ring count, so a
+ * thief never leaves a victim alone with a long tail of large rings.
+ *
+ * @param ctx    Shared batch state
+ * @param thread Index of the stealing thread
+ * @return int 1 if work was stolen, 0 if every range is empty
+ */
+static int steal_work(StealContext* ctx, int thread) {
+    const int64_t* offsets = ctx->job->offsets;
+
+    for (int i = 1; i < ctx->num_threads; i++) {
+        RingRange* victim = &ctx->ranges[(thread + i) % ctx->num_threads];
+        int64_t begin = 0, end = 0;
+
+        mutex_lock(&victim->lock);
+        if (victim->begin < victim->end) {
+            int64_t half = offsets[victim->begin] +
+                           (offsets[victim->end] - offsets[victim->begin]) / 2;
+            begin = ring_lower_bound(offsets, victim->begin + 1, victim->end, half);
+            if (begin == victim->end)
+                begin = victim->end - 1;
+            end = victim->end;
+            victim->end = begin;
+        }
+        mutex_unlock(&victim->lock);
+
+        if (begin < end) {
+            RingRange* own = &ctx->ranges[thread];
+            mutex_lock(&own->lock);
+            own->begin = begin;
+            own->end = end;
+            mutex_unlock(&own->lock);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Worker loop of a parallel batch
+ *
+ * @param arg       Shared StealContext
+ * @param thread_id Index of the calling thread
+ */
+static void steal_worker(void* arg, int thread_id) {
+    StealContext* ctx = (StealContext*)arg;
+    Workspace* ws = scratch_acquire(0);
+    int64_t begin, end;
+
+    if (!ws) {
+        ctx->status[thread_id] = -1;
+        return;
+    }
+
+    for (;;) {
+        if (!take_chunk(ctx->job, &ctx->ranges[thread_id], &begin, &end)) {
+            if (!steal_work(ctx, thread_id))
+                break;
+            continue;
+        }
+        if (batch_run_range(ws, ctx->job, begin, end) != 0) {
+            ctx->status[thread_id] = -1;
+            break;
+        }
+    }
+
+    scratch_release(ws);
+}
+
+int batch_run_range(Workspace* ws, const BatchJob* job, int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+        Coords ring = coords_slice(&job->coords, job->offsets[r]);
+        VertexIndex num_points = job->ring_vertices[r];
+        size_t point_size = job->indices ? sizeof(int64_t) : ring.dims * coord_size(ring.type);
+        int started = 0;
+
+        for (int k = 0; k < job->num_resolutions; k++) {
+            int j = job->order[k];
+            int target = job->resolutions[j];
+            void* result_data = (char*)job->out_coords[j] + point_size * job->out_offsets[j][r];
+
+            if (target >= num_points) {
+                if (job->indices)
+                    copy_ring_indices(num_points, job->closed, job->offsets[r], result_data);
+                else
+                    copy_ring(&ring, num_points, job->closed, result_data);
+                continue;
+            }
+
+            if (!started) {
+                if (workspace_reserve(ws, num_points) != 0)
+                    return -1;
+                ws->metric = job->metric;
+                simplify_begin(ws, &ring, num_points, job->closed);
+                started = 1;
+            }
+            simplify_to(ws, &ring, target);
+            if (job->indices)
+                extract_indices(ws->links, first_active_vertex(ws), target, job->closed,
+                                job->offsets[r], result_data);
+            else
+                extract_simplified(&ring, ws->links, first_active_vertex(ws), target,
+                                   job->closed, result_data);
+        }
+    }
+    return 0;
+}
+
+int batch_run(const BatchJob* job, int num_threads) {
+    if (num_threads > job->num_rings)
+        num_threads = job->num_rings > 0 ? (int)job->num_rings : 1;
+
+    if (num_threads <= 1) {
+        Workspace* ws = scratch_acquire(0);
+        if (!ws)
+            return -1;
+        int status = batch_run_range(ws, job, 0, job->num_rings);
+        scratch_release(ws);
+        return status;
+    }
+
+    RingRange* ranges = malloc(num_threads * sizeof(RingRange));
+    int* status = calloc(num_threads, sizeof(int));
+    if (!ranges || !status) {
+        free(ranges);
+        free(status);
+        return -1;
+    }
+
+    // Initial split into ranges of roughly equal vertex count
+    const int64_t* offsets = job->offsets;
+    int64_t total = offsets[job->num_rings] - offsets[0];
+    for (int t = 0; t < num_threads; t++) {
+        mutex_init(&ranges[t].lock);
+        ranges[t].begin = t == 0 ? 0 : ranges[t - 1].end;
+        ranges[t].end = t == num_threads - 1 ? job->num_rings :
+            ring_lower_bound(offsets, ranges[t].begin, job->num_rings,
+                             offsets[0] + total * (t + 1) / num_threads);
+    }
+
+    StealContext ctx = {job, ranges, status, num_threads};
+    parallel_run(num_threads, steal_worker, &ctx);
+
+    int result = 0;
+    for (int t = 0; t < num_threads; t++) {
+        if (status[t] != 0)
+            result = -1;
+        mutex_destroy(&ranges[t].lock);
+    }
+
+    free(ranges);
+    free(status);
+    return result;
+}
+
+/**
+ * @brief Move order[idx] down the first end entries of a sort_indices heap
+ */
+static void sift_index(int* order, int idx, int end, const void* values,
+                       int (*before)(const void* values, int a, int b)) {
+    for (;;) {
+        int child = 2 * idx + 1;
+        if (child >= end)
+            break;
+        if (child + 1 < end && before(values, order[child], order[child + 1]))
+            child++;
+        if (!before(values, order[idx], order[child]))
+            break;
+        int temp = order[idx];
+        order[idx] = order[child];
+        order[child] = temp;
+        idx = child;
+    }
+}
+
+/**
+ * @brief Sort an array of indices by an ordering of the values they refer to
+ *
+ * Heapsort on the indices, so dense resolution ladders of thousands of
+ * targets sort in O(count log count) without allocating. Ties must be
+ * broken by before itself, e.g. by index, as heapsort is not stable.
+ *
+ * @param order  Array of count indices into values, sorted in place
+ * @param count  Number of indices
+ * @param values Values the indices refer to
+ * @param before Nonzero if index a goes before index b
+ */
+static void sort_indices(int* order, int count, const void* values,
+                         int (*before)(const void* values, int a, int b)) {
+    // Build a heap whose root goes last, then move the root behind the heap
+    for (int idx = count / 2 - 1; idx >= 0; idx--)
+        sift_index(order, idx, count, values, before);
+    for (int end = count - 1; end > 0; end--) {
+        int temp = order[0];
+        order[0] = order[end];
+        order[end] = temp;
+        sift_index(order, 0, end, values, before);
+    }
+}
+
+/** sort_indices ordering by descending resolution */
+static int resolution_before(const void* values, int a, int b) {
+    const int* resolutions = (const int*)values;
+    return resolutions[a] > resolutions[b] || (resolutions[a] == resolutions[b] && a < b);
+}
+
+/** sort_indices ordering by ascending threshold */
+static int threshold_before(const void* values, int a, int b) {
+    const double* thresholds = (const double*)values;
+    return thresholds[a] < thresholds[b] || (thresholds[a] == thresholds[b] && a < b);
+}
+
+void order_resolutions(const int* resolutions, int num_resolutions, int* order) {
+    for (int i = 0; i < num_resolutions; i++)
+        order[i] = i;
+    sort_indices(order, num_resolutions, resolutions, resolution_before);
+}
+
+void order_thresholds(const double* thresholds, int num_thresholds, int* order) {
+    for (int i = 0; i < num_thresholds; i++)
+        order[i] = i;
+    sort_indices(order, num_thresholds, thresholds, threshold_before);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file batch.h
+ * @brief Simplification of many rings stored in a flat coordinate buffer
+ *
+ * This header defines a batch job over the ragged ring layout used by
+ * simplify_batch and the functions that run it, either on the calling
+ * thread or on a pool of threads that balance skewed ring sizes by
+ * stealing work from each other, and the ordering of resolution and
+ * threshold ladders that every entry point shares.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+#include "simplify.h"
+
+/**
+ * @struct BatchJob
+ * @brief Description of one batch simplification
+ *
+ * @param coords          Coordinates of all rings
+ * @param offsets         Ring offsets into coords, num_rings + 1 entries
+ * @param ring_vertices   Number of distinct vertices of every ring
+ * @param num_rings       Number of rings
+ * @param resolutions     Target resolutions
+ * @param order           Resolution indices sorted by descending resolution
+ * @param num_resolutions Number of resolutions
+ * @param out_coords      Output coordinates in the input storage type, one
+ *                        buffer of interleaved points with every column of
+ *                        the input per resolution, or int64 input positions
+ *                        if indices is set
+ * @param out_offsets     Output ring offsets, one array per resolution
+ * @param closed          Nonzero for rings, zero for open lines
+ * @param metric          Effective area used to rank vertices
+ * @param indices         Nonzero to write the position of every kept vertex
+ *                        in coords instead of its coordinates
+ */
+typedef struct {
+    Coords coords;
+    const int64_t* offsets;
+    const VertexIndex* ring_vertices;
+    int64_t num_rings;
+    const int* resolutions;
+    const int* order;
+    int num_resolutions;
+    void* const* out_coords;
+    const int64_t* const* out_offsets;
+    int closed;
+    AreaMetric metric;
+    int indices;
+} BatchJob;
+
+/**
+ * @brief Simplify the rings [begin, end) of a batch job
+ *
+ * @param ws    Workspace to use, grown as needed
+ * @param job   Batch job description
+ * @param begin First ring to process
+ * @param end   One past the last ring to process
+ * @return int 0 on success, -1 if the workspace could not be grown
+ */
+int batch_run_range(Workspace* ws, const BatchJob* job, int64_t begin, int64_t end);
+
+/**
+ * @brief Simplify every ring of a batch job
+ *
+ * With more than one thread, rings are first split into contiguous ranges
+ * of roughly equal vertex count, one per thread. Each thread has its own
+ * workspace and takes small chunks from the front of its range; a thread
+ * that runs out steals the back half of another thread's remaining range.
+ *
+ * @param job         Batch job description
+ * @param num_threads Number of threads to use
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int batch_run(const BatchJob* job, int num_threads);
+
+/**
+ * @brief Order resolution indices by descending resolution
+ *
+ * Fills order with the indices of resolutions such that
+ * resolutions[order[0]] >= resolutions[order[1]] >= ..., equal
+ * resolutions keeping their input order. Runs in
+ * O(num_resolutions log num_resolutions) without allocating.
+ *
+ * @param resolutions Array of target resolutions
+ * @param num_resolutions Number of resolutions
+ * @param order Output array of num_resolutions indices
+ */
+void order_resolutions(const int* resolutions, int num_resolutions, int* order);
+
+/**
+ * @brief Order threshold indices by ascending threshold
+ *
+ * @param thresholds Array of area thresholds
+ * @param num_thresholds Number of thresholds
+ * @param order Output array of num_thresholds indices
+ */
+void order_thresholds(const double* thresholds, int num_thresholds, int* order);
+
+#endif /* BATCH_H */
@@ -0,0 +1,155 @@
+/**
+ * @file bench_heap.c
+ * @brief Compare the lazy binary heap with the indexed d-ary heap
+ *
+ * Runs the full Visvalingam-Whyatt elimination on synthetic rings of 10^4
+ * to 10^7 vertices, once with the original binary MinHeap (pushing a new
+ * entry on every area change and skipping stale ones) and once with the
+ * engine's IndexedMinHeap. Both build their initial heap in bulk, and the
+ * MinHeap is reused across rings with heap_reset. Build it once per heap layout to compare
+ * arities, for example from the repository root:
+ *
+ *     cc -O3 -march=native -DHEAP_ARITY=2 -I. benchmarks/bench_heap.c \
+ *        simplify.c segment_grid.c min_heap.c geometry.c -lm -o bench_heap2
+ *     cc -O3 -march=native -DHEAP_ARITY=8 -DHEAP_SIMD -I. benchmarks/bench_heap.c \
+ *        simplify.c segment_grid.c min_heap.c geometry.c -lm -o bench_heap8
+ *
+ * An optional argument caps the largest ring size.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "geometry.h"
+#include "min_heap.h"
+#include "simplify.h"
+
+/**
+ * @brief Wall-clock time in seconds
+ */
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Generate a noisy circle of num_points vertices
+ *
+ * @param num_points Number of vertices
+ * @param seed       Random seed
+ * @return double* Newly allocated interleaved x,y coordinates
+ */
+static double* make_ring(int num_points, unsigned seed) {
+    double* points = malloc(2 * (size_t)num_points * sizeof(double));
+    double radius = 1000.0;
+    srand(seed);
+    for (int i = 0; i < num_points; i++) {
+        double t = 2.0 * 3.14159265358979323846 * i / num_points;
+        radius += (rand() / (double)RAND_MAX - 0.5);
+        points[2 * i] = radius * cos(t);
+        points[2 * i + 1] = radius * sin(t);
+    }
+    return points;
+}
+
+/**
+ * @brief Elimination loop as it was written for the lazy binary heap
+ *
+ * @param heap       Heap to use, emptied first
+ * @param points     Ring coordinates
+ * @param num_points Number of vertices
+ * @param target     Number of vertices to keep
+ * @param pops       Receives the number of heap pops
+ */
+static void simplify_lazy(MinHeap* heap, const double* points, int num_points, int target,
+                          long* pops) {
+    int* prev_vertex = malloc(num_points * sizeof(int));
+    int* next_vertex = malloc(num_points * sizeof(int));
+    char* active = malloc(num_points);
+    double* areas = malloc(num_points * sizeof(double));
+    HeapItem* items = malloc(num_points * sizeof(HeapItem));
+    heap_reset(heap);
+
+    for (int i = 0; i < num_points; i++) {
+        prev_vertex[i] = (i - 1 + num_points) % num_points;
+        next_vertex[i] = (i + 1) % num_points;
+        active[i] = 1;
+    }
+    for (int i = 0; i < num_points; i++) {
+        areas[i] = triangle_area(&points[2 * prev_vertex[i]], &points[2 * i],
+                                 &points[2 * next_vertex[i]]);
+        items[i].area = areas[i];
+        items[i].index = i;
+    }
+    heap_build(heap, items, num_points);
+    free(items);
+
+    int active_count = num_points;
+    *pops = 0;
+    while (active_count > target) {
+        HeapItem min_item = heap_pop(heap);
+        (*pops)++;
+        int vertex_idx = (int)min_item.index;
+        if (!active[vertex_idx] || min_item.area != areas[vertex_idx])
+            continue;
+
+        active[vertex_idx] = 0;
+        active_count--;
+        int prev_idx = prev_vertex[vertex_idx];
+        int next_idx = next_vertex[vertex_idx];
+        next_vertex[prev_idx] = next_idx;
+        prev_vertex[next_idx] = prev_idx;
+
+        for (int adj_idx = 0; adj_idx < 2; adj_idx++) {
+            int idx = adj_idx == 0 ? prev_idx : next_idx;
+            areas[idx] = triangle_area(&points[2 * prev_vertex[idx]], &points[2 * idx],
+                                       &points[2 * next_vertex[idx]]);
+            heap_push(heap, areas[idx], idx);
+        }
+    }
+
+    free(prev_vertex);
+    free(next_vertex);
+    free(active);
+    free(areas);
+}
+
+int main(int argc, char** argv) {
+    int max_points = argc > 1 ? atoi(argv[1]) : 10000000;
+
+    printf("HEAP_ARITY=%d%s\n", HEAP_ARITY,
+#if defined(HEAP_SIMD) && defined(__AVX__)
+           " (AVX)"
+#else
+           ""
+#endif
+    );
+    printf("%10s %12s %12s %12s %10s\n", "vertices", "lazy ms", "indexed ms",
+           "lazy pops", "speedup");
+
+    MinHeap* heap = heap_create(16);
+    for (int num_points = 10000; num_points <= max_points; num_points *= 10) {
+        double* points = make_ring(num_points, 42);
+        long pops;
+
+        double start = now_seconds();
+        simplify_lazy(heap, points, num_points, 3, &pops);
+        double lazy = now_seconds() - start;
+
+        start = now_seconds();
+        Coords coords = coords_interleaved(points);
+        Workspace* ws = workspace_create(num_points);
+        simplify_begin(ws, &coords, num_points, 1);
+        simplify_to(ws, &coords, 3);
+        workspace_destroy(ws);
+        double indexed = now_seconds() - start;
+
+        printf("%10d %12.2f %12.2f %12ld %9.2fx\n", num_points, lazy * 1e3,
+               indexed * 1e3, pops, lazy / indexed);
+        free(points);
+    }
+    heap_destroy(heap);
+    return 0;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file bench_native.c
+ * @brief Time the engine through the C API of vw.h, without Python
+ *
+ * Measures vw_simplify to three resolutions and vw_index_build on noisy
+ * rings of 10^3 to 10^7 vertices, and vw_simplify_batch on 10^5 rings of
+ * 10 to 1000 vertices with one thread and with every CPU. Every case is
+ * repeated until it has run for a quarter of a second and reports its
+ * best time in milliseconds and input vertices per second. It only uses
+ * vw.h, the way a C or C++ program links the library; from the
+ * repository root:
+ *
+ *     python setup.py build_clib -b .
+ *     cc -O3 -I. benchmarks/bench_native.c -L. -lvisvalingam -lm -pthread -o bench_native
+ *
+ * The optional arguments cap the largest ring size and set the thread
+ * count of the parallel batch.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "vw.h"
+
+/** Least total time spent repeating one case, in seconds */
+#define MIN_TOTAL_SECONDS 0.25
+
+/**
+ * @brief Wall-clock time in seconds
+ */
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Write a noisy circle of num_points vertices
+ *
+ * @param points     Destination for num_points interleaved x,y pairs
+ * @param num_points Number of vertices
+ * @param seed       Random seed
+ */
+static void make_ring(double* points, int num_points, unsigned seed) {
+    double radius = 1000.0;
+    srand(seed);
+    for (int i = 0; i < num_points; i++) {
+        double t = 2.0 * 3.14159265358979323846 * i / num_points;
+        radius += (rand() / (double)RAND_MAX - 0.5);
+        points[2 * i] = radius * cos(t);
+        points[2 * i + 1] = radius * sin(t);
+    }
+}
+
+/**
+ * @struct Case
+ * @brief Inputs and outputs of one benchmark case
+ */
+typedef struct {
+    VWPoints points;
+    const int64_t* offsets;
+    int64_t num_rings;
+    const int* resolutions;
+    int num_resolutions;
+    int num_threads;
+    void** out;
+    const int64_t* const* out_offsets;
+} Case;
+
+typedef int (*CaseRun)(const Case* c);
+
+static int run_simplify(const Case* c) {
+    return vw_simplify(&c->points, 1, VW_METRIC_AREA, c->resolutions, c->num_resolutions,
+                       c->out);
+}
+
+static int run_index(const Case* c) {
+    VWIndex* index;
+    int status = vw_index_build(&c->points, 1, VW_METRIC_AREA, &index);
+    vw_index_destroy(index);
+    return status;
+}
+
+static int run_batch(const Case* c) {
+    return vw_simplify_batch(&c->points, c->offsets, c->num_rings, 1, VW_METRIC_AREA,
+                             c->resolutions, c->num_resolutions, c->num_threads, c->out,
+                             c->out_offsets);
+}
+
+/**
+ * @brief Best time of a case over repeated runs
+ *
+ * @param run Function running the case once
+ * @param c   Case
+ * @return double Best time in seconds, or a negative value if a run failed
+ */
+static double best_time(CaseRun run, const Case* c) {
+    double best = INFINITY;
+    double total = 0.0;
+    do {
+        double start = now_seconds();
+        if (run(c) != VW_OK)
+            return -1.0;
+        double elapsed = now_seconds() - start;
+        best = elapsed < best ? elapsed : best;
+        total += elapsed;
+    } while (total < MIN_TOTAL_SECONDS);
+    return best;
+}
+
+static void report(const char* name, int64_t vertices, double seconds) {
+    if (seconds < 0)
+        printf("%-24s %12lld %12s\n", name, (long long)vertices, "failed");
+    else
+        printf("%-24s %12lld %12.3f %14.3e\n", name, (long long)vertices, seconds * 1e3,
+               vertices / seconds);
+}
+
+int main(int argc, char** argv) {
+    int max_points = argc > 1 ? atoi(argv[1]) : 10000000;
+    int num_threads = argc > 2 ? atoi(argv[2]) : 0;
+
+    vw_init();
+    printf("%-24s %12s %12s %14s\n", "case", "vertices", "best ms", "vertices/s");
+
+    // One ring at a time, to a tenth, a hundredth and a thousandth of its size
+    double* points = malloc(2 * (size_t)max_points * sizeof(double));
+    void* out[3];
+    out[0] = malloc(2 * (size_t)(max_points / 10 + 1) * sizeof(double));
+    out[1] = malloc(2 * (size_t)(max_points / 100 + 4) * sizeof(double));
+    out[2] = malloc(2 * (size_t)(max_points / 1000 + 4) * sizeof(double));
+    if (!points || !out[0] || !out[1] || !out[2])
+        return 1;
+
+    for (int num_points = 1000; num_points <= max_points; num_points *= 10) {
+        int resolutions[3] = {num_points / 10, num_points / 100, num_points / 1000};
+        for (int k = 0; k < 3; k++)
+            resolutions[k] = resolutions[k] < 3 ? 3 : resolutions[k];
+        make_ring(points, num_points, 42);
+
+        Case c = {{points, num_points, 0, 2, VW_FLOAT64}, NULL, 0, resolutions, 3, 1, out,
+                  NULL};
+        char name[32];
+        snprintf(name, sizeof(name), "simplify %d", num_points);
+        report(name, num_points, best_time(run_simplify, &c));
+        snprintf(name, sizeof(name), "index_build %d", num_points);
+        report(name, num_points, best_time(run_index, &c));
+    }
+    free(points);
+    for (int k = 0; k < 3; k++)
+        free(out[k]);
+
+    // Many small rings of skewed sizes, each simplified to at most 330 vertices
+    int64_t num_rings = 100000;
+    int64_t* offsets = malloc((num_rings + 1) * sizeof(int64_t));
+    if (!offsets)
+        return 1;
+    offsets[0] = 0;
+    srand(7);
+    for (int64_t r = 0; r < num_rings; r++) {
+        int size = 10 + (int)(990.0 * pow(rand() / (double)RAND_MAX, 4.0));
+        offsets[r + 1] = offsets[r] + size;
+    }
+    points = malloc(2 * (size_t)offsets[num_rings] * sizeof(double));
+    if (!points)
+        return 1;
+    for (int64_t r = 0; r < num_rings; r++)
+        make_ring(points + 2 * offsets[r], (int)(offsets[r + 1] - offsets[r]), (unsigned)r);
+
+    int resolution = 330;
+    VWPoints batch_points = {points, offsets[num_rings], 0, 2, VW_FLOAT64};
+    int64_t* out_offsets = malloc((num_rings + 1) * sizeof(int64_t));
+    if (!out_offsets ||
+        vw_batch_offsets(&batch_points, offsets, num_rings, 1, resolution, out_offsets) != VW_OK)
+        return 1;
+    void* batch_out = malloc(2 * (size_t)out_offsets[num_rings] * sizeof(double));
+    if (!batch_out)
+        return 1;
+
+    const int64_t* batch_offsets[1] = {out_offsets};
+    Case c = {batch_points, offsets, num_rings, &resolution, 1, 1, &batch_out, batch_offsets};
+    report("batch 1 thread", offsets[num_rings], best_time(run_batch, &c));
+    c.num_threads = num_threads;
+    report(num_threads > 0 ? "batch threads" : "batch all cpus", offsets[num_rings],
+           best_time(run_batch, &c));
+
+    free(points);
+    free(offsets);
+    free(out_offsets);
+    free(batch_out);
+    return 0;
+}
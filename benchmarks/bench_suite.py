@@ -0,0 +1,310 @@
+"""Benchmark suite for visvalingam_c on fixed synthetic corpora.
+
+Every corpus is generated from a fixed seed, so the same case simplifies
+the same rings on every machine and release. The corpora are:
+
+- ``walk``: random-walk rings, a pessimistic case with no smooth structure
+- ``coast``: fractal coastlines whose radius is fractional Brownian noise,
+  from 10^2 to 10^6 vertices (10^7 with ``--full``), the largest also
+  simplified on every CPU by ``simplify_parallel``
+- ``parcels``: batches of many small rings of 8 to 64 vertices
+
+Each case runs in its own interpreter so peak RSS is measured per case. The
+report lists the best wall time over ``--repeat`` runs, throughput in input
+vertices per second, the peak RSS of the process and how much of it the
+simplification added on top of the corpus, and the number of heap pushes and
+pops. The heap counts are those measured by ``visvalingam_c.get_stats()``,
+so they are only reported for the ``multi`` cases of a build with
+``SIMPLIFY_STATS``, and shown as ``-`` otherwise.
+
+Modes that the installed module does not provide are skipped, so the same
+script can compare an old release against a new one.
+
+Usage, from the repository root after ``python setup.py build_ext --inplace``::
+
+    python benchmarks/bench_suite.py
+    python benchmarks/bench_suite.py --full --json nightly.json
+    python benchmarks/bench_suite.py --compare nightly.json
+    python benchmarks/bench_suite.py --cases coast-1e6-multi parcels-1e5-batch
+"""
+
+import argparse
+import json
+import os
+import platform
+import subprocess
+import sys
+import time
+
+import numpy as np
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir))
+import visvalingam_c  # noqa: E402
+
+try:
+    import resource
+except ImportError:  # Windows
+    resource = None
+
+
+# Corpora
+
+def random_walk_ring(num_points, seed):
+    """Gaussian random walk bent into a ring by removing its drift."""
+    rng = np.random.default_rng(seed)
+    walk = np.cumsum(rng.normal(size=(num_points, 2)), axis=0)
+    walk -= np.outer(np.arange(num_points) / num_points, walk[-1])
+    return np.ascontiguousarray(walk)
+
+
+def fractal_coastline(num_points, seed, hurst=0.7):
+    """Star-shaped ring whose radius is fractional Brownian noise in the angle."""
+    rng = np.random.default_rng(seed)
+    freqs = np.arange(1, num_points // 2 + 1)
+    spectrum = freqs ** -(hurst + 0.5) * np.exp(2j * np.pi * rng.random(freqs.size))
+    noise = np.fft.irfft(np.concatenate(([0.0], spectrum)), n=num_points)
+    radius = np.clip(1.0 + 0.2 * noise / noise.std(), 0.2, None)
+    angle = 2.0 * np.pi * np.arange(num_points) / num_points
+    # Projected metres, roughly the extent of a large island
+    return np.column_stack((radius * np.cos(angle), radius * np.sin(angle))) * 1e5
+
+
+def small_rings(num_rings, seed):
+    """Flat coordinates and offsets of many small noisy rings on a grid."""
+    rng = np.random.default_rng(seed)
+    sizes = rng.integers(8, 65, size=num_rings)
+    offsets = np.concatenate(([0], np.cumsum(sizes))).astype(np.int64)
+    ring = np.repeat(np.arange(num_rings), sizes)
+    position = np.arange(offsets[-1]) - offsets[ring]
+    angle = 2.0 * np.pi * position / sizes[ring]
+    radius = 1.0 + 0.2 * rng.random(offsets[-1])
+    coords = np.column_stack((ring % 1000 * 3.0 + radius * np.cos(angle),
+                              ring // 1000 * 3.0 + radius * np.sin(angle)))
+    return coords, offsets
+
+
+# Modes
+
+def ring_resolutions(num_points):
+    """Targets keeping half, a tenth and a hundredth of a ring."""
+    targets = {max(3, num_points // d) for d in (2, 10, 100)}
+    return np.array(sorted((t for t in targets if t < num_points), reverse=True),
+                    dtype=np.int32)
+
+
+def run_multi(points, resolutions):
+    visvalingam_c.simplify_multi(points, resolutions)
+
+
+def run_index(points, resolutions):
+    index = visvalingam_c.build_index(points)
+    for target in resolutions:
+        index.extract(int(target))
+
+
+def run_parallel(points, resolutions):
+    visvalingam_c.simplify_parallel(points, resolutions)
+
+
+def run_batch(coords, offsets, resolutions, num_threads):
+    visvalingam_c.simplify_batch(coords, offsets, resolutions, num_threads=num_threads)
+
+
+# Module function each mode needs
+MODES = {
+    'multi': 'simplify_multi',
+    'index': 'build_index',
+    'parallel': 'simplify_parallel',
+    'batch': 'simplify_batch',
+    'threads': 'simplify_batch',
+}
+
+SIZES = {'1e2': 10**2, '1e3': 10**3, '1e4': 10**4, '1e5': 10**5,
+         '1e6': 10**6, '1e7': 10**7}
+
+
+def case_names(full):
+    """All cases in report order; 10^7-vertex coastlines only with full."""
+    names = []
+    for size in SIZES:
+        if size == '1e7' and not full:
+            continue
+        for mode in ('multi', 'index'):
+            names.append('coast-%s-%s' % (size, mode))
+        if size in ('1e6', '1e7'):
+            names.append('coast-%s-parallel' % size)
+    for size in ('1e4', '1e6'):
+        names.append('walk-%s-multi' % size)
+    for size in ('1e3', '1e5'):
+        for mode in ('batch', 'threads'):
+            names.append('parcels-%s-%s' % (size, mode))
+    return names
+
+
+def build_case(name):
+    """Corpus and callable of one case.
+
+    Returns (run, num_vertices, num_rings, resolutions).
+    """
+    corpus, size, mode = name.split('-')
+    size = SIZES[size]
+
+    if corpus == 'parcels':
+        coords, offsets = small_rings(size, seed=3)
+        resolutions = np.array([32, 16, 8, 4], dtype=np.int32)
+        num_threads = 1 if mode == 'batch' else 0
+
+        def run():
+            run_batch(coords, offsets, resolutions, num_threads)
+        return run, int(offsets[-1]), size, resolutions
+
+    points = (fractal_coastline(size, seed=1) if corpus == 'coast'
+              else random_walk_ring(size, seed=2))
+    resolutions = ring_resolutions(size)
+
+    if mode == 'index':
+        def run():
+            run_index(points, resolutions)
+    elif mode == 'parallel':
+        def run():
+            run_parallel(points, resolutions)
+    else:
+        def run():
+            run_multi(points, resolutions)
+    return run, size, 1, resolutions
+
+
+def peak_rss_mib():
+    """Peak resident set size of this process in MiB, None if unknown."""
+    if resource is None:
+        return None
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # Linux reports KiB, macOS bytes
+    return peak / (2**20 if sys.platform == 'darwin' else 2**10)
+
+
+def heap_counts():
+    """Heap pushes and pops of the last simplify_multi call.
+
+    Both are None unless the module was built with SIMPLIFY_STATS.
+    """
+    get_stats = getattr(visvalingam_c, 'get_stats', None)
+    stats = get_stats() if get_stats else None
+    if stats is None:
+        return None, None
+    return stats['heap_pushes'], stats['heap_pops']
+
+
+def run_case(name, repeat):
+    """Run one case in this process and return its result record."""
+    run, num_vertices, num_rings, resolutions = build_case(name)
+    rss_before = peak_rss_mib()
+
+    best = float('inf')
+    for _ in range(repeat):
+        start = time.perf_counter()
+        run()
+        best = min(best, time.perf_counter() - start)
+
+    rss_after = peak_rss_mib()
+    # get_stats only covers simplify_multi, the call of the multi cases
+    pushes, pops = heap_counts() if name.endswith('-multi') else (None, None)
+    return {
+        'name': name,
+        'vertices': num_vertices,
+        'rings': num_rings,
+        'resolutions': [int(r) for r in resolutions],
+        'seconds': best,
+        'vertices_per_s': num_vertices / best,
+        'peak_rss_mib': rss_after,
+        'rss_growth_mib': None if rss_after is None else rss_after - rss_before,
+        'heap_pushes': pushes,
+        'heap_pops': pops,
+    }
+
+
+def case_available(name):
+    return hasattr(visvalingam_c, MODES[name.split('-')[2]])
+
+
+# Driver
+
+def format_mib(value):
+    return '%10s' % '-' if value is None else '%10.1f' % value
+
+
+def format_count(value):
+    return '%12s' % '-' if value is None else '%12d' % value
+
+
+def print_report(results, baseline):
+    header = '%-22s %10s %10s %12s %10s %10s %12s %12s' % (
+        'case', 'vertices', 'ms', 'Mvert/s', 'peak MiB', 'grow MiB', 'pushes', 'pops')
+    if baseline:
+        header += ' %9s' % 'vs base'
+    print(header)
+
+    for result in results:
+        line = '%-22s %10d %10.2f %12.2f %s %s %s %s' % (
+            result['name'], result['vertices'], result['seconds'] * 1e3,
+            result['vertices_per_s'] / 1e6, format_mib(result['peak_rss_mib']),
+            format_mib(result['rss_growth_mib']), format_count(result['heap_pushes']),
+            format_count(result['heap_pops']))
+        base = baseline.get(result['name'])
+        if base:
+            line += ' %8.2fx' % (result['vertices_per_s'] / base['vertices_per_s'])
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--full', action='store_true',
+                        help='include 10^7-vertex coastlines')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per case, the best time is reported')
+    parser.add_argument('--cases', nargs='+', help='run only these cases')
+    parser.add_argument('--json', help='write results to this file')
+    parser.add_argument('--compare', help='baseline JSON from an earlier run')
+    parser.add_argument('--run-case', help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.run_case:
+        json.dump(run_case(args.run_case, args.repeat), sys.stdout)
+        return
+
+    names = args.cases or case_names(args.full)
+    unknown = [n for n in names if n not in case_names(True)]
+    if unknown:
+        parser.error('unknown cases: %s' % ', '.join(unknown))
+
+    baseline = {}
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = {r['name']: r for r in json.load(f)['cases']}
+
+    results = []
+    for name in names:
+        if not case_available(name):
+            print('%-22s skipped, not supported by this build' % name)
+            continue
+        output = subprocess.run(
+            [sys.executable, os.path.abspath(__file__), '--run-case', name,
+             '--repeat', str(args.repeat)],
+            check=True, stdout=subprocess.PIPE).stdout
+        results.append(json.loads(output))
+
+    print_report(results, baseline)
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump({
+                'module': getattr(visvalingam_c, '__file__', None),
+                'python': platform.python_version(),
+                'machine': platform.machine(),
+                'cpus': os.cpu_count(),
+                'cases': results,
+            }, f, indent=2)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,436 @@
+#ifndef _WIN32
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "cache.h"
+#include "parallel.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <sys/mman.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+/**
+ * @struct BlockHeader
+ * @brief Start of every arena block
+ *
+ * @param next Next block of the same entry, or of the free list; -1 ends both
+ */
+typedef struct {
+    int32_t next;
+    int32_t unused;
+} BlockHeader;
+
+/** Bytes of entry data each block holds */
+#define BLOCK_PAYLOAD (CACHE_BLOCK_SIZE - sizeof(BlockHeader))
+
+/**
+ * @struct EntryHeader
+ * @brief Bookkeeping of an entry, at the start of its first block
+ *
+ * The order and the effective areas follow it, spread over the payloads
+ * of the entry's chain of blocks.
+ *
+ * @param key        Key of the cached ring
+ * @param hash_next  Next entry of the same bucket, or -1
+ * @param lru_prev   More recently used entry, or -1
+ * @param lru_next   Less recently used entry, or -1
+ * @param num_blocks Blocks in the entry's chain
+ */
+typedef struct {
+    OrderKey key;
+    int32_t hash_next;
+    int32_t lru_prev;
+    int32_t lru_next;
+    int32_t num_blocks;
+} EntryHeader;
+
+/**
+ * @struct OrderCache
+ * @brief Arena header, followed by the bucket array and the blocks
+ *
+ * Entries are named by the index of their first block. Everything is
+ * addressed by index from the start of the arena, so a shared arena
+ * works for every process that maps it.
+ *
+ * @param lock          Guards everything below
+ * @param shared        Nonzero if the arena is a shared mapping
+ * @param size          Bytes of the allocation or mapping
+ * @param blocks_offset Offset of block 0 from the start of the arena
+ * @param num_blocks    Blocks in the arena
+ * @param num_buckets   Hash buckets, a power of two
+ * @param free_head     First free block, or -1
+ * @param num_free      Number of free blocks
+ * @param lru_head      Most recently used entry, or -1
+ * @param lru_tail      Least recently used entry, or -1
+ * @param stats         Counters; used and capacity are derived on read
+ */
+struct OrderCache {
+    Mutex lock;
+    int shared;
+    size_t size;
+    size_t blocks_offset;
+    int32_t num_blocks;
+    int32_t num_buckets;
+    int32_t free_head;
+    int32_t num_free;
+    int32_t lru_head;
+    int32_t lru_tail;
+    OrderCacheStats stats;
+};
+
+static inline int32_t* cache_buckets(OrderCache* cache) {
+    return (int32_t*)(cache + 1);
+}
+
+static inline BlockHeader* cache_block(OrderCache* cache, int32_t block) {
+    return (BlockHeader*)((char*)cache + cache->blocks_offset +
+                          (size_t)block * CACHE_BLOCK_SIZE);
+}
+
+static inline EntryHeader* cache_entry(OrderCache* cache, int32_t entry) {
+    return (EntryHeader*)(cache_block(cache, entry) + 1);
+}
+
+/**
+ * @brief Put every block on the free list and forget every entry
+ */
+static void reset_entries(OrderCache* cache) {
+    int32_t* buckets = cache_buckets(cache);
+    for (int32_t b = 0; b < cache->num_buckets; b++)
+        buckets[b] = -1;
+    for (int32_t block = 0; block < cache->num_blocks; block++)
+        cache_block(cache, block)->next = block + 1 < cache->num_blocks ? block + 1 : -1;
+    cache->free_head = 0;
+    cache->num_free = cache->num_blocks;
+    cache->lru_head = -1;
+    cache->lru_tail = -1;
+    cache->stats.entries = 0;
+}
+
+/**
+ * @brief Lock a cache, recovering from a process that died holding the lock
+ */
+static void cache_lock(OrderCache* cache) {
+#ifdef __linux__
+    if (pthread_mutex_lock(&cache->lock) == EOWNERDEAD) {
+        // Whatever the dead process was changing is dropped with the rest
+        reset_entries(cache);
+        pthread_mutex_consistent(&cache->lock);
+    }
+#else
+    mutex_lock(&cache->lock);
+#endif
+}
+
+static inline void cache_unlock(OrderCache* cache) {
+    mutex_unlock(&cache->lock);
+}
+
+OrderCache* order_cache_create(size_t max_bytes, int shared) {
+    // One bucket per two to four blocks, then as many blocks as fit
+    size_t header = sizeof(OrderCache);
+    if (max_bytes < header + CACHE_BLOCK_SIZE + 64)
+        return NULL;
+    size_t approx_blocks = (max_bytes - header) / CACHE_BLOCK_SIZE;
+    if (approx_blocks > INT32_MAX / 2)
+        approx_blocks = INT32_MAX / 2;
+    int32_t num_buckets = 1;
+    while ((size_t)num_buckets * 4 <= approx_blocks)
+        num_buckets *= 2;
+    size_t blocks_offset = (header + (size_t)num_buckets * sizeof(int32_t) + 63) / 64 * 64;
+    if (max_bytes < blocks_offset + CACHE_BLOCK_SIZE)
+        return NULL;
+    size_t num_blocks = (max_bytes - blocks_offset) / CACHE_BLOCK_SIZE;
+    if (num_blocks > INT32_MAX)
+        num_blocks = INT32_MAX;
+    size_t size = blocks_offset + num_blocks * CACHE_BLOCK_SIZE;
+
+    OrderCache* cache;
+    if (shared) {
+#ifdef _WIN32
+        return NULL;
+#else
+        void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED)
+            return NULL;
+        cache = (OrderCache*)map;
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+#ifdef __linux__
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+#endif
+        int failed = pthread_mutex_init(&cache->lock, &attr) != 0;
+        pthread_mutexattr_destroy(&attr);
+        if (failed) {
+            munmap(map, size);
+            return NULL;
+        }
+#endif
+    } else {
+        cache = (OrderCache*)malloc(size);
+        if (!cache)
+            return NULL;
+        mutex_init(&cache->lock);
+    }
+
+    cache->shared = shared;
+    cache->size = size;
+    cache->blocks_offset = blocks_offset;
+    cache->num_blocks = (int32_t)num_blocks;
+    cache->num_buckets = num_buckets;
+    memset(&cache->stats, 0, sizeof(cache->stats));
+    reset_entries(cache);
+    return cache;
+}
+
+void order_cache_destroy(OrderCache* cache) {
+    if (!cache)
+        return;
+#ifndef _WIN32
+    // Other processes may still use a shared lock, so only the mapping goes
+    if (cache->shared) {
+        munmap(cache, cache->size);
+        return;
+    }
+#endif
+    mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+void order_cache_clear(OrderCache* cache) {
+    cache_lock(cache);
+    reset_entries(cache);
+    memset(&cache->stats, 0, sizeof(cache->stats));
+    cache_unlock(cache);
+}
+
+void order_cache_stats(OrderCache* cache, OrderCacheStats* stats) {
+    cache_lock(cache);
+    *stats = cache->stats;
+    stats->used = (int64_t)(cache->num_blocks - cache->num_free) * CACHE_BLOCK_SIZE;
+    stats->capacity = (int64_t)cache->num_blocks * CACHE_BLOCK_SIZE;
+    cache_unlock(cache);
+}
+
+/**
+ * @brief One step of a hash lane
+ */
+static inline uint64_t hash_step(uint64_t h, double value, uint64_t multiplier) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    h = (h ^ bits) * multiplier;
+    return h ^ (h >> 29);
+}
+
+/**
+ * @brief Final avalanche of a hash lane (the MurmurHash3 finalizer)
+ */
+static inline uint64_t hash_finish(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    return h ^ (h >> 33);
+}
+
+/**
+ * @def HASH_LOOP
+ * @brief Body of order_cache_key for one storage type
+ *
+ * x and y feed independent lanes, so the loop carries two short
+ * dependency chains; z joins the x lane.
+ */
+#define HASH_LOOP(COORD_T)                                                      \
+    do {                                                                        \
+        for (VertexIndex i = 0; i < num_points; i++) {                          \
+            h0 = hash_step(h0, COORD_VALUE(coords, COORD_T, i, 0),              \
+                           0x9E3779B97F4A7C15ULL);                              \
+            h1 = hash_step(h1, COORD_VALUE(coords, COORD_T, i, 1),              \
+                           0xC2B2AE3D27D4EB4FULL);                              \
+            if (with_z)                                                         \
+                h0 = hash_step(h0, COORD_VALUE(coords, COORD_T, i, 2),          \
+                               0x165667B19E3779F9ULL);                          \
+        }                                                                       \
+    } while (0)
+
+void order_cache_key(const Coords* coords, VertexIndex num_points, int closed,
+                     AreaMetric metric, OrderKey* key) {
+    uint64_t h0 = 0x243F6A8885A308D3ULL, h1 = 0x13198A2E03707344ULL;
+    int with_z = metric == METRIC_AREA_3D;
+    if (coords->type == COORD_FLOAT32)
+        HASH_LOOP(float);
+    else
+        HASH_LOOP(double);
+
+    key->hash[0] = hash_finish(h0 ^ hash_finish(h1));
+    key->hash[1] = hash_finish(h1 + (uint64_t)num_points);
+    key->num_points = num_points;
+    key->closed = closed ? 1 : 0;
+    key->metric = (int32_t)metric;
+}
+
+/**
+ * @brief Entry of a key, or -1
+ */
+static int32_t find_entry(OrderCache* cache, const OrderKey* key) {
+    int32_t entry = cache_buckets(cache)[key->hash[0] & (uint64_t)(cache->num_buckets - 1)];
+    while (entry >= 0) {
+        const OrderKey* other = &cache_entry(cache, entry)->key;
+        if (other->hash[0] == key->hash[0] && other->hash[1] == key->hash[1] &&
+            other->num_points == key->num_points && other->closed == key->closed &&
+            other->metric == key->metric)
+            return entry;
+        entry = cache_entry(cache, entry)->hash_next;
+    }
+    return -1;
+}
+
+static void lru_unlink(OrderCache* cache, int32_t entry) {
+    EntryHeader* header = cache_entry(cache, entry);
+    if (header->lru_prev >= 0)
+        cache_entry(cache, header->lru_prev)->lru_next = header->lru_next;
+    else
+        cache->lru_head = header->lru_next;
+    if (header->lru_next >= 0)
+        cache_entry(cache, header->lru_next)->lru_prev = header->lru_prev;
+    else
+        cache->lru_tail = header->lru_prev;
+}
+
+static void lru_push_front(OrderCache* cache, int32_t entry) {
+    EntryHeader* header = cache_entry(cache, entry);
+    header->lru_prev = -1;
+    header->lru_next = cache->lru_head;
+    if (cache->lru_head >= 0)
+        cache_entry(cache, cache->lru_head)->lru_prev = entry;
+    else
+        cache->lru_tail = entry;
+    cache->lru_head = entry;
+}
+
+/**
+ * @brief Drop the least recently used entry and free its blocks
+ */
+static void evict_oldest(OrderCache* cache) {
+    int32_t entry = cache->lru_tail;
+    EntryHeader* header = cache_entry(cache, entry);
+
+    int32_t* link = &cache_buckets(cache)[header->key.hash[0] &
+                                          (uint64_t)(cache->num_buckets - 1)];
+    while (*link != entry)
+        link = &cache_entry(cache, *link)->hash_next;
+    *link = header->hash_next;
+    lru_unlink(cache, entry);
+
+    int32_t last = entry;
+    while (cache_block(cache, last)->next >= 0)
+        last = cache_block(cache, last)->next;
+    cache_block(cache, last)->next = cache->free_head;
+    cache->free_head = entry;
+    cache->num_free += header->num_blocks;
+    cache->stats.entries--;
+    cache->stats.evictions++;
+}
+
+/**
+ * @brief Copy bytes between a buffer and the data of an entry
+ *
+ * @param cache  Target cache
+ * @param entry  Entry whose chain is accessed
+ * @param offset Offset into the entry data, which starts with its header
+ * @param buffer Source when writing, destination when reading
+ * @param length Number of bytes
+ * @param write  Nonzero to copy from buffer into the entry
+ */
+static void entry_copy(OrderCache* cache, int32_t entry, size_t offset, void* buffer,
+                       size_t length, int write) {
+    int32_t block = entry;
+    while (offset >= BLOCK_PAYLOAD) {
+        block = cache_block(cache, block)->next;
+        offset -= BLOCK_PAYLOAD;
+    }
+    char* bytes = (char*)buffer;
+    while (length > 0) {
+        char* payload = (char*)(cache_block(cache, block) + 1) + offset;
+        size_t chunk = BLOCK_PAYLOAD - offset < length ? BLOCK_PAYLOAD - offset : length;
+        if (write)
+            memcpy(payload, bytes, chunk);
+        else
+            memcpy(bytes, payload, chunk);
+        bytes += chunk;
+        length -= chunk;
+        offset = 0;
+        block = cache_block(cache, block)->next;
+    }
+}
+
+int order_cache_lookup(OrderCache* cache, const OrderKey* key, VertexIndex first_rank,
+                       VertexIndex* order, double* order_areas) {
+    size_t num_points = (size_t)key->num_points;
+    size_t order_offset = sizeof(EntryHeader);
+    size_t areas_offset = order_offset + num_points * sizeof(VertexIndex);
+
+    cache_lock(cache);
+    int32_t entry = find_entry(cache, key);
+    if (entry < 0) {
+        cache->stats.misses++;
+        cache_unlock(cache);
+        return 0;
+    }
+    cache->stats.hits++;
+    lru_unlink(cache, entry);
+    lru_push_front(cache, entry);
+
+    entry_copy(cache, entry, order_offset + (size_t)first_rank * sizeof(VertexIndex),
+               order + first_rank, (num_points - (size_t)first_rank) * sizeof(VertexIndex), 0);
+    if (order_areas)
+        entry_copy(cache, entry, areas_offset, order_areas, num_points * sizeof(double), 0);
+    cache_unlock(cache);
+    return 1;
+}
+
+void order_cache_insert(OrderCache* cache, const OrderKey* key, const VertexIndex* order,
+                        const double* order_areas) {
+    size_t num_points = (size_t)key->num_points;
+    size_t order_offset = sizeof(EntryHeader);
+    size_t areas_offset = order_offset + num_points * sizeof(VertexIndex);
+    size_t length = areas_offset + num_points * sizeof(double);
+    size_t needed = (length + BLOCK_PAYLOAD - 1) / BLOCK_PAYLOAD;
+
+    cache_lock(cache);
+    if (needed > (size_t)cache->num_blocks || find_entry(cache, key) >= 0) {
+        cache_unlock(cache);
+        return;
+    }
+    while ((size_t)cache->num_free < needed)
+        evict_oldest(cache);
+
+    // Take the chain from the front of the free list
+    int32_t entry = cache->free_head, last = entry;
+    for (size_t b = 1; b < needed; b++)
+        last = cache_block(cache, last)->next;
+    cache->free_head = cache_block(cache, last)->next;
+    cache_block(cache, last)->next = -1;
+    cache->num_free -= (int32_t)needed;
+
+    EntryHeader* header = cache_entry(cache, entry);
+    header->key = *key;
+    header->num_blocks = (int32_t)needed;
+    entry_copy(cache, entry, order_offset, (void*)order, num_points * sizeof(VertexIndex), 1);
+    entry_copy(cache, entry, areas_offset, (void*)order_areas, num_points * sizeof(double), 1);
+
+    int32_t* bucket = &cache_buckets(cache)[key->hash[0] & (uint64_t)(cache->num_buckets - 1)];
+    header->hash_next = *bucket;
+    *bucket = entry;
+    lru_push_front(cache, entry);
+    cache->stats.entries++;
+    cache_unlock(cache);
+}
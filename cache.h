@@ -0,0 +1,152 @@
+/**
+ * @file cache.h
+ * @brief Bounded cache of elimination orders keyed by ring content
+ *
+ * This header defines a least-recently-used cache of the full elimination
+ * order of rings, keyed by a hash of their coordinates. A ring seen before
+ * is then served by hashing it and selecting the most important vertices
+ * of the cached order, without running the heap again. The cache lives in
+ * one block arena of fixed size, either private to the process or in
+ * shared memory that forked workers inherit, and every operation takes
+ * the lock kept in the arena.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "geometry.h"
+
+/**
+ * @def CACHE_BLOCK_SIZE
+ * @brief Bytes per arena block; an entry takes a chain of whole blocks
+ */
+#ifndef CACHE_BLOCK_SIZE
+#define CACHE_BLOCK_SIZE 4096
+#endif
+
+/**
+ * @struct OrderKey
+ * @brief What an elimination order depends on
+ *
+ * @param hash       128-bit hash of the x, y values (and z for METRIC_AREA_3D)
+ * @param num_points Number of vertices of the ring
+ * @param closed     Nonzero for a ring, zero for an open line
+ * @param metric     Effective area the order ranks by
+ */
+typedef struct {
+    uint64_t hash[2];
+    int64_t num_points;
+    int32_t closed;
+    int32_t metric;
+} OrderKey;
+
+/**
+ * @struct OrderCacheStats
+ * @brief Counters of a cache since it was created or cleared
+ *
+ * @param hits      Lookups served from the cache
+ * @param misses    Lookups that found nothing
+ * @param evictions Entries dropped to make room for newer ones
+ * @param entries   Orders currently held
+ * @param used      Bytes of blocks currently holding entries
+ * @param capacity  Bytes of blocks in the arena
+ */
+typedef struct {
+    int64_t hits;
+    int64_t misses;
+    int64_t evictions;
+    int64_t entries;
+    int64_t used;
+    int64_t capacity;
+} OrderCacheStats;
+
+/** Opaque cache arena */
+typedef struct OrderCache OrderCache;
+
+/**
+ * @brief Create a cache of at most max_bytes
+ *
+ * With shared set the arena is an anonymous shared mapping: processes
+ * forked after this call see the same entries and lock, and each of them
+ * destroys its own mapping. Shared caches need POSIX.
+ *
+ * @param max_bytes Size of the whole arena, bookkeeping included
+ * @param shared    Nonzero to place the arena in shared memory
+ * @return OrderCache* New cache or NULL if it could not be allocated or is
+ *                     too small to hold any block
+ */
+OrderCache* order_cache_create(size_t max_bytes, int shared);
+
+/**
+ * @brief Release this process's handle on a cache
+ *
+ * @param cache Cache to destroy (may be NULL)
+ */
+void order_cache_destroy(OrderCache* cache);
+
+/**
+ * @brief Drop every entry and reset the counters
+ *
+ * @param cache Target cache
+ */
+void order_cache_clear(OrderCache* cache);
+
+/**
+ * @brief Read the counters of a cache
+ *
+ * @param cache Target cache
+ * @param stats Receives the counters
+ */
+void order_cache_stats(OrderCache* cache, OrderCacheStats* stats);
+
+/**
+ * @brief Key of the elimination order of a ring
+ *
+ * Hashes the values the metric reads, as doubles, so float32 and float64
+ * copies of a ring share their entry and extra columns such as m do not
+ * change the key.
+ *
+ * @param coords     Ring (unclosed) or line coordinates
+ * @param num_points Number of vertices
+ * @param closed     Nonzero for a ring, zero for an open line
+ * @param metric     Effective area used to rank vertices
+ * @param key        Receives the key
+ */
+void order_cache_key(const Coords* coords, VertexIndex num_points, int closed,
+                     AreaMetric metric, OrderKey* key);
+
+/**
+ * @brief Copy a cached order out of the cache
+ *
+ * A hit makes the entry the most recently used one. Only the ranks from
+ * first_rank on, the vertices kept by every target up to
+ * num_points - first_rank, are copied into order, at their own positions.
+ *
+ * @param cache       Target cache
+ * @param key         Key of the ring
+ * @param first_rank  First rank to copy
+ * @param order       Receives order[first_rank] to order[num_points - 1]
+ * @param order_areas Receives all num_points effective areas, or NULL
+ * @return int 1 on a hit, 0 on a miss
+ */
+int order_cache_lookup(OrderCache* cache, const OrderKey* key, VertexIndex first_rank,
+                       VertexIndex* order, double* order_areas);
+
+/**
+ * @brief Store the order and effective areas from simplify_rank
+ *
+ * The least recently used entries are evicted until the new one fits.
+ * Orders larger than the whole arena, and keys already present, are
+ * left alone.
+ *
+ * @param cache       Target cache
+ * @param key         Key of the ring
+ * @param order       num_points vertex indices by removal rank
+ * @param order_areas num_points effective areas by removal rank
+ */
+void order_cache_insert(OrderCache* cache, const OrderKey* key, const VertexIndex* order,
+                        const double* order_areas);
+
+#endif /* CACHE_H */
@@ -0,0 +1,391 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chunked.h"
+#include "simplify.h"
+#include "scratch.h"
+#include "parallel.h"
+
+/**
+ * @def CHUNK_JOIN_WINDOW
+ * @brief Vertices searched on either side of an even split for a chunk end
+ */
+#define CHUNK_JOIN_WINDOW 256
+
+/**
+ * @struct ChunkJob
+ * @brief Chunks shared by the threads recording their eliminations
+ *
+ * Chunk c holds vertices ends[c] to ends[c + 1] and records its elimination
+ * at offset ends[c] + c of order and keys, so consecutive chunks,
+ * which share an end, do not overlap in the record either.
+ *
+ * @param coords      Coordinates of the whole ring
+ * @param ends        First vertex of every chunk, then the last vertex
+ * @param num_chunks  Number of chunks
+ * @param metric      Effective area used to rank vertices
+ * @param orientation Orientation of the whole ring for oriented metrics
+ * @param order       Receives the removal order of every chunk
+ * @param keys        Receives the removal keys of every chunk
+ * @param lock        Guards next_chunk and failed
+ * @param next_chunk  First chunk no thread has taken yet
+ * @param failed      Nonzero once a thread could not allocate its workspace
+ */
+typedef struct {
+    const Coords* coords;
+    const VertexIndex* ends;
+    int num_chunks;
+    AreaMetric metric;
+    double orientation;
+    VertexIndex* order;
+    double* keys;
+    Mutex lock;
+    int next_chunk;
+    int failed;
+} ChunkJob;
+
+/**
+ * @brief Most prominent vertex of a range, to serve as a chunk end
+ *
+ * Picks the vertex with the largest triangle area against its input
+ * neighbours, so the pinned vertex is one that survives long anyway.
+ *
+ * @param coords Ring coordinates
+ * @param lo     First candidate, at least 1
+ * @param hi     Last candidate, below the last vertex
+ * @return VertexIndex Chosen vertex
+ */
+static VertexIndex pick_chunk_end(const Coords* coords, VertexIndex lo, VertexIndex hi) {
+    VertexIndex best = lo;
+    double best_area = -1.0;
+    double p1[2], p2[2], p3[2];
+    coords_point(coords, lo - 1, p1);
+    coords_point(coords, lo, p2);
+    for (VertexIndex i = lo; i <= hi; i++) {
+        coords_point(coords, i + 1, p3);
+        double area = metric_area(p1, p2, p3, 1.0);
+        if (area > best_area) {
+            best_area = area;
+            best = i;
+        }
+        memcpy(p1, p2, sizeof(p1));
+        memcpy(p2, p3, sizeof(p2));
+    }
+    return best;
+}
+
+/**
+ * @brief Worker recording the elimination of chunks until none are left
+ *
+ * @param arg       Shared ChunkJob
+ * @param thread_id Index of the calling thread
+ */
+static void chunk_worker(void* arg, int thread_id) {
+    ChunkJob* job = (ChunkJob*)arg;
+    Workspace* ws = scratch_acquire(0);
+    (void)thread_id;
+
+    for (;;) {
+        mutex_lock(&job->lock);
+        int c = job->num_chunks;
+        if (!ws)
+            job->failed = 1;
+        else if (!job->failed)
+            c = job->next_chunk++;
+        mutex_unlock(&job->lock);
+        if (c >= job->num_chunks)
+            break;
+
+        VertexIndex first = job->ends[c];
+        VertexIndex count = job->ends[c + 1] - first + 1;
+        if (workspace_reserve(ws, count) != 0) {
+            mutex_lock(&job->lock);
+            job->failed = 1;
+            mutex_unlock(&job->lock);
+            break;
+        }
+
+        // As an open line the chunk keeps both ends
+        Coords chunk = coords_slice(job->coords, first);
+        ws->metric = job->metric;
+        simplify_record(ws, &chunk, count, 0, job->orientation, job->order + first + c,
+                        job->keys + first + c);
+    }
+
+    scratch_release(ws);
+}
+
+/**
+ * @struct JoinReplay
+ * @brief Whole ring on which the chunk records are replayed
+ *
+ * A vertex is dirty when its neighbours may differ from those it had at
+ * the same point of its chunk's elimination: the chunk ends, and every
+ * vertex next to a dirty vertex that went at a different time than in its
+ * chunk. The recorded keys of clean vertices are still their current
+ * areas, so only dirty vertices need live areas, kept in a lazy heap.
+ *
+ * @param coords      Coordinates of the whole ring
+ * @param links       Links of the whole ring
+ * @param dirty       Nonzero for every dirty vertex
+ * @param heap        Areas of dirty vertices; an entry is stale once the
+ *                    vertex is gone or its area has changed
+ * @param top_checked Nonzero while the top entry of heap is known to be live
+ * @param num_points  Number of vertices
+ * @param closed      Nonzero for a ring, zero for an open line
+ * @param metric      Effective area used to rank vertices
+ * @param orientation Orientation of the whole ring for oriented metrics
+ */
+typedef struct {
+    const Coords* coords;
+    VertexLink* links;
+    char* dirty;
+    MinHeap* heap;
+    int top_checked;
+    VertexIndex num_points;
+    int closed;
+    AreaMetric metric;
+    double orientation;
+} JoinReplay;
+
+/**
+ * @brief Current area of a vertex of the replayed ring
+ */
+static double replay_area(const JoinReplay* replay, VertexIndex vertex) {
+    double p1[3], p2[3], p3[3];
+    coords_metric_point(replay->coords, replay->metric, replay->links[vertex].prev, p1);
+    coords_metric_point(replay->coords, replay->metric, vertex, p2);
+    coords_metric_point(replay->coords, replay->metric, replay->links[vertex].next, p3);
+    switch (replay->metric) {
+    case METRIC_FLATNESS:
+        return metric_flatness(p1, p2, p3, replay->orientation);
+    case METRIC_CONVEXITY:
+        return metric_convexity(p1, p2, p3, replay->orientation);
+    case METRIC_SIGNED:
+        return metric_signed(p1, p2, p3, replay->orientation);
+    case METRIC_AREA_3D:
+        return metric_area_3d(p1, p2, p3, replay->orientation);
+    default:
+        return metric_area(p1, p2, p3, replay->orientation);
+    }
+}
+
+/**
+ * @brief Give a vertex whose neighbours changed its new area
+ *
+ * Makes the vertex dirty if mark is set and pushes its area if it is
+ * dirty. The endpoints of an open line are never removed and are skipped.
+ *
+ * @param replay Replayed ring
+ * @param vertex Vertex whose neighbours changed
+ * @param mark   Nonzero if the change differs from the chunk's elimination
+ * @return int 0 on success, -1 if the heap could not be grown
+ */
+static int replay_touch(JoinReplay* replay, VertexIndex vertex, int mark) {
+    if (!replay->closed && (vertex == 0 || vertex == replay->num_points - 1))
+        return 0;
+    if (mark)
+        replay->dirty[vertex] = 1;
+    if (!replay->dirty[vertex])
+        return 0;
+    replay->top_checked = 0;
+    return heap_push(replay->heap, replay_area(replay, vertex), vertex);
+}
+
+/**
+ * @brief Smallest live area of a dirty vertex, dropping stale entries
+ *
+ * Entries only go stale through replay_touch, so a checked top stays live
+ * until the next push or pop.
+ *
+ * @param replay Replayed ring
+ * @return double Smallest area, infinite if no dirty vertex is left
+ */
+static double replay_min_dirty(JoinReplay* replay) {
+    MinHeap* heap = replay->heap;
+    while (heap->size > 0) {
+        HeapItem item = heap->items[0];
+        if (replay->top_checked ||
+            (vertex_active(replay->links, item.index) &&
+             replay_area(replay, item.index) == item.area)) {
+            replay->top_checked = 1;
+            return item.area;
+        }
+        heap_pop(heap);
+    }
+    return INFINITY;
+}
+
+/**
+ * @brief Remove a vertex from the replayed ring
+ *
+ * @param replay Replayed ring
+ * @param vertex Vertex to remove
+ * @param mark   Nonzero if its neighbours differ from the chunk's elimination from now on
+ * @return int 0 on success, -1 if the heap could not be grown
+ */
+static int replay_remove(JoinReplay* replay, VertexIndex vertex, int mark) {
+    VertexLink* links = replay->links;
+    VertexIndex prev_idx = links[vertex].prev;
+    VertexIndex next_idx = links[vertex].next;
+    links[prev_idx].next = next_idx;
+    links[next_idx].prev = prev_idx;
+    links[vertex].next = VERTEX_REMOVED;
+    return replay_touch(replay, prev_idx, mark) | replay_touch(replay, next_idx, mark);
+}
+
+/**
+ * @brief Whether the k-th resolution in descending order repeats the one before
+ */
+static inline int repeated_target(const int* resolutions, const int* order, int k) {
+    return k > 0 && resolutions[order[k]] == resolutions[order[k - 1]];
+}
+
+/**
+ * @brief Simplify on the calling thread, for rings too small to split
+ */
+static int serial_simplify(const Coords* coords, VertexIndex num_points, int closed,
+                           AreaMetric metric, const int* resolutions, const int* order,
+                           int num_resolutions, void* const* out_data) {
+    Workspace* ws = scratch_acquire(num_points);
+    if (!ws)
+        return -1;
+
+    ws->metric = metric;
+    simplify_begin(ws, coords, num_points, closed);
+    for (int k = 0; k < num_resolutions; k++) {
+        if (repeated_target(resolutions, order, k))
+            continue;
+        int target = resolutions[order[k]];
+        simplify_to(ws, coords, target);
+        extract_simplified(coords, ws->links, first_active_vertex(ws), target, closed,
+                           out_data[order[k]]);
+    }
+
+    scratch_release(ws);
+    return 0;
+}
+
+int chunked_simplify(const Coords* coords, VertexIndex num_points, int closed,
+                     AreaMetric metric, const int* resolutions, const int* order,
+                     int num_resolutions, int num_threads, void* const* out_data) {
+    int num_chunks = num_threads;
+    if (num_chunks > num_points / CHUNK_MIN_VERTICES)
+        num_chunks = (int)(num_points / CHUNK_MIN_VERTICES);
+    if (num_chunks < 2)
+        return serial_simplify(coords, num_points, closed, metric, resolutions, order,
+                               num_resolutions, out_data);
+
+    VertexIndex* ends = malloc((num_chunks + 1) * sizeof(VertexIndex));
+    VertexIndex* cursor = malloc(num_chunks * sizeof(VertexIndex));
+    VertexIndex* chunk_order = malloc(((size_t)num_points + num_chunks) * sizeof(VertexIndex));
+    double* chunk_keys = malloc(((size_t)num_points + num_chunks) * sizeof(double));
+    IndexedMinHeap* merge = indexed_heap_create(num_chunks);
+    JoinReplay replay = {coords, malloc((size_t)num_points * sizeof(VertexLink)),
+                         calloc((size_t)num_points, 1), heap_create(16 * (num_chunks + 1)), 0,
+                         num_points, closed, metric, 1.0};
+    int status = -1;
+    if (!ends || !cursor || !chunk_order || !chunk_keys || !merge || !replay.links ||
+        !replay.dirty || !replay.heap)
+        goto cleanup;
+
+    // Split evenly, moving every inner end to a prominent vertex nearby. A
+    // ring is cut open between its last and first vertex, which both
+    // become chunk ends
+    ends[0] = 0;
+    ends[num_chunks] = num_points - 1;
+    for (int c = 1; c < num_chunks; c++) {
+        VertexIndex split = (VertexIndex)((int64_t)(num_points - 1) * c / num_chunks);
+        ends[c] = pick_chunk_end(coords, split - CHUNK_JOIN_WINDOW, split + CHUNK_JOIN_WINDOW);
+    }
+    if (metric == METRIC_CONVEXITY || metric == METRIC_SIGNED)
+        replay.orientation = ring_orientation(coords, num_points);
+
+    ChunkJob job = {
+        .coords = coords, .ends = ends, .num_chunks = num_chunks, .metric = metric,
+        .orientation = replay.orientation, .order = chunk_order, .keys = chunk_keys
+    };
+    mutex_init(&job.lock);
+    parallel_run(num_threads, chunk_worker, &job);
+    mutex_destroy(&job.lock);
+    if (job.failed)
+        goto cleanup;
+
+    // Replay the chunk records on the whole ring as one heap over all
+    // chunks would order them, with the chunk ends removable again
+    VertexLink* links = replay.links;
+    for (VertexIndex i = 0; i < num_points; i++) {
+        links[i].prev = i - 1;
+        links[i].next = i + 1;
+    }
+    links[0].prev = closed ? num_points - 1 : -1;
+    links[num_points - 1].next = closed ? 0 : -1;
+    for (int c = 0; c <= num_chunks; c++) {
+        if (replay_touch(&replay, ends[c], 1) != 0)
+            goto cleanup;
+    }
+    for (int c = 0; c < num_chunks; c++) {
+        cursor[c] = 0;
+        if (ends[c + 1] - ends[c] > 1)
+            indexed_heap_push(merge, chunk_keys[ends[c] + c], c);
+    }
+
+    VertexIndex active = num_points, first = 0;
+    for (int k = 0; k < num_resolutions; k++) {
+        int j = order[k];
+        VertexIndex target = resolutions[j];
+        if (repeated_target(resolutions, order, k))
+            continue;
+
+        while (active > target) {
+            double dirty_area = replay_min_dirty(&replay);
+            if (merge->size == 0 || dirty_area < merge->areas[0]) {
+                if (replay.heap->size == 0)
+                    break;
+                replay.top_checked = 0;
+                if (replay_remove(&replay, heap_pop(replay.heap).index, 1) != 0)
+                    goto cleanup;
+                active--;
+                continue;
+            }
+
+            int c = (int)merge->indices[0];
+            VertexIndex base = ends[c] + c;
+            VertexIndex vertex = ends[c] + chunk_order[base + cursor[c]];
+            if (++cursor[c] < ends[c + 1] - ends[c] - 1)
+                indexed_heap_update(merge, c, chunk_keys[base + cursor[c]]);
+            else
+                indexed_heap_pop(merge);
+
+            if (!replay.dirty[vertex]) {
+                if (replay_remove(&replay, vertex, 0) != 0)
+                    goto cleanup;
+                active--;
+            } else if (vertex_active(links, vertex)) {
+                // The chunk removed a vertex the ring still has, so its
+                // neighbours now differ from the chunk's
+                if (replay_touch(&replay, links[vertex].prev, 1) != 0 ||
+                    replay_touch(&replay, links[vertex].next, 1) != 0)
+                    goto cleanup;
+            }
+        }
+
+        while (!vertex_active(links, first))
+            first++;
+        extract_simplified(coords, links, first, target, closed, out_data[j]);
+    }
+    status = 0;
+
+cleanup:
+    free(ends);
+    free(cursor);
+    free(chunk_order);
+    free(chunk_keys);
+    if (merge)
+        indexed_heap_destroy(merge);
+    free(replay.links);
+    free(replay.dirty);
+    if (replay.heap)
+        heap_destroy(replay.heap);
+    return status;
+}
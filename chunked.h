@@ -0,0 +1,57 @@
+/**
+ * @file chunked.h
+ * @brief Multi-threaded simplification of a single large ring
+ *
+ * This header defines a driver that splits one ring or open line into
+ * consecutive chunks whose end vertices are pinned, records the full
+ * elimination of every chunk on its own thread, and replays the chunk
+ * records on the whole ring in the order of their removal keys, as one
+ * heap over all chunks would remove them. Chunks do not affect each other
+ * except through their ends, so the records hold until the replay
+ * removes an end or a vertex whose neighbourhood an end changed. Those
+ * few vertices near the joins get their live areas in a small serial
+ * heap that competes with the records, so the result is the one the
+ * serial elimination gives, up to the order of exactly equal areas.
+ *
+ * The chunk eliminations, which hold the O(n log n) heap work, run in
+ * parallel; the replay is a single serial pass over the records.
+ */
+
+#ifndef CHUNKED_H
+#define CHUNKED_H
+
+#include "geometry.h"
+
+/**
+ * @def CHUNK_MIN_VERTICES
+ * @brief Fewest vertices per chunk; smaller rings use fewer chunks
+ */
+#ifndef CHUNK_MIN_VERTICES
+#define CHUNK_MIN_VERTICES 65536
+#endif
+
+/**
+ * @brief Simplify one ring or line to several resolutions on several threads
+ *
+ * Rings too small for two chunks, or a single thread, run the serial
+ * elimination and give exactly the simplify_multi result.
+ *
+ * @param coords          Ring (unclosed) or line coordinates
+ * @param num_points      Number of vertices
+ * @param closed          Nonzero for a ring, zero for an open line
+ * @param metric          Effective area used to rank vertices
+ * @param resolutions     Target resolutions, min_vertices to num_points - 1
+ * @param order           Resolution indices sorted by descending resolution
+ * @param num_resolutions Number of resolutions
+ * @param num_threads     Number of threads, at least 1
+ * @param out_data        One destination per resolution for resolutions[j] +
+ *                        closed points in the input storage type; repeats of
+ *                        a resolution are skipped and may share the first
+ *                        one's destination
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int chunked_simplify(const Coords* coords, VertexIndex num_points, int closed,
+                     AreaMetric metric, const int* resolutions, const int* order,
+                     int num_resolutions, int num_threads, void* const* out_data);
+
+#endif /* CHUNKED_H */
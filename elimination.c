@@ -0,0 +1,194 @@
+#include <stdlib.h>
+#include "elimination.h"
+#include "simplify.h"
+#include "scratch.h"
+
+/**
+ * @brief qsort comparison of two vertex indices
+ */
+static int compare_vertex(const void* a, const void* b) {
+    VertexIndex x = *(const VertexIndex*)a;
+    VertexIndex y = *(const VertexIndex*)b;
+    return (x > y) - (x < y);
+}
+
+EliminationIndex* elimination_index_create(const Coords* coords, VertexIndex num_points,
+                                           int closed) {
+    EliminationIndex* index = (EliminationIndex*)calloc(1, sizeof(EliminationIndex));
+    if (!index)
+        return NULL;
+
+    index->num_points = num_points;
+    index->dims = coords->dims;
+    index->closed = closed;
+    index->points = malloc((size_t)coords->dims * num_points * sizeof(double));
+    index->order = malloc((size_t)num_points * sizeof(VertexIndex));
+    index->order_areas = malloc((size_t)num_points * sizeof(double));
+    if (!index->points || !index->order || !index->order_areas) {
+        elimination_index_destroy(index);
+        return NULL;
+    }
+
+    for (VertexIndex i = 0; i < num_points; i++) {
+        double* point = index->points + (ptrdiff_t)index->dims * i;
+        for (int d = 0; d < index->dims; d++) {
+            point[d] = coords->type == COORD_FLOAT32 ? COORD_VALUE(coords, float, i, d)
+                                                     : COORD_VALUE(coords, double, i, d);
+        }
+    }
+    return index;
+}
+
+int elimination_index_rank(EliminationIndex* index, const Coords* coords, AreaMetric metric) {
+    Workspace* ws = scratch_acquire(index->num_points);
+    if (!ws)
+        return -1;
+
+    ws->metric = metric;
+    simplify_rank(ws, coords, index->num_points, index->closed, index->order,
+                  index->order_areas);
+    scratch_release(ws);
+    return 0;
+}
+
+EliminationIndex* elimination_index_build(const Coords* coords, VertexIndex num_points, int closed,
+                                          AreaMetric metric) {
+    EliminationIndex* index = elimination_index_create(coords, num_points, closed);
+    if (index && elimination_index_rank(index, coords, metric) != 0) {
+        elimination_index_destroy(index);
+        return NULL;
+    }
+    return index;
+}
+
+void elimination_index_destroy(EliminationIndex* index) {
+    if (!index)
+        return;
+    free(index->points);
+    free(index->order);
+    free(index->order_areas);
+    free(index);
+}
+
+VertexIndex elimination_index_count_for_area(const EliminationIndex* index, double threshold) {
+    // Binary search for the first rank whose effective area exceeds threshold
+    VertexIndex lo = 0;
+    VertexIndex hi = index->num_points - min_vertices(index->closed);
+    while (lo < hi) {
+        VertexIndex mid = lo + (hi - lo) / 2;
+        if (index->order_areas[mid] <= threshold)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return index->num_points - lo;
+}
+
+int elimination_order_kept(const VertexIndex* order, VertexIndex num_points, VertexIndex target,
+                           VertexIndex* kept) {
+    if (target <= num_points / 8) {
+        // Few vertices: sort the last target ranks back into ring order
+        for (VertexIndex i = 0; i < target; i++)
+            kept[i] = order[num_points - target + i];
+        qsort(kept, target, sizeof(VertexIndex), compare_vertex);
+        return 0;
+    }
+
+    // Many vertices: mark the kept ones and scan the ring once
+    char* keep = calloc((size_t)num_points, sizeof(char));
+    if (!keep)
+        return -1;
+    for (VertexIndex i = num_points - target; i < num_points; i++)
+        keep[order[i]] = 1;
+
+    VertexIndex k = 0;
+    for (VertexIndex i = 0; i < num_points; i++) {
+        if (keep[i])
+            kept[k++] = i;
+    }
+    free(keep);
+    return 0;
+}
+
+int elimination_index_extract(const EliminationIndex* index, VertexIndex target,
+                              double* result_data) {
+    const double* points = index->points;
+    VertexIndex* kept = malloc((size_t)target * sizeof(VertexIndex));
+    if (!kept || elimination_order_kept(index->order, index->num_points, target, kept) != 0) {
+        free(kept);
+        return -1;
+    }
+
+    const int dims = index->dims;
+    for (VertexIndex k = 0; k < target; k++) {
+        const double* point = points + (ptrdiff_t)dims * kept[k];
+        for (int d = 0; d < dims; d++)
+            result_data[(ptrdiff_t)dims * k + d] = point[d];
+    }
+    free(kept);
+
+    // Add closure point
+    if (index->closed) {
+        for (int d = 0; d < dims; d++)
+            result_data[(ptrdiff_t)dims * target + d] = result_data[d];
+    }
+    return 0;
+}
+
+int elimination_index_progressive(const EliminationIndex* index, double* points,
+                                  VertexIndex* links, double* areas) {
+    VertexIndex num_points = index->num_points;
+    VertexIndex num_removed = num_points - min_vertices(index->closed);
+    VertexIndex* position = malloc((size_t)num_points * sizeof(VertexIndex));
+    VertexLink* ring = malloc((size_t)num_points * sizeof(VertexLink));
+    if (!position || !ring) {
+        free(position);
+        free(ring);
+        return -1;
+    }
+
+    // Survivors are last in order, in ring order; removals follow them reversed
+    for (VertexIndex s = 0; s < num_points; s++) {
+        VertexIndex rank = s < num_points - num_removed ? num_removed + s : num_points - 1 - s;
+        VertexIndex vertex = index->order[rank];
+        position[vertex] = s;
+        const double* point = index->points + (ptrdiff_t)index->dims * vertex;
+        for (int d = 0; d < index->dims; d++)
+            points[(ptrdiff_t)index->dims * s + d] = point[d];
+        areas[s] = index->order_areas[rank];
+    }
+
+    for (VertexIndex i = 0; i < num_points; i++) {
+        ring[i].prev = i - 1;
+        ring[i].next = i + 1;
+    }
+    if (index->closed) {
+        ring[0].prev = num_points - 1;
+        ring[num_points - 1].next = 0;
+    } else {
+        ring[num_points - 1].next = -1;
+    }
+
+    // Replay the removals; a vertex's neighbours when it is removed are the
+    // ones it is inserted between
+    for (VertexIndex rank = 0; rank < num_removed; rank++) {
+        VertexIndex vertex = index->order[rank];
+        VertexLink link = ring[vertex];
+        VertexIndex s = position[vertex];
+        links[2 * s] = position[link.prev];
+        links[2 * s + 1] = position[link.next];
+        ring[link.prev].next = link.next;
+        ring[link.next].prev = link.prev;
+    }
+    for (VertexIndex rank = num_removed; rank < num_points; rank++) {
+        VertexIndex vertex = index->order[rank];
+        VertexLink link = ring[vertex];
+        VertexIndex s = position[vertex];
+        links[2 * s] = link.prev >= 0 ? position[link.prev] : -1;
+        links[2 * s + 1] = link.next >= 0 ? position[link.next] : -1;
+    }
+
+    free(position);
+    free(ring);
+    return 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file elimination.h
+ * @brief Precomputed elimination order of a ring
+ *
+ * This header defines an index that runs the Visvalingam-Whyatt loop to
+ * completion once and keeps the removal rank and effective area of every
+ * vertex. Any vertex count or area threshold can then be served by
+ * selecting the highest-ranked vertices, without touching the heap again.
+ */
+
+#ifndef ELIMINATION_H
+#define ELIMINATION_H
+
+#include "geometry.h"
+
+/**
+ * @struct EliminationIndex
+ * @brief Elimination order of a single ring or open line
+ *
+ * @param points      Float64 copy of the ring coordinates, dims values per point
+ * @param order       Vertex indices by removal rank, survivors last
+ * @param order_areas Non-decreasing effective area of every rank
+ * @param num_points  Number of vertices in the ring
+ * @param dims        Columns of every point, those of the input
+ * @param closed      Nonzero for a ring, zero for an open line
+ */
+typedef struct {
+    double* points;
+    VertexIndex* order;
+    double* order_areas;
+    VertexIndex num_points;
+    int dims;
+    int closed;
+} EliminationIndex;
+
+/**
+ * @brief Allocate an elimination index and copy a ring into it
+ *
+ * The order and effective areas are allocated but not filled; either
+ * elimination_index_rank computes them or the caller copies them in,
+ * e.g. from an order cache.
+ *
+ * @param coords     Ring (unclosed) or line coordinates, every column copied
+ *                   into the index
+ * @param num_points Number of vertices (at least min_vertices)
+ * @param closed     Nonzero for a ring, zero for an open line
+ * @return EliminationIndex* New index or NULL if memory could not be allocated
+ */
+EliminationIndex* elimination_index_create(const Coords* coords, VertexIndex num_points,
+                                           int closed);
+
+/**
+ * @brief Fill the order and effective areas of an index
+ *
+ * Ranks the view the index was created from rather than its float64 copy,
+ * so results match a simplification of the caller's storage type.
+ *
+ * @param index  Index from elimination_index_create
+ * @param coords Coordinates the index was created from
+ * @param metric Effective area used to rank vertices
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int elimination_index_rank(EliminationIndex* index, const Coords* coords, AreaMetric metric);
+
+/**
+ * @brief Build the elimination index of a ring or open line
+ *
+ * @param coords     Ring (unclosed) or line coordinates, copied into the index
+ * @param num_points Number of vertices (at least min_vertices)
+ * @param closed     Nonzero for a ring, zero for an open line
+ * @param metric     Effective area used to rank vertices
+ * @return EliminationIndex* New index or NULL if memory could not be allocated
+ */
+EliminationIndex* elimination_index_build(const Coords* coords, VertexIndex num_points, int closed,
+                                          AreaMetric metric);
+
+/**
+ * @brief Free all memory associated with the index
+ *
+ * @param index Index to destroy (may be NULL)
+ */
+void elimination_index_destroy(EliminationIndex* index);
+
+/**
+ * @brief Number of vertices whose effective area exceeds a threshold
+ *
+ * Always at least min_vertices, as the last vertices are never removed.
+ *
+ * @param index     Elimination index
+ * @param threshold Largest effective area that is removed
+ * @return VertexIndex Number of vertices kept for the threshold
+ */
+VertexIndex elimination_index_count_for_area(const EliminationIndex* index, double threshold);
+
+/**
+ * @brief Vertices kept at a target, in ring order, from an elimination order
+ *
+ * Runs in O(target log target) for small targets and O(n) otherwise.
+ *
+ * @param order      Vertex indices by removal rank, as in EliminationIndex
+ * @param num_points Number of vertices in the ring
+ * @param target     Number of vertices to keep, min_vertices to num_points
+ * @param kept       Receives the target kept vertex indices, ascending
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int elimination_order_kept(const VertexIndex* order, VertexIndex num_points, VertexIndex target,
+                           VertexIndex* kept);
+
+/**
+ * @brief Write the ring simplified to target vertices
+ *
+ * Vertices are written in ring order followed by a closure point for rings,
+ * with every column of the input. Runs in O(target log target) for small
+ * targets and O(n) otherwise.
+ *
+ * @param index       Elimination index
+ * @param target      Number of vertices to keep, min_vertices to num_points
+ * @param result_data Destination array for target + closed points of dims values
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int elimination_index_extract(const EliminationIndex* index, VertexIndex target,
+                              double* result_data);
+
+/**
+ * @brief Write the ring as a progressive vertex insertion stream
+ *
+ * Entry s of the stream is a vertex: the first min_vertices entries are
+ * the vertices that are never removed, in ring order, and the rest are
+ * the removed vertices in reverse elimination order. Every entry comes
+ * with the stream positions of its previous and next neighbour when it
+ * is inserted, which are always earlier entries, so any prefix of k
+ * entries links into the ring simplified to k vertices. The base entries
+ * link to each other, and the endpoints of an open line to -1.
+ *
+ * @param index  Elimination index
+ * @param points Destination for num_points points of dims values
+ * @param links  Destination for num_points (prev, next) stream position pairs
+ * @param areas  Destination for the effective area of every entry, inf for
+ *               the base entries and non-increasing after them
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int elimination_index_progressive(const EliminationIndex* index, double* points,
+                                  VertexIndex* links, double* areas);
+
+#endif /* ELIMINATION_H */
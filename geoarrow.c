@@ -0,0 +1,505 @@
+#include <stdlib.h>
+#include <string.h>
+#include "geoarrow.h"
+
+/** Stand-in for the buffers Arrow allows to be NULL in empty arrays */
+static const int64_t empty_buffer[2] = {0, 0};
+
+/**
+ * @brief Whether an array has a validity bitmap with nulls in it
+ *
+ * @param array Arrow array
+ * @return int Nonzero if some entries may be null
+ */
+static int has_nulls(const struct ArrowArray* array) {
+    return array->null_count != 0 && array->n_buffers > 0 && array->buffers[0] != NULL;
+}
+
+/**
+ * @brief Data buffer of an array, or a zero buffer if an empty array has none
+ *
+ * @param array Arrow array
+ * @param i     Buffer index
+ * @return const void* Buffer, NULL if a non-empty array lacks it
+ */
+static const void* array_buffer(const struct ArrowArray* array, int i) {
+    if (array->n_buffers <= i)
+        return NULL;
+    if (!array->buffers[i] && array->length == 0)
+        return empty_buffer;
+    return array->buffers[i];
+}
+
+/**
+ * @brief Read a native-endian int32 from unaligned schema metadata
+ *
+ * @param p Position in the metadata
+ * @return int32_t Value at p
+ */
+static int32_t metadata_int(const char* p) {
+    int32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Size in bytes of encoded schema metadata
+ *
+ * @param metadata Metadata, or NULL
+ * @return size_t Size, 0 if metadata is NULL
+ */
+static size_t metadata_size(const char* metadata) {
+    if (!metadata)
+        return 0;
+    const char* p = metadata + sizeof(int32_t);
+    for (int32_t i = 0; i < metadata_int(metadata); i++) {
+        p += sizeof(int32_t) + metadata_int(p);  // key
+        p += sizeof(int32_t) + metadata_int(p);  // value
+    }
+    return (size_t)(p - metadata);
+}
+
+/**
+ * @brief Check whether a metadata key has the given value
+ *
+ * @param metadata Metadata, or NULL
+ * @param key      Key to look up
+ * @param value    Expected value
+ * @return int Nonzero if key is present with exactly that value
+ */
+static int metadata_equals(const char* metadata, const char* key, const char* value) {
+    if (!metadata)
+        return 0;
+    const char* p = metadata + sizeof(int32_t);
+    for (int32_t i = 0; i < metadata_int(metadata); i++) {
+        int32_t key_size = metadata_int(p);
+        const char* key_data = p + sizeof(int32_t);
+        p = key_data + key_size;
+        int32_t value_size = metadata_int(p);
+        const char* value_data = p + sizeof(int32_t);
+        p = value_data + value_size;
+        if ((size_t)key_size == strlen(key) && memcmp(key_data, key, key_size) == 0)
+            return (size_t)value_size == strlen(value) &&
+                   memcmp(value_data, value, value_size) == 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Whether a format string is a list, and of which offset width
+ *
+ * @param format Arrow format string
+ * @return int 1 for "+l", 2 for "+L", 0 otherwise
+ */
+static int list_format(const char* format) {
+    if (strcmp(format, "+l") == 0)
+        return 1;
+    if (strcmp(format, "+L") == 0)
+        return 2;
+    return 0;
+}
+
+/**
+ * @brief Coordinate storage type of a primitive format string
+ *
+ * @param format Arrow format string
+ * @param type   Receives the storage type
+ * @return int 0 for "g" and "f", -1 otherwise
+ */
+static int value_format(const char* format, CoordType* type) {
+    if (strcmp(format, "g") == 0)
+        *type = COORD_FLOAT64;
+    else if (strcmp(format, "f") == 0)
+        *type = COORD_FLOAT32;
+    else
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief Check that a values array holds rows [first, first + count) without nulls
+ *
+ * @param schema Values schema
+ * @param array  Values array
+ * @param first  First physical row needed, before the array offset
+ * @param count  Number of rows needed
+ * @param type   Receives the storage type
+ * @return const char* Start of the first needed value, NULL if unusable
+ */
+static const char* coordinate_values(const struct ArrowSchema* schema,
+                                     const struct ArrowArray* array, int64_t first,
+                                     int64_t count, CoordType* type) {
+    if (value_format(schema->format, type) != 0 || has_nulls(array) ||
+        array->length < first + count)
+        return NULL;
+    const char* data = array_buffer(array, 1);
+    if (!data)
+        return NULL;
+    return data + (array->offset + first) * (int64_t)coord_size(*type);
+}
+
+int geoarrow_view_init(GeoArrowView* view, const struct ArrowSchema* schema,
+                       const struct ArrowArray* array, const char** error) {
+    memset(view, 0, sizeof(*view));
+    view->name = schema->name;
+    view->metadata = schema->metadata;
+
+    if (array->n_buffers > 0 && array->null_count != 0 && array->buffers[0]) {
+        view->validity = array->buffers[0];
+        view->validity_offset = array->offset;
+        view->null_count = array->null_count;
+        if (view->null_count < 0) {
+            view->null_count = 0;
+            for (int64_t i = 0; i < array->length; i++) {
+                int64_t bit = array->offset + i;
+                view->null_count += !((view->validity[bit >> 3] >> (bit & 7)) & 1);
+            }
+        }
+    }
+
+    // Walk down the list levels; first and length are the rows used at each
+    int64_t first = array->offset;
+    int64_t length = array->length;
+    int depth = 0;
+    int kind;
+    while ((kind = list_format(schema->format)) != 0) {
+        if (depth == GEOARROW_MAX_DEPTH) {
+            *error = "Too many nested lists for a GeoArrow geometry";
+            return -1;
+        }
+        if (schema->n_children != 1 || array->n_children != 1 || array->n_buffers != 2) {
+            *error = "Malformed list array";
+            return -1;
+        }
+        if (depth > 0 && has_nulls(array)) {
+            *error = "Nulls are only supported at the top level";
+            return -1;
+        }
+
+        const char* offsets = array_buffer(array, 1);
+        if (!offsets) {
+            *error = "List array has no offsets buffer";
+            return -1;
+        }
+        view->large[depth] = kind == 2;
+        view->offsets[depth] = offsets + first * (kind == 2 ? sizeof(int64_t) : sizeof(int32_t));
+        view->level_length[depth] = length;
+
+        const struct ArrowArray* child = array->children[0];
+        for (int64_t i = 0; i < length; i++) {
+            if (geoarrow_offset(view, depth, i + 1) < geoarrow_offset(view, depth, i)) {
+                *error = "Offsets must be non-decreasing";
+                return -1;
+            }
+        }
+        int64_t start = view->large[depth] ? ((const int64_t*)view->offsets[depth])[0]
+                                           : ((const int32_t*)view->offsets[depth])[0];
+        int64_t count = geoarrow_offset(view, depth, length);
+        if (start < 0 || start + count > child->length) {
+            *error = "Offsets out of range of the child array";
+            return -1;
+        }
+
+        first = child->offset + start;
+        length = count;
+        schema = schema->children[0];
+        array = child;
+        depth++;
+    }
+    if (depth == 0) {
+        *error = "Point arrays have no lines or rings to simplify";
+        return -1;
+    }
+    view->depth = depth;
+    view->level_length[depth] = length;
+
+    // Points: interleaved fixed-size lists or separated x and y structs
+    if (has_nulls(array)) {
+        *error = "Null points are not supported";
+        return -1;
+    }
+    const char* x = NULL;
+    const char* y = NULL;
+    CoordType type = COORD_FLOAT64;
+    CoordType y_type = COORD_FLOAT64;
+    if (strcmp(schema->format, "+w:2") == 0) {
+        if (schema->n_children == 1 && array->n_children == 1 &&
+            array->offset + array->length >= first + length)
+            x = coordinate_values(schema->children[0], array->children[0], 2 * first,
+                                  2 * length, &type);
+        if (x) {
+            view->coords.data = x;
+            view->coords.stride = 2 * (ptrdiff_t)coord_size(type);
+            view->coords.col_stride = (ptrdiff_t)coord_size(type);
+        }
+    } else if (strcmp(schema->format, "+s") == 0) {
+        if (schema->n_children == 2 && array->n_children == 2 &&
+            array->offset + array->length >= first + length) {
+            x = coordinate_values(schema->children[0], array->children[0], first, length, &type);
+            y = coordinate_values(schema->children[1], array->children[1], first, length, &y_type);
+        }
+        if (x && y && type == y_type) {
+            // Coords reaches the y buffer through the distance between the buffers
+            view->coords.data = x;
+            view->coords.stride = (ptrdiff_t)coord_size(type);
+            view->coords.col_stride = y - x;
+        }
+    }
+    if (!view->coords.data) {
+        *error = "Points must be a fixed-size list of 2 or a struct of x and y, "
+                 "of float64 or float32 values";
+        return -1;
+    }
+    view->coords.type = type;
+    view->coords.dims = 2;
+
+    const char* extension = "ARROW:extension:name";
+    if (metadata_equals(view->metadata, extension, "geoarrow.linestring") ||
+        metadata_equals(view->metadata, extension, "geoarrow.multilinestring"))
+        view->closed = 0;
+    else if (metadata_equals(view->metadata, extension, "geoarrow.polygon") ||
+             metadata_equals(view->metadata, extension, "geoarrow.multipolygon"))
+        view->closed = 1;
+    else
+        view->closed = depth != 1;
+    return 0;
+}
+
+int geoarrow_buffers_init(GeoArrowBuffers* buffers, const GeoArrowView* view) {
+    buffers->depth = view->depth;
+    buffers->type = view->coords.type;
+    memcpy(buffers->large, view->large, sizeof(buffers->large));
+    memcpy(buffers->level_length, view->level_length, sizeof(buffers->level_length));
+
+    for (int level = 0; level < view->depth; level++) {
+        int64_t rows = view->level_length[level];
+        size_t width = view->large[level] ? sizeof(int64_t) : sizeof(int32_t);
+        buffers->offsets[level] = malloc((rows + 1) * width);
+        if (!buffers->offsets[level])
+            return -1;
+        if (level == view->depth - 1)
+            continue;  // filled by the caller
+        for (int64_t i = 0; i <= rows; i++) {
+            int64_t offset = geoarrow_offset(view, level, i);
+            if (view->large[level])
+                ((int64_t*)buffers->offsets[level])[i] = offset;
+            else
+                ((int32_t*)buffers->offsets[level])[i] = (int32_t)offset;
+        }
+    }
+
+    if (view->validity) {
+        int64_t rows = view->level_length[0];
+        buffers->validity = calloc((rows + 7) / 8 + 1, 1);
+        if (!buffers->validity)
+            return -1;
+        if ((view->validity_offset & 7) == 0) {
+            memcpy(buffers->validity, view->validity + (view->validity_offset >> 3),
+                   (rows + 7) / 8);
+        } else {
+            for (int64_t i = 0; i < rows; i++) {
+                int64_t bit = view->validity_offset + i;
+                if ((view->validity[bit >> 3] >> (bit & 7)) & 1)
+                    buffers->validity[i >> 3] |= (uint8_t)(1 << (i & 7));
+            }
+        }
+        buffers->null_count = view->null_count;
+    }
+
+    if (view->name) {
+        buffers->name = malloc(strlen(view->name) + 1);
+        if (!buffers->name)
+            return -1;
+        strcpy(buffers->name, view->name);
+    }
+    if (view->metadata) {
+        size_t size = metadata_size(view->metadata);
+        buffers->metadata = malloc(size);
+        if (!buffers->metadata)
+            return -1;
+        memcpy(buffers->metadata, view->metadata, size);
+    }
+    return 0;
+}
+
+void geoarrow_buffers_free(GeoArrowBuffers* buffers) {
+    for (int level = 0; level < GEOARROW_MAX_DEPTH; level++)
+        free(buffers->offsets[level]);
+    free(buffers->validity);
+    free(buffers->coords);
+    free(buffers->name);
+    free(buffers->metadata);
+    memset(buffers, 0, sizeof(*buffers));
+}
+
+/**
+ * @struct SchemaNode
+ * @brief Private data of one exported schema node and storage for its child
+ */
+typedef struct {
+    struct ArrowSchema child;
+    struct ArrowSchema* children[1];
+    char format[8];
+    char* name;
+    char* metadata;
+} SchemaNode;
+
+static void schema_release(struct ArrowSchema* schema) {
+    SchemaNode* node = schema->private_data;
+    if (schema->n_children > 0 && node->child.release)
+        node->child.release(&node->child);
+    free(node->name);
+    free(node->metadata);
+    free(node);
+    schema->release = NULL;
+}
+
+/**
+ * @brief Fill one schema node
+ *
+ * @param out       Schema node to fill
+ * @param format    Format string
+ * @param name      Field name, NULL for none
+ * @param metadata  Field metadata, NULL for none
+ * @param has_child Nonzero to give the node one child, left to be filled
+ * @return struct ArrowSchema* The child, out itself without one, NULL on failure
+ */
+static struct ArrowSchema* schema_node_init(struct ArrowSchema* out, const char* format,
+                                            const char* name, const char* metadata,
+                                            int has_child) {
+    SchemaNode* node = calloc(1, sizeof(SchemaNode));
+    if (!node)
+        return NULL;
+    strcpy(node->format, format);
+    node->name = malloc(strlen(name ? name : "") + 1);
+    size_t size = metadata_size(metadata);
+    node->metadata = size > 0 ? malloc(size) : NULL;
+    if (!node->name || (size > 0 && !node->metadata)) {
+        free(node->name);
+        free(node->metadata);
+        free(node);
+        return NULL;
+    }
+    strcpy(node->name, name ? name : "");
+    if (size > 0)
+        memcpy(node->metadata, metadata, size);
+    node->children[0] = &node->child;
+
+    memset(out, 0, sizeof(*out));
+    out->format = node->format;
+    out->name = node->name;
+    out->metadata = node->metadata;
+    out->flags = ARROW_FLAG_NULLABLE;
+    out->n_children = has_child ? 1 : 0;
+    out->children = has_child ? node->children : NULL;
+    out->release = schema_release;
+    out->private_data = node;
+    return has_child ? &node->child : out;
+}
+
+int geoarrow_export_schema(const GeoArrowBuffers* buffers, struct ArrowSchema* out) {
+    const char* value_format = buffers->type == COORD_FLOAT32 ? "f" : "g";
+    struct ArrowSchema* node = out;
+    out->release = NULL;
+
+    for (int level = 0; level <= buffers->depth + 1 && node; level++) {
+        const char* name = level == 0 ? buffers->name :
+                           level == buffers->depth + 1 ? "xy" : "item";
+        const char* metadata = level == 0 ? buffers->metadata : NULL;
+        if (level < buffers->depth)
+            node = schema_node_init(node, buffers->large[level] ? "+L" : "+l", name, metadata, 1);
+        else if (level == buffers->depth)
+            node = schema_node_init(node, "+w:2", name, metadata, 1);
+        else
+            node = schema_node_init(node, value_format, name, metadata, 0);
+    }
+    if (!node) {
+        if (out->release)
+            out->release(out);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @struct ArrayNode
+ * @brief Private data of one exported array node and storage for its child
+ */
+typedef struct {
+    struct ArrowArray child;
+    struct ArrowArray* children[1];
+    const void* buffers[2];
+    GeoArrowOwner owner;
+} ArrayNode;
+
+static void array_release(struct ArrowArray* array) {
+    ArrayNode* node = array->private_data;
+    if (array->n_children > 0 && node->child.release)
+        node->child.release(&node->child);
+    node->owner.release(node->owner.owner);
+    free(node);
+    array->release = NULL;
+}
+
+/**
+ * @brief Fill one array node that references buffers of the owner
+ *
+ * @param out        Array node to fill
+ * @param length     Number of entries
+ * @param null_count Number of nulls
+ * @param n_buffers  Number of buffers, 1 or 2
+ * @param validity   Validity bitmap, NULL for none
+ * @param data       Offsets or values buffer; unused if n_buffers is 1
+ * @param has_child  Nonzero to give the node one child, left to be filled
+ * @param owner      Owner of the buffers, retained by the node
+ * @return struct ArrowArray* The child, out itself without one, NULL on failure
+ */
+static struct ArrowArray* array_node_init(struct ArrowArray* out, int64_t length,
+                                          int64_t null_count, int n_buffers,
+                                          const void* validity, const void* data,
+                                          int has_child, const GeoArrowOwner* owner) {
+    ArrayNode* node = calloc(1, sizeof(ArrayNode));
+    if (!node)
+        return NULL;
+    node->buffers[0] = validity;
+    node->buffers[1] = data;
+    node->children[0] = &node->child;
+    node->owner = *owner;
+    owner->retain(owner->owner);
+
+    memset(out, 0, sizeof(*out));
+    out->length = length;
+    out->null_count = null_count;
+    out->n_buffers = n_buffers;
+    out->n_children = has_child ? 1 : 0;
+    out->buffers = node->buffers;
+    out->children = has_child ? node->children : NULL;
+    out->release = array_release;
+    out->private_data = node;
+    return has_child ? &node->child : out;
+}
+
+int geoarrow_export_array(const GeoArrowBuffers* buffers, const GeoArrowOwner* owner,
+                          struct ArrowArray* out) {
+    int depth = buffers->depth;
+    struct ArrowArray* node = out;
+    out->release = NULL;
+
+    for (int level = 0; level < depth && node; level++) {
+        node = array_node_init(node, buffers->level_length[level],
+                               level == 0 ? buffers->null_count : 0, 2,
+                               level == 0 ? buffers->validity : NULL,
+                               buffers->offsets[level], 1, owner);
+    }
+    int64_t num_points = buffers->level_length[depth];
+    if (node)
+        node = array_node_init(node, num_points, 0, 1, NULL, NULL, 1, owner);
+    if (node)
+        node = array_node_init(node, 2 * num_points, 0, 2, NULL, buffers->coords, 0, owner);
+    if (!node) {
+        if (out->release)
+            out->release(out);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file geoarrow.h
+ * @brief GeoArrow arrays read and written through the Arrow C Data Interface
+ *
+ * This header declares the Arrow C Data Interface structures, a view that
+ * reads the offsets and coordinates of a native GeoArrow linestring,
+ * polygon, multilinestring or multipolygon array in place,
+ * and the buffers of a simplified array of the same layout together with
+ * their export as a new Arrow array. Coordinates are read from the
+ * interleaved (fixed-size list) or separated (struct) encodings with
+ * float64 or float32 values; output coordinates are always interleaved.
+ */
+
+#ifndef GEOARROW_H
+#define GEOARROW_H
+
+#include <stdint.h>
+#include "geometry.h"
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif /* ARROW_C_DATA_INTERFACE */
+
+/**
+ * @def GEOARROW_MAX_DEPTH
+ * @brief Most list levels above the coordinates, those of a multipolygon
+ */
+#define GEOARROW_MAX_DEPTH 3
+
+/**
+ * @struct GeoArrowView
+ * @brief Offsets and coordinates of a GeoArrow array, read in place
+ *
+ * Level 0 is the top-level array and level depth the points. Offsets are
+ * rebased so that every level starts at row 0 of the level below it.
+ *
+ * @param depth        List levels above the points: 1 for linestrings,
+ *                     2 for polygons and multilinestrings, 3 for
+ *                     multipolygons
+ * @param closed       1 if the innermost lists are rings, 0 if they are
+ *                     lines, from the extension name or the depth
+ * @param large        Nonzero for the int64 offsets of each list level
+ * @param offsets      Offsets buffer of each list level, at its first row
+ * @param level_length Rows of each level, the points last
+ * @param validity     Top-level validity bitmap, NULL if there are no nulls
+ * @param null_count   Top-level null count
+ * @param validity_offset Bit of validity holding the first top-level row
+ * @param coords       Points of the deepest level, from row 0
+ * @param name         Top-level field name, may be NULL
+ * @param metadata     Top-level field metadata, may be NULL
+ */
+typedef struct {
+    int depth;
+    int closed;
+    int large[GEOARROW_MAX_DEPTH];
+    const void* offsets[GEOARROW_MAX_DEPTH];
+    int64_t level_length[GEOARROW_MAX_DEPTH + 1];
+    const uint8_t* validity;
+    int64_t null_count;
+    int64_t validity_offset;
+    Coords coords;
+    const char* name;
+    const char* metadata;
+} GeoArrowView;
+
+/**
+ * @brief Read offset i of a list level of a view
+ *
+ * @param view  GeoArrow view
+ * @param level List level, 0 to depth - 1
+ * @param i     Row, 0 to level_length[level]
+ * @return int64_t Row of the level below where row i starts
+ */
+static inline int64_t geoarrow_offset(const GeoArrowView* view, int level, int64_t i) {
+    return view->large[level] ? ((const int64_t*)view->offsets[level])[i] -
+                                ((const int64_t*)view->offsets[level])[0]
+                              : (int64_t)((const int32_t*)view->offsets[level])[i] -
+                                ((const int32_t*)view->offsets[level])[0];
+}
+
+/**
+ * @brief Describe a GeoArrow array as a view of its buffers
+ *
+ * Offsets are checked to be non-decreasing and within the level below.
+ * Nulls are allowed only at the top level. Point arrays are rejected, as
+ * they have no lines or rings.
+ *
+ * @param view   View to fill
+ * @param schema Schema of the array
+ * @param array  Array data; it must outlive the view
+ * @param error  Receives a static message on failure
+ * @return int 0 on success, -1 if the array is not a supported layout
+ */
+int geoarrow_view_init(GeoArrowView* view, const struct ArrowSchema* schema,
+                       const struct ArrowArray* array, const char** error);
+
+/**
+ * @struct GeoArrowBuffers
+ * @brief Buffers of a simplified GeoArrow array, owned by the struct
+ *
+ * @param depth        List levels above the points, as in GeoArrowView
+ * @param large        Nonzero for the int64 offsets of each list level
+ * @param offsets      Offsets buffer of each list level, starting at 0
+ * @param level_length Rows of each level, the points last
+ * @param validity     Top-level validity bitmap from bit 0, or NULL
+ * @param null_count   Top-level null count
+ * @param coords       Interleaved x,y pairs of every point
+ * @param type         Storage type of coords
+ * @param name         Top-level field name, or NULL
+ * @param metadata     Top-level field metadata, or NULL
+ */
+typedef struct {
+    int depth;
+    int large[GEOARROW_MAX_DEPTH];
+    void* offsets[GEOARROW_MAX_DEPTH];
+    int64_t level_length[GEOARROW_MAX_DEPTH + 1];
+    uint8_t* validity;
+    int64_t null_count;
+    void* coords;
+    CoordType type;
+    char* name;
+    char* metadata;
+} GeoArrowBuffers;
+
+/**
+ * @brief Allocate output buffers with the structure of a view
+ *
+ * The outer levels, validity, name and metadata are copied from the view.
+ * The innermost offsets are allocated but not filled, and coords is
+ * left NULL for the caller to allocate once the point count is known.
+ *
+ * @param buffers Zero-initialized buffers to fill
+ * @param view    View of the input array
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int geoarrow_buffers_init(GeoArrowBuffers* buffers, const GeoArrowView* view);
+
+/**
+ * @brief Free every buffer held by a GeoArrowBuffers
+ *
+ * @param buffers Buffers, possibly partially initialized
+ */
+void geoarrow_buffers_free(GeoArrowBuffers* buffers);
+
+/**
+ * @struct GeoArrowOwner
+ * @brief Reference counting hooks of the object that owns exported buffers
+ *
+ * Every exported array node holds one reference, so nodes a consumer
+ * moves out of their parent keep the buffers alive on their own.
+ */
+typedef struct {
+    void (*retain)(void* owner);
+    void (*release)(void* owner);
+    void* owner;
+} GeoArrowOwner;
+
+/**
+ * @brief Export the schema of simplified buffers
+ *
+ * @param buffers Simplified buffers
+ * @param out     Schema to fill; released by the consumer
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int geoarrow_export_schema(const GeoArrowBuffers* buffers, struct ArrowSchema* out);
+
+/**
+ * @brief Export simplified buffers as an Arrow array without copying them
+ *
+ * @param buffers Simplified buffers, kept alive by owner
+ * @param owner   Owner of the buffers, retained once per array node
+ * @param out     Array to fill; released by the consumer
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int geoarrow_export_array(const GeoArrowBuffers* buffers, const GeoArrowOwner* owner,
+                          struct ArrowArray* out);
+
+#endif /* GEOARROW_H */
@@ -1,22 +1,334 @@
-#include <math.h>
 #include "geometry.h"
 
-double triangle_area(const double* p1, const double* p2, const double* p3) {
-    return fabs((p2[0] - p1[0]) * (p3[1] - p1[1]) -
-                (p3[0] - p1[0]) * (p2[1] - p1[1])) / 2.0;
+// The error-free transformations below are only exact under IEEE semantics
+#ifdef __FAST_MATH__
+#error "geometry.c must be compiled without -ffast-math"
+#endif
+
+#if !defined(NO_AREA_SIMD) && defined(__AVX2__)
+#define AREA_SIMD_AVX2
+#include <immintrin.h>
+#elif !defined(NO_AREA_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#define AREA_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef AREA_SIMD_AVX2
+/**
+ * @brief Load four consecutive interleaved points as x and y vectors
+ *
+ * The lanes hold points 0, 2, 1, 3; every vector loaded this way shares
+ * the order, so lane-wise arithmetic is unaffected.
+ */
+static inline void load_points_avx2(const double* p, __m256d* x, __m256d* y) {
+    __m256d lo = _mm256_loadu_pd(p);
+    __m256d hi = _mm256_loadu_pd(p + 4);
+    *x = _mm256_unpacklo_pd(lo, hi);
+    *y = _mm256_unpackhi_pd(lo, hi);
+}
+#endif
+
+/**
+ * @brief Sum of a and b as the rounded sum in *sum plus its error
+ */
+static inline double two_sum(double a, double b, double* sum) {
+    double x = a + b;
+    double b_virtual = x - a;
+    double a_virtual = x - b_virtual;
+    *sum = x;
+    return (a - a_virtual) + (b - b_virtual);
+}
+
+/**
+ * @brief Sum of a and b, |a| >= |b|, as the rounded sum in *sum plus its error
+ */
+static inline double fast_two_sum(double a, double b, double* sum) {
+    double x = a + b;
+    *sum = x;
+    return b - (x - a);
+}
+
+/**
+ * @brief Add b to an expansion of increasing magnitude
+ *
+ * @param e   Nonoverlapping components, smallest first; receives the sum
+ * @param len Number of components of e
+ * @param b   Value to add
+ * @return int Number of components of the sum
+ */
+static int grow_expansion(double* e, int len, double b) {
+    int out = 0;
+    for (int i = 0; i < len; i++) {
+        double error = two_sum(b, e[i], &b);
+        if (error != 0.0)
+            e[out++] = error;
+    }
+    e[out++] = b;
+    return out;
+}
+
+/**
+ * @brief Approximate the sum of an expansion by compressing it
+ *
+ * Shewchuk's Compress: a downward pass merges the components into
+ * nonadjacent ones and an upward pass renormalises them, after which the
+ * largest component is within one ulp of the exact sum.
+ *
+ * @param e   Nonoverlapping components, smallest first; overwritten
+ * @param len Number of components of e, at least 1
+ * @return double Largest component of the compressed expansion
+ */
+static double compress_expansion(double* e, int len) {
+    int bottom = len - 1;
+    double q = e[bottom];
+    for (int i = len - 2; i >= 0; i--) {
+        double sum;
+        double error = fast_two_sum(q, e[i], &sum);
+        if (error != 0.0) {
+            e[bottom--] = sum;
+            q = error;
+        } else {
+            q = sum;
+        }
+    }
+    e[bottom] = q;
+    for (int i = bottom + 1; i < len; i++)
+        fast_two_sum(e[i], q, &q);
+    return q;
+}
+
+double exact_triangle_cross(const double* p1, const double* p2, const double* p3) {
+    // Each difference as a rounded value and its error, like two_sum
+    double d[4] = {p2[0] - p1[0], p3[1] - p1[1], p3[0] - p1[0], p2[1] - p1[1]};
+    double a[4] = {p2[0], p3[1], p3[0], p2[1]};
+    double b[4] = {p1[0], p1[1], p1[0], p1[1]};
+    double t[4];
+    for (int k = 0; k < 4; k++) {
+        double b_virtual = a[k] - d[k];
+        double a_virtual = d[k] + b_virtual;
+        t[k] = (a[k] - a_virtual) + (b_virtual - b[k]);
+    }
+    if (!isfinite(d[0] * d[1] - d[2] * d[3]))
+        return d[0] * d[1] - d[2] * d[3];
+
+    // (d0 + t0)(d1 + t1) - (d2 + t2)(d3 + t3) as 16 exact product halves
+    double e[16];
+    int len = 0;
+    for (int k = 0; k < 2; k++) {
+        double sign = k == 0 ? 1.0 : -1.0;
+        double u[2] = {d[2 * k], t[2 * k]};
+        double v[2] = {d[2 * k + 1], t[2 * k + 1]};
+        for (int i = 0; i < 2; i++) {
+            for (int j = 0; j < 2; j++) {
+                double product = sign * u[i] * v[j];
+                double error = fma(sign * u[i], v[j], -product);
+                len = grow_expansion(e, len, error);
+                len = grow_expansion(e, len, product);
+            }
+        }
+    }
+
+    return compress_expansion(e, len);
+}
+
+void initial_triangle_areas(const Coords* coords, VertexIndex first, VertexIndex last,
+                            double* areas) {
+    VertexIndex i = first;
+
+    if (coords->type == COORD_FLOAT64 && coords->stride == 2 * (ptrdiff_t)sizeof(double) &&
+        coords->col_stride == (ptrdiff_t)sizeof(double)) {
+        // Neighbours are the shifted views p - 2 and p + 2 of the same buffer
+        const double* p = (const double*)coords->data;
+#if defined(AREA_SIMD_AVX2)
+        const __m256d sign = _mm256_set1_pd(-0.0);
+        const __m256d half = _mm256_set1_pd(0.5);
+        const __m256d error_bound = _mm256_set1_pd(CROSS_ERROR_BOUND);
+        for (; i + 4 <= last; i += 4) {
+            __m256d ax, ay, bx, by, cx, cy;
+            load_points_avx2(p + 2 * (i - 1), &ax, &ay);
+            load_points_avx2(p + 2 * i, &bx, &by);
+            load_points_avx2(p + 2 * (i + 1), &cx, &cy);
+            __m256d left = _mm256_mul_pd(_mm256_sub_pd(bx, ax), _mm256_sub_pd(cy, ay));
+            __m256d right = _mm256_mul_pd(_mm256_sub_pd(cx, ax), _mm256_sub_pd(by, ay));
+            __m256d cross = _mm256_andnot_pd(sign, _mm256_sub_pd(left, right));
+            __m256d area = _mm256_mul_pd(cross, half);
+            // Lanes come out as 0, 2, 1, 3
+            _mm256_storeu_pd(areas + (i - first), _mm256_permute4x64_pd(area, 0xD8));
+
+            // Lanes the filter of triangle_cross rejects are redone exactly
+            __m256d magnitude = _mm256_add_pd(_mm256_andnot_pd(sign, left),
+                                              _mm256_andnot_pd(sign, right));
+            __m256d bound = _mm256_mul_pd(error_bound, magnitude);
+            __m256d unsure = _mm256_and_pd(_mm256_cmp_pd(cross, bound, _CMP_LE_OQ),
+                                           _mm256_cmp_pd(bound, _mm256_setzero_pd(), _CMP_NEQ_OQ));
+            if (_mm256_movemask_pd(unsure)) {
+                for (VertexIndex k = i; k < i + 4; k++)
+                    areas[k - first] = triangle_area(p + 2 * (k - 1), p + 2 * k, p + 2 * (k + 1));
+            }
+        }
+#elif defined(AREA_SIMD_NEON)
+        for (; i + 2 <= last; i += 2) {
+            float64x2x2_t a = vld2q_f64(p + 2 * (i - 1));
+            float64x2x2_t b = vld2q_f64(p + 2 * i);
+            float64x2x2_t c = vld2q_f64(p + 2 * (i + 1));
+            float64x2_t left = vmulq_f64(vsubq_f64(b.val[0], a.val[0]),
+                                         vsubq_f64(c.val[1], a.val[1]));
+            float64x2_t right = vmulq_f64(vsubq_f64(c.val[0], a.val[0]),
+                                          vsubq_f64(b.val[1], a.val[1]));
+            float64x2_t cross = vabsq_f64(vsubq_f64(left, right));
+            vst1q_f64(areas + (i - first), vmulq_n_f64(cross, 0.5));
+
+            // Lanes the filter of triangle_cross rejects are redone exactly
+            float64x2_t bound = vmulq_n_f64(vaddq_f64(vabsq_f64(left), vabsq_f64(right)),
+                                            CROSS_ERROR_BOUND);
+            uint64x2_t unsure = vandq_u64(vcleq_f64(cross, bound), vcgtzq_f64(bound));
+            if (vgetq_lane_u64(unsure, 0) | vgetq_lane_u64(unsure, 1)) {
+                for (VertexIndex k = i; k < i + 2; k++)
+                    areas[k - first] = triangle_area(p + 2 * (k - 1), p + 2 * k, p + 2 * (k + 1));
+            }
+        }
+#endif
+        for (; i < last; i++)
+            areas[i - first] = triangle_area(p + 2 * (i - 1), p + 2 * i, p + 2 * (i + 1));
+        return;
+    }
+
+    if (i >= last)
+        return;
+    double prev[2], curr[2], next[2];
+    coords_point(coords, i - 1, prev);
+    coords_point(coords, i, curr);
+    for (; i < last; i++) {
+        coords_point(coords, i + 1, next);
+        areas[i - first] = triangle_area(prev, curr, next);
+        prev[0] = curr[0];
+        prev[1] = curr[1];
+        curr[0] = next[0];
+        curr[1] = next[1];
+    }
+}
+
+/**
+ * @def EXTRACT_LOOP
+ * @brief Body of extract_simplified for one storage type and column count
+ */
+#define EXTRACT_LOOP(COORD_T, DIMS)                                             \
+    do {                                                                        \
+        COORD_T* out = (COORD_T*)result_data;                                   \
+        const int dims = (DIMS);                                                \
+        for (VertexIndex i = 0; i < target_vertices; i++) {                     \
+            COORD_T* row = out + (ptrdiff_t)dims * i;                           \
+            for (int d = 0; d < dims; d++)                                      \
+                row[d] = COORD_VALUE(coords, COORD_T, curr_idx, d);             \
+            curr_idx = links[curr_idx].next;                                    \
+        }                                                                       \
+        if (closed) {                                                           \
+            for (int d = 0; d < dims; d++)                                      \
+                out[(ptrdiff_t)dims * target_vertices + d] = out[d];            \
+        }                                                                       \
+    } while (0)
+
+/**
+ * @def COPY_LOOP
+ * @brief Body of copy_ring for one storage type and column count
+ */
+#define COPY_LOOP(COORD_T, DIMS)                                                \
+    do {                                                                        \
+        COORD_T* out = (COORD_T*)result_data;                                   \
+        const int dims = (DIMS);                                                \
+        for (VertexIndex i = 0; i < num_points; i++) {                          \
+            COORD_T* row = out + (ptrdiff_t)dims * i;                           \
+            for (int d = 0; d < dims; d++)                                      \
+                row[d] = COORD_VALUE(coords, COORD_T, i, d);                    \
+        }                                                                       \
+        if (closed) {                                                           \
+            for (int d = 0; d < dims; d++)                                      \
+                out[(ptrdiff_t)dims * num_points + d] = out[d];                 \
+        }                                                                       \
+    } while (0)
+
+/**
+ * @def GATHER_LOOP
+ * @brief Body of gather_points for one storage type and column count
+ */
+#define GATHER_LOOP(COORD_T, DIMS)                                              \
+    do {                                                                        \
+        COORD_T* out = (COORD_T*)result_data;                                   \
+        const int dims = (DIMS);                                                \
+        for (VertexIndex i = 0; i < count; i++) {                               \
+            COORD_T* row = out + (ptrdiff_t)dims * i;                           \
+            for (int d = 0; d < dims; d++)                                      \
+                row[d] = COORD_VALUE(coords, COORD_T, indices[i], d);           \
+        }                                                                       \
+        if (closed) {                                                           \
+            for (int d = 0; d < dims; d++)                                      \
+                out[(ptrdiff_t)dims * count + d] = out[d];                      \
+        }                                                                       \
+    } while (0)
+
+void extract_simplified(const Coords* coords, const VertexLink* links, VertexIndex curr_idx,
+                        VertexIndex target_vertices, int closed, void* result_data) {
+    // Extract main vertices and add closure point for rings; plain x,y
+    // views get a loop with the column count fixed
+    if (coords->type == COORD_FLOAT32) {
+        if (coords->dims == 2)
+            EXTRACT_LOOP(float, 2);
+        else
+            EXTRACT_LOOP(float, coords->dims);
+    } else {
+        if (coords->dims == 2)
+            EXTRACT_LOOP(double, 2);
+        else
+            EXTRACT_LOOP(double, coords->dims);
+    }
+}
+
+void copy_ring(const Coords* coords, VertexIndex num_points, int closed, void* result_data) {
+    if (num_points == 0)
+        return;
+    if (coords->type == COORD_FLOAT32) {
+        if (coords->dims == 2)
+            COPY_LOOP(float, 2);
+        else
+            COPY_LOOP(float, coords->dims);
+    } else {
+        if (coords->dims == 2)
+            COPY_LOOP(double, 2);
+        else
+            COPY_LOOP(double, coords->dims);
+    }
 }
 
-void extract_simplified(const double* points_data, const int* next_vertex,
-                       const char* active, int curr_idx, int target_vertices,
-                       double* result_data) {
-    // Extract main vertices
-    for (int i = 0; i < target_vertices; i++) {
-        result_data[2 * i] = points_data[2 * curr_idx];
-        result_data[2 * i + 1] = points_data[2 * curr_idx + 1];
-        curr_idx = next_vertex[curr_idx];
+void gather_points(const Coords* coords, const VertexIndex* indices, VertexIndex count,
+                   int closed, void* result_data) {
+    if (count == 0)
+        return;
+    if (coords->type == COORD_FLOAT32) {
+        if (coords->dims == 2)
+            GATHER_LOOP(float, 2);
+        else
+            GATHER_LOOP(float, coords->dims);
+    } else {
+        if (coords->dims == 2)
+            GATHER_LOOP(double, 2);
+        else
+            GATHER_LOOP(double, coords->dims);
     }
+}
 
-    // Add closure point
-    result_data[2 * target_vertices] = result_data[0];
-    result_data[2 * target_vertices + 1] = result_data[1];
-}
\ No newline at end of file
+void extract_indices(const VertexLink* links, VertexIndex curr_idx,
+                     VertexIndex target_vertices, int closed, int64_t base, int64_t* result) {
+    for (VertexIndex i = 0; i < target_vertices; i++) {
+        result[i] = base + curr_idx;
+        curr_idx = links[curr_idx].next;
+    }
+    if (closed && target_vertices > 0)
+        result[target_vertices] = result[0];
+}
+
+void copy_ring_indices(VertexIndex num_points, int closed, int64_t base, int64_t* result) {
+    for (VertexIndex i = 0; i < num_points; i++)
+        result[i] = base + i;
+    if (closed && num_points > 0)
+        result[num_points] = base;
+}
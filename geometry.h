@@ -9,34 +9,414 @@
 #ifndef GEOMETRY_H
 #define GEOMETRY_H
 
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "vertex_index.h"
+
+/**
+ * @enum CoordType
+ * @brief Storage type of input coordinates
+ */
+typedef enum {
+    COORD_FLOAT64,
+    COORD_FLOAT32
+} CoordType;
+
+/**
+ * @struct Coords
+ * @brief Strided view of ring coordinates
+ *
+ * Describes where the x and y values of every vertex live without copying
+ * them, so column slices of wider arrays and float32 data can be used in
+ * place. Areas are always computed in double precision. Columns past y,
+ * such as z or m, are carried into results but only METRIC_AREA_3D reads
+ * one of them.
+ *
+ * @param data       Address of the x value of vertex 0
+ * @param stride     Bytes between consecutive vertices
+ * @param col_stride Bytes between consecutive columns of a vertex
+ * @param type       Storage type of the values
+ * @param dims       Number of columns, at least 2
+ */
+typedef struct {
+    const char* data;
+    ptrdiff_t stride;
+    ptrdiff_t col_stride;
+    CoordType type;
+    int dims;
+} Coords;
+
+/**
+ * @def COORD_VALUE
+ * @brief Read column col (0 for x, 1 for y, 2 for z) of vertex i as type COORD_T
+ */
+#define COORD_VALUE(coords, COORD_T, i, col) \
+    (*(const COORD_T*)((coords)->data + (ptrdiff_t)(i) * (coords)->stride + \
+                       (ptrdiff_t)(col) * (coords)->col_stride))
+
+/**
+ * @brief Size in bytes of one coordinate value
+ *
+ * @param type Storage type
+ * @return size_t sizeof(double) or sizeof(float)
+ */
+static inline size_t coord_size(CoordType type) {
+    return type == COORD_FLOAT32 ? sizeof(float) : sizeof(double);
+}
+
+/**
+ * @brief Read vertex i of a view as doubles
+ *
+ * @param coords Source view
+ * @param i      Vertex index
+ * @param point  Receives x and y
+ */
+static inline void coords_point(const Coords* coords, int64_t i, double point[2]) {
+    if (coords->type == COORD_FLOAT32) {
+        point[0] = COORD_VALUE(coords, float, i, 0);
+        point[1] = COORD_VALUE(coords, float, i, 1);
+    } else {
+        point[0] = COORD_VALUE(coords, double, i, 0);
+        point[1] = COORD_VALUE(coords, double, i, 1);
+    }
+}
+
+/**
+ * @brief View of contiguous interleaved float64 x,y pairs
+ *
+ * @param points_data Interleaved coordinates
+ * @return Coords View over points_data
+ */
+static inline Coords coords_interleaved(const double* points_data) {
+    Coords coords = {(const char*)points_data, 2 * sizeof(double), sizeof(double),
+                     COORD_FLOAT64, 2};
+    return coords;
+}
+
+/**
+ * @brief View starting at a later vertex of another view
+ *
+ * @param coords Source view
+ * @param first  Vertex that becomes vertex 0 of the new view
+ * @return Coords Shifted view
+ */
+static inline Coords coords_slice(const Coords* coords, int64_t first) {
+    Coords slice = *coords;
+    slice.data += (ptrdiff_t)first * coords->stride;
+    return slice;
+}
+
+/**
+ * @def CROSS_ERROR_BOUND
+ * @brief Relative error bound of the plain evaluation of triangle_cross
+ *
+ * The bound of Shewchuk's orientation filter: when the rounded cross
+ * product is within this fraction of the sum of its two terms, its sign
+ * and magnitude are decided by rounding and it is evaluated exactly.
+ */
+#define CROSS_ERROR_BOUND ((3.0 + 8.0 * DBL_EPSILON) * (DBL_EPSILON / 2.0))
+
+/**
+ * @brief Exact cross product of p2 - p1 and p3 - p1, as a double
+ *
+ * The slow path of triangle_cross for near-collinear points. Every
+ * difference and product is carried with its rounding error, so the
+ * result has the correct sign and is zero only for collinear points,
+ * whatever the magnitude of the coordinates.
+ *
+ * @param p1 Pointer to first point (x,y coordinates)
+ * @param p2 Pointer to second point
+ * @param p3 Pointer to third point
+ * @return double Cross product with its exact sign, within one ulp
+ */
+double exact_triangle_cross(const double* p1, const double* p2, const double* p3);
+
+/**
+ * @brief Twice the signed area of a triangle formed by three points
+ *
+ * Evaluated with plain arithmetic on the differences to p1, so the
+ * magnitude of the coordinates cancels out before any product is formed.
+ * Results too close to zero to be trusted fall back to
+ * exact_triangle_cross; the filter costs one comparison, and the output
+ * does not depend on the compiler or the target as long as it keeps IEEE
+ * semantics.
+ *
+ * @param p1 Pointer to first point (x,y coordinates)
+ * @param p2 Pointer to second point
+ * @param p3 Pointer to third point
+ * @return double Cross product, positive when the points turn counterclockwise
+ */
+static inline double triangle_cross(const double* p1, const double* p2, const double* p3) {
+    double left = (p2[0] - p1[0]) * (p3[1] - p1[1]);
+    double right = (p3[0] - p1[0]) * (p2[1] - p1[1]);
+    double cross = left - right;
+    double bound = CROSS_ERROR_BOUND * (fabs(left) + fabs(right));
+    if (fabs(cross) <= bound && bound != 0.0)
+        return exact_triangle_cross(p1, p2, p3);
+    return cross;
+}
+
+/**
+ * @brief Calculate the signed area of a triangle formed by three points
+ *
+ * Uses the shoelace formula; the area is positive when the points turn
+ * counterclockwise.
+ *
+ * @param p1 Pointer to first point (x,y coordinates)
+ * @param p2 Pointer to second point
+ * @param p3 Pointer to third point
+ * @return double Signed area of the triangle
+ */
+static inline double signed_triangle_area(const double* p1, const double* p2,
+                                          const double* p3) {
+    return triangle_cross(p1, p2, p3) / 2.0;
+}
+
 /**
  * @brief Calculate the area of a triangle formed by three points
  *
- * Uses the shoelace formula to calculate the signed area of a triangle.
- * The absolute value is returned.
+ * Defined here so the elimination kernels can inline it.
  *
  * @param p1 Pointer to first point (x,y coordinates)
  * @param p2 Pointer to second point
  * @param p3 Pointer to third point
  * @return double Absolute area of the triangle
  */
-double triangle_area(const double* p1, const double* p2, const double* p3);
+static inline double triangle_area(const double* p1, const double* p2, const double* p3) {
+    return fabs(signed_triangle_area(p1, p2, p3));
+}
+
+/**
+ * @brief Triangle areas of consecutive vertices of a view
+ *
+ * Writes the area of the triangle formed by vertices i - 1, i and i + 1 to
+ * areas[i - first] for every first <= i < last, which is what a freshly
+ * linked ring needs for all but its first and last vertex. Contiguous float64
+ * views are processed with AVX2 or NEON when the compiler targets them,
+ * unless NO_AREA_SIMD is defined; the results are identical to
+ * triangle_area.
+ *
+ * @param coords Source points view
+ * @param first  First vertex to compute, at least 1
+ * @param last   One past the last vertex to compute, at most the number of vertices - 1
+ * @param areas  Receives last - first areas, starting with vertex first
+ */
+void initial_triangle_areas(const Coords* coords, VertexIndex first, VertexIndex last,
+                            double* areas);
+
+/**
+ * @enum AreaMetric
+ * @brief Effective area used to rank vertices for removal
+ *
+ * METRIC_AREA is the plain triangle area. METRIC_FLATNESS is the weighted
+ * area of Zhou and Jones, scaled by 1 - FLATNESS_WEIGHT * cos(angle) at
+ * the vertex, so spikes go early and gentle bends stay. METRIC_CONVEXITY
+ * scales the area of concave vertices by CONCAVE_WEIGHT, so inlets are
+ * filled before headlands are cut. METRIC_SIGNED removes every concave
+ * vertex before any convex one, growing the ring towards its convex hull
+ * instead of eroding it. Concavity is judged against the orientation of
+ * the whole ring; an open line is oriented as if closed by its endpoints.
+ * METRIC_AREA_3D is the triangle area in x, y and z, for views of at
+ * least three columns.
+ */
+typedef enum {
+    METRIC_AREA,
+    METRIC_FLATNESS,
+    METRIC_CONVEXITY,
+    METRIC_SIGNED,
+    METRIC_AREA_3D,
+    NUM_METRICS
+} AreaMetric;
+
+/**
+ * @def FLATNESS_WEIGHT
+ * @brief Strength of the angle weighting of METRIC_FLATNESS, from 0 to 1
+ */
+#define FLATNESS_WEIGHT 0.7
+
+/**
+ * @def CONCAVE_WEIGHT
+ * @brief Factor applied to the area of concave vertices by METRIC_CONVEXITY
+ */
+#define CONCAVE_WEIGHT 0.5
+
+/**
+ * @brief METRIC_AREA of vertex p2; orientation is unused
+ */
+static inline double metric_area(const double* p1, const double* p2, const double* p3,
+                                 double orientation) {
+    (void)orientation;
+    return triangle_area(p1, p2, p3);
+}
+
+/**
+ * @brief METRIC_FLATNESS of vertex p2; orientation is unused
+ */
+static inline double metric_flatness(const double* p1, const double* p2, const double* p3,
+                                     double orientation) {
+    (void)orientation;
+    double area = triangle_area(p1, p2, p3);
+    double ux = p1[0] - p2[0], uy = p1[1] - p2[1];
+    double vx = p3[0] - p2[0], vy = p3[1] - p2[1];
+    double lengths = sqrt((ux * ux + uy * uy) * (vx * vx + vy * vy));
+    if (!(lengths > 0.0))
+        return area;
+    double cosine = (ux * vx + uy * vy) / lengths;
+    return area * (1.0 - FLATNESS_WEIGHT * cosine);
+}
+
+/**
+ * @brief METRIC_CONVEXITY of vertex p2 in a ring of the given orientation (+1 or -1)
+ */
+static inline double metric_convexity(const double* p1, const double* p2, const double* p3,
+                                      double orientation) {
+    double area = orientation * signed_triangle_area(p1, p2, p3);
+    return area >= 0.0 ? area : -area * CONCAVE_WEIGHT;
+}
+
+/**
+ * @brief METRIC_SIGNED of vertex p2 in a ring of the given orientation (+1 or -1)
+ *
+ * Concave vertices map to negative keys, smallest area first, so they all
+ * sort before the convex ones.
+ */
+static inline double metric_signed(const double* p1, const double* p2, const double* p3,
+                                   double orientation) {
+    double area = orientation * signed_triangle_area(p1, p2, p3);
+    return area >= 0.0 ? area : 1.0 / area;
+}
+
+/**
+ * @brief METRIC_AREA_3D of vertex p2, from points of x, y and z; orientation is unused
+ */
+static inline double metric_area_3d(const double* p1, const double* p2, const double* p3,
+                                    double orientation) {
+    (void)orientation;
+    double ux = p2[0] - p1[0], uy = p2[1] - p1[1], uz = p2[2] - p1[2];
+    double vx = p3[0] - p1[0], vy = p3[1] - p1[1], vz = p3[2] - p1[2];
+    double cx = uy * vz - uz * vy;
+    double cy = uz * vx - ux * vz;
+    double cz = ux * vy - uy * vx;
+    return sqrt(cx * cx + cy * cy + cz * cz) / 2.0;
+}
+
+/**
+ * @brief Read vertex i of a view as doubles, with z for METRIC_AREA_3D
+ *
+ * @param coords Source view
+ * @param metric Metric the point is read for
+ * @param i      Vertex index
+ * @param point  Receives x and y, and z if the metric uses it
+ */
+static inline void coords_metric_point(const Coords* coords, AreaMetric metric, int64_t i,
+                                       double point[3]) {
+    coords_point(coords, i, point);
+    if (metric == METRIC_AREA_3D)
+        point[2] = coords->type == COORD_FLOAT32 ? COORD_VALUE(coords, float, i, 2)
+                                                 : COORD_VALUE(coords, double, i, 2);
+}
+
+/**
+ * @struct VertexLink
+ * @brief Neighbours of a vertex in the working ring
+ *
+ * Both links of a vertex share one record, so unlinking a vertex touches
+ * one cache line per vertex instead of one per array. prev is -1 at the
+ * start and next is -1 at the end of an open line; a removed vertex has
+ * next set to VERTEX_REMOVED, which doubles as its active flag.
+ *
+ * @param prev Previous vertex index
+ * @param next Next vertex index
+ */
+typedef struct {
+    VertexIndex prev;
+    VertexIndex next;
+} VertexLink;
+
+/**
+ * @def VERTEX_REMOVED
+ * @brief Value of VertexLink.next once a vertex has been removed
+ */
+#define VERTEX_REMOVED (-2)
+
+/**
+ * @brief Whether a vertex is still present in the working ring
+ */
+static inline int vertex_active(const VertexLink* links, VertexIndex i) {
+    return links[i].next != VERTEX_REMOVED;
+}
 
 /**
  * @brief Extract simplified polygon vertices at a given resolution
  *
  * Extracts vertices from the working polygon structure into a result array,
- * ensuring proper closure of the polygon.
+ * ensuring proper closure of the polygon; open lines get no closure point.
+ * The result holds every column of each vertex, interleaved, in the same
+ * storage type as the source.
  *
- * @param points_data Source points array
- * @param next_vertex Array of next vertex indices
- * @param active     Array indicating which vertices are active
+ * @param coords     Source points view
+ * @param links      Links of the working ring
  * @param curr_idx   Starting vertex index
  * @param target_vertices Number of vertices to extract
+ * @param closed     Nonzero to append a closure point
  * @param result_data Destination array for results
  */
-void extract_simplified(const double* points_data, const int* next_vertex,
-                       const char* active, int curr_idx, int target_vertices,
-                       double* result_data);
+void extract_simplified(const Coords* coords, const VertexLink* links, VertexIndex curr_idx,
+                        VertexIndex target_vertices, int closed, void* result_data);
+
+/**
+ * @brief Copy a ring or line unchanged
+ *
+ * Used for rings and lines that already have no more vertices than the
+ * target. Rings get a closure point appended. The result holds every
+ * column of each vertex, interleaved, in the same storage type as the
+ * source.
+ *
+ * @param coords      Source ring (unclosed) or line view
+ * @param num_points  Number of vertices
+ * @param closed      Nonzero to append a closure point
+ * @param result_data Destination array for num_points + closed points
+ */
+void copy_ring(const Coords* coords, VertexIndex num_points, int closed, void* result_data);
+
+/**
+ * @brief Copy the listed vertices of a view, in the order given
+ *
+ * Like extract_simplified, for vertices selected by index instead of by
+ * walking the links, e.g. from a cached elimination order.
+ *
+ * @param coords      Source points view
+ * @param indices     Vertex indices to copy
+ * @param count       Number of indices
+ * @param closed      Nonzero to append a closure point
+ * @param result_data Destination array for count + closed points
+ */
+void gather_points(const Coords* coords, const VertexIndex* indices, VertexIndex count,
+                   int closed, void* result_data);
+
+/**
+ * @brief Extract the input positions of the vertices extract_simplified would write
+ *
+ * @param links           Links of the working ring
+ * @param curr_idx        Starting vertex index
+ * @param target_vertices Number of vertices to extract
+ * @param closed          Nonzero to repeat the first position at the end
+ * @param base            Position of vertex 0 in the caller's coordinates
+ * @param result          Receives target_vertices + closed positions
+ */
+void extract_indices(const VertexLink* links, VertexIndex curr_idx,
+                     VertexIndex target_vertices, int closed, int64_t base, int64_t* result);
+
+/**
+ * @brief Input positions of a ring or line copied unchanged by copy_ring
+ *
+ * @param num_points Number of vertices
+ * @param closed     Nonzero to repeat the first position at the end
+ * @param base       Position of vertex 0 in the caller's coordinates
+ * @param result     Receives num_points + closed positions
+ */
+void copy_ring_indices(VertexIndex num_points, int closed, int64_t base, int64_t* result);
 
-#endif /* GEOMETRY_H */
\ No newline at end of file
+#endif /* GEOMETRY_H */
@@ -0,0 +1,479 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "incremental.h"
+#include "simplify.h"
+
+/**
+ * @def INCREMENTAL_ATTEMPTS
+ * @brief Spans tried around an edit before the record is rebuilt
+ */
+#define INCREMENTAL_ATTEMPTS 4
+
+/**
+ * @brief Effective area of vertex between prev and next
+ */
+static double vertex_key(const IncrementalRing* ring, VertexIndex prev, VertexIndex vertex,
+                         VertexIndex next) {
+    const double* p1 = ring->points + 2 * prev;
+    const double* p2 = ring->points + 2 * vertex;
+    const double* p3 = ring->points + 2 * next;
+    switch (ring->metric) {
+    case METRIC_FLATNESS:
+        return metric_flatness(p1, p2, p3, ring->orientation);
+    case METRIC_CONVEXITY:
+        return metric_convexity(p1, p2, p3, ring->orientation);
+    case METRIC_SIGNED:
+        return metric_signed(p1, p2, p3, ring->orientation);
+    default:
+        return metric_area(p1, p2, p3, ring->orientation);
+    }
+}
+
+/**
+ * @brief Position offset vertices after vertex, wrapping around rings
+ *
+ * Open lines do not wrap, so the result may fall outside the line.
+ */
+static inline VertexIndex ring_position(const IncrementalRing* ring, VertexIndex vertex,
+                                        VertexIndex offset) {
+    VertexIndex position = vertex + offset;
+    if (ring->closed) {
+        if (position >= ring->num_points)
+            position -= ring->num_points;
+        else if (position < 0)
+            position += ring->num_points;
+    }
+    return position;
+}
+
+/**
+ * @brief Whether a vertex lies strictly between the ends of a span
+ */
+static inline int inside_span(const IncrementalRing* ring, VertexIndex start, VertexIndex length,
+                              VertexIndex vertex) {
+    VertexIndex offset = vertex - start;
+    if (ring->closed && offset < 0)
+        offset += ring->num_points;
+    return offset > 0 && offset < length - 1;
+}
+
+/**
+ * @brief Grow every buffer so the ring can hold capacity vertices
+ *
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+static int incremental_reserve(IncrementalRing* ring, VertexIndex capacity) {
+    if (capacity <= ring->capacity)
+        return 0;
+    if (capacity > MAX_RING_VERTICES)
+        return -1;
+
+    // Grow by at least half, so runs of insertions reallocate rarely
+    if (capacity - ring->capacity < ring->capacity / 2)
+        capacity = ring->capacity + ring->capacity / 2;
+    size_t count = (size_t)capacity;
+
+    double* points = realloc(ring->points, 2 * count * sizeof(double));
+    if (points)
+        ring->points = points;
+    double* keys = realloc(ring->keys, count * sizeof(double));
+    if (keys)
+        ring->keys = keys;
+    double* merged_keys = realloc(ring->merged_keys, count * sizeof(double));
+    if (merged_keys)
+        ring->merged_keys = merged_keys;
+    double* span_keys = realloc(ring->span_keys, count * sizeof(double));
+    if (span_keys)
+        ring->span_keys = span_keys;
+    VertexIndex* removed = realloc(ring->removed, count * sizeof(VertexIndex));
+    if (removed)
+        ring->removed = removed;
+    VertexIndex* merged_removed = realloc(ring->merged_removed, count * sizeof(VertexIndex));
+    if (merged_removed)
+        ring->merged_removed = merged_removed;
+    VertexIndex* span_removed = realloc(ring->span_removed, count * sizeof(VertexIndex));
+    if (span_removed)
+        ring->span_removed = span_removed;
+    VertexIndex* rank = realloc(ring->rank, count * sizeof(VertexIndex));
+    if (rank)
+        ring->rank = rank;
+    VertexLink* neighbours = realloc(ring->neighbours, count * sizeof(VertexLink));
+    if (neighbours)
+        ring->neighbours = neighbours;
+    VertexLink* merged_neighbours = realloc(ring->merged_neighbours, count * sizeof(VertexLink));
+    if (merged_neighbours)
+        ring->merged_neighbours = merged_neighbours;
+    VertexLink* span_neighbours = realloc(ring->span_neighbours, count * sizeof(VertexLink));
+    if (span_neighbours)
+        ring->span_neighbours = span_neighbours;
+    VertexLink* links = realloc(ring->links, count * sizeof(VertexLink));
+    if (links)
+        ring->links = links;
+
+    if (!points || !keys || !merged_keys || !span_keys || !removed || !merged_removed ||
+        !span_removed || !rank || !neighbours || !merged_neighbours || !span_neighbours ||
+        !links)
+        return -1;
+    if (!ring->heap)
+        ring->heap = indexed_heap_create(capacity);
+    if (!ring->heap || indexed_heap_reserve(ring->heap, capacity) != 0)
+        return -1;
+    ring->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Run the elimination over a span of the ring and record its removals
+ *
+ * A cyclic span is the whole ring; otherwise the span runs from start over
+ * length consecutive vertices and its two ends are never removed.
+ *
+ * @param ring       Ring whose working links and heap are used
+ * @param start      First vertex of the span
+ * @param length     Number of vertices in the span
+ * @param cyclic     Nonzero to eliminate the whole ring as a closed ring
+ * @param removed    Receives the removed vertices in order
+ * @param neighbours Receives the neighbours of every removed vertex
+ * @param keys       Receives the area of every removed vertex
+ * @return VertexIndex Number of removals
+ */
+static VertexIndex eliminate_span(IncrementalRing* ring, VertexIndex start, VertexIndex length,
+                                  int cyclic, VertexIndex* removed, VertexLink* neighbours,
+                                  double* keys) {
+    VertexLink* links = ring->links;
+    IndexedMinHeap* heap = ring->heap;
+
+    for (VertexIndex k = 0; k < length; k++) {
+        links[k].prev = k - 1;
+        links[k].next = k + 1;
+    }
+    if (cyclic) {
+        links[0].prev = length - 1;
+        links[length - 1].next = 0;
+    } else {
+        links[length - 1].next = -1;
+    }
+
+    // Span positions k map to ring positions start + k; pinned ends stay out of the heap
+    VertexIndex first = cyclic ? 0 : 1;
+    VertexIndex last = cyclic ? length : length - 1;
+    for (VertexIndex k = first; k < last; k++)
+        heap->areas[k - first] = vertex_key(ring, ring_position(ring, start, links[k].prev),
+                                            ring_position(ring, start, k),
+                                            ring_position(ring, start, links[k].next));
+    indexed_heap_build(heap, first, last > first ? last - first : 0);
+
+    VertexIndex remaining = length;
+    VertexIndex stop = cyclic ? min_vertices(1) : 2;
+    VertexIndex count = 0;
+    while (remaining > stop && heap->size > 0) {
+        HeapItem item = indexed_heap_pop(heap);
+        VertexLink link = links[item.index];
+        removed[count] = ring_position(ring, start, item.index);
+        neighbours[count].prev = ring_position(ring, start, link.prev);
+        neighbours[count].next = ring_position(ring, start, link.next);
+        keys[count] = item.area;
+        count++;
+
+        links[link.prev].next = link.next;
+        links[link.next].prev = link.prev;
+        remaining--;
+
+        for (int adj_idx = 0; adj_idx < 2; adj_idx++) {
+            VertexIndex k = adj_idx == 0 ? link.prev : link.next;
+            VertexLink adj = links[k];
+            if (adj.prev >= 0 && adj.next >= 0)
+                indexed_heap_update(heap, k, vertex_key(ring, ring_position(ring, start, adj.prev),
+                                                        ring_position(ring, start, k),
+                                                        ring_position(ring, start, adj.next)));
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Recompute the rank of every vertex from the record
+ */
+static void update_ranks(IncrementalRing* ring) {
+    for (VertexIndex v = 0; v < ring->num_points; v++)
+        ring->rank[v] = ring->num_removed;
+    for (VertexIndex r = 0; r < ring->num_removed; r++)
+        ring->rank[ring->removed[r]] = r;
+}
+
+/**
+ * @brief Orientation of the ring if the metric depends on it, +1 otherwise
+ */
+static double incremental_orientation(const IncrementalRing* ring) {
+    if (ring->metric != METRIC_CONVEXITY && ring->metric != METRIC_SIGNED)
+        return 1.0;
+    Coords coords = coords_interleaved(ring->points);
+    return ring_orientation(&coords, ring->num_points);
+}
+
+/**
+ * @brief Record the elimination of the whole ring from scratch
+ */
+static void rebuild(IncrementalRing* ring) {
+    ring->orientation = incremental_orientation(ring);
+    ring->num_removed = eliminate_span(ring, 0, ring->num_points, ring->closed, ring->removed,
+                                       ring->neighbours, ring->keys);
+    update_ranks(ring);
+    ring->last_span = ring->num_points;
+}
+
+/**
+ * @brief Move every vertex index of the record from a position on by delta
+ */
+static void shift_positions(IncrementalRing* ring, VertexIndex from, VertexIndex delta) {
+    for (VertexIndex r = 0; r < ring->num_removed; r++) {
+        if (ring->removed[r] >= from)
+            ring->removed[r] += delta;
+        if (ring->neighbours[r].prev >= from)
+            ring->neighbours[r].prev += delta;
+        if (ring->neighbours[r].next >= from)
+            ring->neighbours[r].next += delta;
+    }
+}
+
+/**
+ * @brief Re-eliminate the span between two anchors and merge it into the record
+ *
+ * While both anchors are present the span and the rest of the ring are
+ * eliminated independently, so the removals of the old record outside the
+ * span, up to the first removal of an anchor, still hold. Taking the
+ * removal of smaller area from either side at every step interleaves them
+ * as a single heap would. The merge stops once an anchor's own area drops
+ * below the next removal, as the anchor would then be removed first.
+ *
+ * @param ring    Ring with its record renumbered for the edit
+ * @param left    First anchor
+ * @param right   Second anchor, length - 1 vertices after left
+ * @param length  Number of vertices from left to right inclusive
+ * @param horizon Number of removals the new record must reach
+ * @return int 0 if the record was replaced, -1 if the anchors did not hold
+ */
+static int merge_span(IncrementalRing* ring, VertexIndex left, VertexIndex right,
+                      VertexIndex length, VertexIndex horizon) {
+    VertexIndex n = ring->num_points;
+    VertexIndex inner = eliminate_span(ring, left, length, 0, ring->span_removed,
+                                       ring->span_neighbours, ring->span_keys);
+    VertexIndex limit = ring->rank[left] < ring->rank[right] ? ring->rank[left] : ring->rank[right];
+    VertexIndex max_removed = n - min_vertices(ring->closed);
+
+    // The ends of an open line are never removed, so need no check
+    int check_left = ring->closed || left > 0;
+    int check_right = ring->closed || right < n - 1;
+    VertexIndex left_outer = ring_position(ring, left, -1);
+    VertexIndex left_inner = ring_position(ring, left, 1);
+    VertexIndex right_inner = ring_position(ring, right, -1);
+    VertexIndex right_outer = ring_position(ring, right, 1);
+    double left_area = check_left ? vertex_key(ring, left_outer, left, left_inner) : INFINITY;
+    double right_area = check_right ? vertex_key(ring, right_inner, right, right_outer) : INFINITY;
+
+    VertexIndex outer = 0, span = 0, count = 0;
+    while (count < max_removed) {
+        while (outer < limit && inside_span(ring, left, length, ring->removed[outer]))
+            outer++;
+
+        // Once the old removals run out, go on only if nothing is left outside
+        int outer_done = ring->closed ? left_outer == right :
+            (left == 0 || left_outer == 0) && (right == n - 1 || right_outer == n - 1);
+        int take_outer;
+        if (outer < limit && span < inner)
+            take_outer = ring->keys[outer] <= ring->span_keys[span];
+        else if (outer < limit)
+            take_outer = 1;
+        else if (span < inner && outer_done)
+            take_outer = 0;
+        else
+            break;
+
+        double key = take_outer ? ring->keys[outer] : ring->span_keys[span];
+        if (left_area < key || right_area < key)
+            break;
+        VertexLink link = take_outer ? ring->neighbours[outer] : ring->span_neighbours[span];
+        ring->merged_removed[count] = take_outer ? ring->removed[outer] : ring->span_removed[span];
+        ring->merged_neighbours[count] = link;
+        ring->merged_keys[count] = key;
+        count++;
+        if (take_outer)
+            outer++;
+        else
+            span++;
+
+        // Follow the neighbours of the anchors
+        if (check_left && (link.next == left || link.prev == left)) {
+            if (link.next == left)
+                left_outer = link.prev;
+            else
+                left_inner = link.next;
+            left_area = vertex_key(ring, left_outer, left, left_inner);
+        }
+        if (check_right && (link.prev == right || link.next == right)) {
+            if (link.prev == right)
+                right_outer = link.next;
+            else
+                right_inner = link.prev;
+            right_area = vertex_key(ring, right_inner, right, right_outer);
+        }
+    }
+    if (count < horizon)
+        return -1;
+
+    VertexIndex* removed = ring->removed;
+    ring->removed = ring->merged_removed;
+    ring->merged_removed = removed;
+    VertexLink* neighbours = ring->neighbours;
+    ring->neighbours = ring->merged_neighbours;
+    ring->merged_neighbours = neighbours;
+    double* keys = ring->keys;
+    ring->keys = ring->merged_keys;
+    ring->merged_keys = keys;
+    ring->num_removed = count;
+    update_ranks(ring);
+    ring->last_span = length;
+    return 0;
+}
+
+/**
+ * @brief Bring the record up to date after vertices lo to hi changed
+ *
+ * Positions lo to hi are the edited vertices in the new numbering; hi is
+ * lo - 1 after a deletion, leaving only the gap between lo - 1 and lo.
+ */
+static void resimplify(IncrementalRing* ring, VertexIndex lo, VertexIndex hi) {
+    VertexIndex n = ring->num_points;
+    VertexIndex horizon = n - ring->min_resolution;
+    if (ring->num_removed < horizon || incremental_orientation(ring) != ring->orientation) {
+        rebuild(ring);
+        return;
+    }
+
+    VertexIndex left = ring_position(ring, lo, -1);
+    VertexIndex right = ring_position(ring, hi, 1);
+    VertexIndex length = hi - lo + 3;
+    for (int attempt = 0; attempt < INCREMENTAL_ATTEMPTS; attempt++) {
+        // Widen the span to vertices kept at min_resolution on either side;
+        // past half the ring a rebuild is cheaper
+        while ((ring->closed || (left >= 0 && right < n)) && 2 * length <= n &&
+               (ring->rank[left] < horizon || ring->rank[right] < horizon)) {
+            if (ring->rank[left] < horizon)
+                left = ring_position(ring, left, -1);
+            else
+                right = ring_position(ring, right, 1);
+            length++;
+        }
+        if ((!ring->closed && (left < 0 || right >= n)) || 2 * length > n)
+            break;
+
+        if (merge_span(ring, left, right, length, horizon) == 0)
+            return;
+
+        // An anchor was due for removal; try again one vertex further out
+        left = ring_position(ring, left, -1);
+        right = ring_position(ring, right, 1);
+        length += 2;
+    }
+    rebuild(ring);
+}
+
+IncrementalRing* incremental_create(const Coords* coords, VertexIndex num_points, int closed,
+                                    AreaMetric metric, VertexIndex min_resolution) {
+    IncrementalRing* ring = (IncrementalRing*)calloc(1, sizeof(IncrementalRing));
+    if (!ring)
+        return NULL;
+    if (incremental_reserve(ring, num_points) != 0) {
+        incremental_destroy(ring);
+        return NULL;
+    }
+
+    for (VertexIndex i = 0; i < num_points; i++)
+        coords_point(coords, i, ring->points + 2 * i);
+    ring->num_points = num_points;
+    ring->closed = closed;
+    ring->metric = metric;
+    ring->min_resolution = min_resolution;
+    rebuild(ring);
+    return ring;
+}
+
+void incremental_destroy(IncrementalRing* ring) {
+    if (!ring)
+        return;
+    free(ring->points);
+    free(ring->removed);
+    free(ring->neighbours);
+    free(ring->keys);
+    free(ring->rank);
+    free(ring->merged_removed);
+    free(ring->merged_neighbours);
+    free(ring->merged_keys);
+    free(ring->span_removed);
+    free(ring->span_neighbours);
+    free(ring->span_keys);
+    free(ring->links);
+    if (ring->heap)
+        indexed_heap_destroy(ring->heap);
+    free(ring);
+}
+
+void incremental_move(IncrementalRing* ring, VertexIndex vertex, double x, double y) {
+    ring->points[2 * vertex] = x;
+    ring->points[2 * vertex + 1] = y;
+    resimplify(ring, vertex, vertex);
+}
+
+int incremental_insert(IncrementalRing* ring, VertexIndex position, double x, double y) {
+    if (incremental_reserve(ring, ring->num_points + 1) != 0)
+        return -1;
+
+    shift_positions(ring, position, 1);
+    memmove(ring->points + 2 * (position + 1), ring->points + 2 * position,
+            2 * (size_t)(ring->num_points - position) * sizeof(double));
+    ring->points[2 * position] = x;
+    ring->points[2 * position + 1] = y;
+    ring->num_points++;
+    update_ranks(ring);
+    resimplify(ring, position, position);
+    return 0;
+}
+
+void incremental_delete(IncrementalRing* ring, VertexIndex vertex) {
+    // Drop the removal of the vertex itself from the record
+    VertexIndex r = ring->rank[vertex];
+    if (r < ring->num_removed) {
+        size_t tail = (size_t)(ring->num_removed - r - 1);
+        memmove(ring->removed + r, ring->removed + r + 1, tail * sizeof(VertexIndex));
+        memmove(ring->neighbours + r, ring->neighbours + r + 1, tail * sizeof(VertexLink));
+        memmove(ring->keys + r, ring->keys + r + 1, tail * sizeof(double));
+        ring->num_removed--;
+    }
+
+    shift_positions(ring, vertex + 1, -1);
+    memmove(ring->points + 2 * vertex, ring->points + 2 * (vertex + 1),
+            2 * (size_t)(ring->num_points - vertex - 1) * sizeof(double));
+    ring->num_points--;
+    update_ranks(ring);
+    resimplify(ring, vertex, vertex - 1);
+}
+
+void incremental_extract(const IncrementalRing* ring, VertexIndex target, double* result_data) {
+    // Vertices removed among the first num_points - target ranks are dropped
+    VertexIndex cutoff = ring->num_points - target;
+    VertexIndex k = 0;
+    for (VertexIndex v = 0; v < ring->num_points; v++) {
+        if (ring->rank[v] >= cutoff) {
+            result_data[2 * k] = ring->points[2 * v];
+            result_data[2 * k + 1] = ring->points[2 * v + 1];
+            k++;
+        }
+    }
+
+    // Add closure point
+    if (ring->closed) {
+        result_data[2 * target] = result_data[0];
+        result_data[2 * target + 1] = result_data[1];
+    }
+}
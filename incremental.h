@@ -0,0 +1,141 @@
+/**
+ * @file incremental.h
+ * @brief Simplification state of one ring that follows local edits
+ *
+ * This header defines a ring that keeps its removal record between calls,
+ * so moving, inserting or deleting a vertex re-runs the elimination only
+ * over the span between the nearest vertices that survive the coarsest
+ * resolution on either side of the edit. Those two anchors split the ring
+ * into two independent eliminations while they are present, so the new
+ * record is the unchanged removals outside the span merged with the fresh
+ * removals inside it. When an anchor would have been removed earlier
+ * after the edit, the span is widened, and after a few attempts the record
+ * is rebuilt from scratch.
+ *
+ * Results match simplify_multi on the edited ring, up to the order in
+ * which vertices of exactly equal area are removed.
+ */
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "geometry.h"
+#include "min_heap.h"
+
+/**
+ * @struct IncrementalRing
+ * @brief Ring or open line with its removal record
+ *
+ * The record lists the removals of the elimination in order, each with
+ * the neighbours of the removed vertex and its area at that moment. It
+ * always covers at least the removals down to min_resolution vertices.
+ *
+ * @param points         Interleaved x,y pairs of the current vertices
+ * @param removed        Vertex removed at every rank of the record
+ * @param neighbours     Neighbours of the vertex removed at every rank
+ * @param keys           Area of the vertex removed at every rank
+ * @param rank           Rank of every vertex, num_removed if it is not removed
+ * @param merged_removed Buffer the next record's removals are merged into
+ * @param merged_neighbours Buffer the next record's neighbours are merged into
+ * @param merged_keys    Buffer the next record's areas are merged into
+ * @param span_removed   Removals of the span being eliminated
+ * @param span_neighbours Neighbours of the removals of the span
+ * @param span_keys      Areas of the removals of the span
+ * @param links          Working links of the span being eliminated
+ * @param heap           Working heap of the span being eliminated
+ * @param num_points     Number of vertices
+ * @param num_removed    Number of removals in the record
+ * @param capacity       Number of vertices every buffer can hold
+ * @param min_resolution Smallest resolution that can be extracted
+ * @param last_span      Vertices re-eliminated by the last edit, num_points
+ *                       after a rebuild
+ * @param closed         Nonzero for a ring, zero for an open line
+ * @param metric         Effective area used to rank vertices
+ * @param orientation    +1 for a counterclockwise ring, -1 for a clockwise one
+ */
+typedef struct {
+    double* points;
+    VertexIndex* removed;
+    VertexLink* neighbours;
+    double* keys;
+    VertexIndex* rank;
+    VertexIndex* merged_removed;
+    VertexLink* merged_neighbours;
+    double* merged_keys;
+    VertexIndex* span_removed;
+    VertexLink* span_neighbours;
+    double* span_keys;
+    VertexLink* links;
+    IndexedMinHeap* heap;
+    VertexIndex num_points;
+    VertexIndex num_removed;
+    VertexIndex capacity;
+    VertexIndex min_resolution;
+    VertexIndex last_span;
+    int closed;
+    AreaMetric metric;
+    double orientation;
+} IncrementalRing;
+
+/**
+ * @brief Copy a ring or open line and record its elimination
+ *
+ * @param coords         Ring (unclosed) or line coordinates
+ * @param num_points     Number of vertices (at least min_resolution)
+ * @param closed         Nonzero for a ring, zero for an open line
+ * @param metric         Effective area used to rank vertices
+ * @param min_resolution Smallest resolution to extract, at least min_vertices;
+ *                       the higher it is, the shorter the spans edits redo
+ * @return IncrementalRing* New ring or NULL if memory could not be allocated
+ */
+IncrementalRing* incremental_create(const Coords* coords, VertexIndex num_points, int closed,
+                                    AreaMetric metric, VertexIndex min_resolution);
+
+/**
+ * @brief Free all memory associated with the ring
+ *
+ * @param ring Ring to destroy (may be NULL)
+ */
+void incremental_destroy(IncrementalRing* ring);
+
+/**
+ * @brief Move a vertex
+ *
+ * @param ring   Target ring
+ * @param vertex Vertex to move, below num_points
+ * @param x      New x coordinate
+ * @param y      New y coordinate
+ */
+void incremental_move(IncrementalRing* ring, VertexIndex vertex, double x, double y);
+
+/**
+ * @brief Insert a vertex, shifting the vertices from position on by one
+ *
+ * @param ring     Target ring
+ * @param position Position of the new vertex, at most num_points
+ * @param x        x coordinate of the new vertex
+ * @param y        y coordinate of the new vertex
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int incremental_insert(IncrementalRing* ring, VertexIndex position, double x, double y);
+
+/**
+ * @brief Delete a vertex, shifting the vertices after it back by one
+ *
+ * @param ring   Target ring, with more than min_resolution vertices
+ * @param vertex Vertex to delete, below num_points
+ */
+void incremental_delete(IncrementalRing* ring, VertexIndex vertex);
+
+/**
+ * @brief Write the ring simplified to target vertices
+ *
+ * Vertices are written in ring order followed by a closure point for rings.
+ *
+ * @param ring        Source ring
+ * @param target      Number of vertices to keep, min_resolution to num_points
+ * @param result_data Destination array for target + closed points
+ */
+void incremental_extract(const IncrementalRing* ring, VertexIndex target, double* result_data);
+
+#endif /* INCREMENTAL_H */
@@ -1,5 +1,15 @@
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include "min_heap.h"
+#include "stats.h"
+
+#if defined(HEAP_SIMD) && defined(__AVX__)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 
 /**
  * @brief Swap two heap items
@@ -19,24 +29,27 @@ static void swap_heap_items(HeapItem* a, HeapItem* b) {
  * @param heap Target heap
  * @param idx  Index of the item to move down
  */
-static void heapify_down(MinHeap* heap, int idx) {
-    int smallest = idx;
-    int left = 2 * idx + 1;
-    int right = 2 * idx + 2;
+static void heapify_down(MinHeap* heap, VertexIndex idx) {
+    for (;;) {
+        VertexIndex smallest = idx;
+        VertexIndex left = 2 * idx + 1;
+        VertexIndex right = 2 * idx + 2;
+
+        if (left < heap->size && heap->items[left].area < heap->items[smallest].area)
+            smallest = left;
 
-    if (left < heap->size && heap->items[left].area < heap->items[smallest].area)
-        smallest = left;
+        if (right < heap->size && heap->items[right].area < heap->items[smallest].area)
+            smallest = right;
 
-    if (right < heap->size && heap->items[right].area < heap->items[smallest].area)
-        smallest = right;
+        if (smallest == idx)
+            break;
 
-    if (smallest != idx) {
         swap_heap_items(&heap->items[idx], &heap->items[smallest]);
-        heapify_down(heap, smallest);
+        idx = smallest;
     }
 }
 
-MinHeap* heap_create(int capacity) {
+MinHeap* heap_create(VertexIndex capacity) {
     MinHeap* heap = (MinHeap*)malloc(sizeof(MinHeap));
     heap->items = (HeapItem*)malloc(capacity * sizeof(HeapItem));
     heap->size = 0;
@@ -49,13 +62,23 @@ void heap_destroy(MinHeap* heap) {
     free(heap);
 }
 
-void heap_push(MinHeap* heap, double area, int index) {
+int heap_push(MinHeap* heap, double area, VertexIndex index) {
     if (heap->size == heap->capacity) {
-        heap->capacity *= 2;
-        heap->items = realloc(heap->items, heap->capacity * sizeof(HeapItem));
+        // Lazy pushes reach a few times the ring size, so guard the doubling
+        if (heap->capacity > VERTEX_INDEX_MAX / 2)
+            return -1;
+        VertexIndex capacity = heap->capacity > 0 ? 2 * heap->capacity : 16;
+        HeapItem* grown = realloc(heap->items, (size_t)capacity * sizeof(HeapItem));
+        if (!grown)
+            return -1;
+        heap->items = grown;
+        heap->capacity = capacity;
+        STATS_ADD(reallocs, 1);
     }
 
-    int i = heap->size++;
+    VertexIndex i = heap->size++;
+    STATS_ADD(heap_pushes, 1);
+    STATS_MAX(peak_heap_size, heap->size);
     heap->items[i].area = area;
     heap->items[i].index = index;
 
@@ -64,11 +87,247 @@ void heap_push(MinHeap* heap, double area, int index) {
         swap_heap_items(&heap->items[i], &heap->items[(i - 1) / 2]);
         i = (i - 1) / 2;
     }
+    return 0;
 }
 
 HeapItem heap_pop(MinHeap* heap) {
     HeapItem root = heap->items[0];
+    STATS_ADD(heap_pops, 1);
     heap->items[0] = heap->items[--heap->size];
     heapify_down(heap, 0);
     return root;
+}
+
+int heap_build(MinHeap* heap, const HeapItem* items, VertexIndex count) {
+    if (count > heap->capacity) {
+        HeapItem* grown = realloc(heap->items, (size_t)count * sizeof(HeapItem));
+        if (!grown)
+            return -1;
+        heap->items = grown;
+        heap->capacity = count;
+        STATS_ADD(reallocs, 1);
+    }
+
+    memcpy(heap->items, items, (size_t)count * sizeof(HeapItem));
+    heap->size = count;
+    STATS_ADD(heap_pushes, count);
+    STATS_MAX(peak_heap_size, count);
+
+    // Sift every parent down, deepest first
+    for (VertexIndex idx = count / 2 - 1; idx >= 0; idx--)
+        heapify_down(heap, idx);
+    return 0;
+}
+
+void heap_reset(MinHeap* heap) {
+    heap->size = 0;
+}
+
+/** Alignment of the first child of every node in the areas array */
+#define HEAP_ALIGNMENT 64
+
+/**
+ * @brief Position of the smallest of HEAP_ARITY consecutive areas
+ *
+ * @param areas Pointer to the first area, aligned to HEAP_ARITY doubles
+ * @return int Offset of the smallest area, the first one on ties
+ */
+static inline int min_child_block(const double* areas) {
+#if defined(HEAP_SIMD) && defined(__AVX__) && HEAP_ARITY >= 4
+    __m256d v = _mm256_load_pd(areas);
+#if HEAP_ARITY == 8
+    __m256d w = _mm256_load_pd(areas + 4);
+    __m256d m = _mm256_min_pd(v, w);
+#else
+    __m256d m = v;
+#endif
+    // Broadcast the minimum to every lane, then find the first lane holding it
+    m = _mm256_min_pd(m, _mm256_permute_pd(m, 0x5));
+    m = _mm256_min_pd(m, _mm256_permute2f128_pd(m, m, 0x01));
+    unsigned mask = (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(v, m, _CMP_EQ_OQ));
+#if HEAP_ARITY == 8
+    mask |= (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(w, m, _CMP_EQ_OQ)) << 4;
+#endif
+#ifdef _MSC_VER
+    unsigned long first;
+    _BitScanForward(&first, mask);
+    return (int)first;
+#else
+    return __builtin_ctz(mask);
+#endif
+#else
+    int best = 0;
+    for (int k = 1; k < HEAP_ARITY; k++) {
+        if (areas[k] < areas[best])
+            best = k;
+    }
+    return best;
+#endif
+}
+
+/**
+ * @brief Heap position of the smallest child of a node
+ *
+ * @param heap  Target heap
+ * @param first Heap position of the node's first child, below heap->size
+ * @return VertexIndex Heap position of the smallest child
+ */
+static inline VertexIndex min_child(const IndexedMinHeap* heap, VertexIndex first) {
+    if (first + HEAP_ARITY <= heap->size)
+        return first + min_child_block(&heap->areas[first]);
+
+    // Only the last parent can have an incomplete set of children
+    VertexIndex best = first;
+    for (VertexIndex c = first + 1; c < heap->size; c++) {
+        if (heap->areas[c] < heap->areas[best])
+            best = c;
+    }
+    return best;
+}
+
+/**
+ * @brief Move an item up the indexed heap until its parent is smaller
+ *
+ * @param heap  Target heap
+ * @param idx   Heap position to start from
+ * @param area  Area of the item being placed
+ * @param index Vertex index of the item being placed
+ */
+static void indexed_sift_up(IndexedMinHeap* heap, VertexIndex idx, double area,
+                            VertexIndex index) {
+    while (idx > 0) {
+        VertexIndex parent = (idx - 1) / HEAP_ARITY;
+        if (heap->areas[parent] <= area)
+            break;
+        heap->areas[idx] = heap->areas[parent];
+        heap->indices[idx] = heap->indices[parent];
+        heap->positions[heap->indices[idx]] = idx;
+        idx = parent;
+    }
+
+    heap->areas[idx] = area;
+    heap->indices[idx] = index;
+    heap->positions[index] = idx;
+}
+
+/**
+ * @brief Move an item down the indexed heap until its children are larger
+ *
+ * @param heap  Target heap
+ * @param idx   Heap position to start from
+ * @param area  Area of the item being placed
+ * @param index Vertex index of the item being placed
+ */
+static void indexed_sift_down(IndexedMinHeap* heap, VertexIndex idx, double area,
+                              VertexIndex index) {
+    for (;;) {
+        VertexIndex first = HEAP_ARITY * idx + 1;
+        if (first >= heap->size)
+            break;
+        VertexIndex smallest = min_child(heap, first);
+        if (heap->areas[smallest] >= area)
+            break;
+        heap->areas[idx] = heap->areas[smallest];
+        heap->indices[idx] = heap->indices[smallest];
+        heap->positions[heap->indices[idx]] = idx;
+        idx = smallest;
+    }
+
+    heap->areas[idx] = area;
+    heap->indices[idx] = index;
+    heap->positions[index] = idx;
+}
+
+IndexedMinHeap* indexed_heap_create(VertexIndex capacity) {
+    IndexedMinHeap* heap = (IndexedMinHeap*)calloc(1, sizeof(IndexedMinHeap));
+    if (!heap)
+        return NULL;
+    if (indexed_heap_reserve(heap, capacity > 0 ? capacity : 1) != 0) {
+        indexed_heap_destroy(heap);
+        return NULL;
+    }
+    return heap;
+}
+
+void indexed_heap_destroy(IndexedMinHeap* heap) {
+    free(heap->areas_base);
+    free(heap->indices);
+    free(heap->positions);
+    free(heap);
+}
+
+int indexed_heap_reserve(IndexedMinHeap* heap, VertexIndex capacity) {
+    if (capacity <= heap->capacity)
+        return 0;
+
+    // Shift the areas so that position 1, the first child of the root and
+    // of every child block after it, starts on an aligned boundary
+    void* areas_base = malloc(((size_t)capacity + HEAP_ARITY - 1) * sizeof(double) +
+                              HEAP_ALIGNMENT);
+    if (!areas_base)
+        return -1;
+    uintptr_t aligned = ((uintptr_t)areas_base + HEAP_ALIGNMENT - 1) &
+                        ~(uintptr_t)(HEAP_ALIGNMENT - 1);
+    double* areas = (double*)aligned + HEAP_ARITY - 1;
+
+    VertexIndex* indices = realloc(heap->indices, (size_t)capacity * sizeof(VertexIndex));
+    if (indices)
+        heap->indices = indices;
+    VertexIndex* positions = realloc(heap->positions, (size_t)capacity * sizeof(VertexIndex));
+    if (positions)
+        heap->positions = positions;
+
+    if (!indices || !positions) {
+        free(areas_base);
+        return -1;
+    }
+
+    if (heap->size > 0)
+        memcpy(areas, heap->areas, (size_t)heap->size * sizeof(double));
+    free(heap->areas_base);
+    heap->areas_base = areas_base;
+    heap->areas = areas;
+    heap->capacity = capacity;
+    STATS_ADD(reallocs, 1);
+    return 0;
+}
+
+void indexed_heap_push(IndexedMinHeap* heap, double area, VertexIndex index) {
+    indexed_sift_up(heap, heap->size++, area, index);
+    STATS_ADD(heap_pushes, 1);
+    STATS_MAX(peak_heap_size, heap->size);
+}
+
+void indexed_heap_build(IndexedMinHeap* heap, VertexIndex first, VertexIndex count) {
+    for (VertexIndex idx = 0; idx < count; idx++) {
+        heap->indices[idx] = first + idx;
+        heap->positions[first + idx] = idx;
+    }
+    heap->size = count;
+    STATS_ADD(heap_pushes, count);
+    STATS_MAX(peak_heap_size, count);
+
+    // Sift every parent down, deepest first
+    for (VertexIndex idx = (count - 2) / HEAP_ARITY; idx >= 0 && count > 1; idx--)
+        indexed_sift_down(heap, idx, heap->areas[idx], heap->indices[idx]);
+}
+
+HeapItem indexed_heap_pop(IndexedMinHeap* heap) {
+    HeapItem root = {heap->areas[0], heap->indices[0]};
+    heap->positions[root.index] = -1;
+    STATS_ADD(heap_pops, 1);
+
+    if (--heap->size > 0)
+        indexed_sift_down(heap, 0, heap->areas[heap->size], heap->indices[heap->size]);
+    return root;
+}
+
+void indexed_heap_update(IndexedMinHeap* heap, VertexIndex index, double new_area) {
+    VertexIndex idx = heap->positions[index];
+    STATS_ADD(heap_updates, 1);
+
+    if (new_area < heap->areas[idx])
+        indexed_sift_up(heap, idx, new_area, index);
+    else
+        indexed_sift_down(heap, idx, new_area, index);
 }
\ No newline at end of file
@@ -10,6 +10,8 @@
 #ifndef MIN_HEAP_H
 #define MIN_HEAP_H
 
+#include "vertex_index.h"
+
 /**
  * @struct HeapItem
  * @brief Represents a single item in the minimum heap
@@ -19,7 +21,7 @@
  */
 typedef struct {
     double area;
-    int index;
+    VertexIndex index;
 } HeapItem;
 
 /**
@@ -32,8 +34,8 @@ typedef struct {
  */
 typedef struct {
     HeapItem* items;
-    int size;
-    int capacity;
+    VertexIndex size;
+    VertexIndex capacity;
 } MinHeap;
 
 /**
@@ -42,7 +44,7 @@ typedef struct {
  * @param capacity Initial capacity of the heap
  * @return MinHeap* Pointer to the newly created heap
  */
-MinHeap* heap_create(int capacity);
+MinHeap* heap_create(VertexIndex capacity);
 
 /**
  * @brief Free all memory associated with the heap
@@ -57,8 +59,9 @@ void heap_destroy(MinHeap* heap);
  * @param heap  Target heap
  * @param area  Area value for the new item
  * @param index Vertex index for the new item
+ * @return int 0 on success, -1 if the heap could not be grown
  */
-void heap_push(MinHeap* heap, double area, int index);
+int heap_push(MinHeap* heap, double area, VertexIndex index);
 
 /**
  * @brief Remove and return the minimum item from the heap
@@ -68,4 +71,140 @@ void heap_push(MinHeap* heap, double area, int index);
  */
 HeapItem heap_pop(MinHeap* heap);
 
+/**
+ * @brief Replace the heap contents with a set of items in O(count)
+ *
+ * Copies the items and restores the heap property bottom-up with Floyd's
+ * method instead of pushing them one by one. The items buffer is grown
+ * only if it is too small.
+ *
+ * @param heap  Target heap
+ * @param items Items to load, in any order
+ * @param count Number of items
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int heap_build(MinHeap* heap, const HeapItem* items, VertexIndex count);
+
+/**
+ * @brief Empty the heap while keeping its items buffer
+ *
+ * Lets one heap serve many rings without heap_destroy and heap_create
+ * between them.
+ *
+ * @param heap Target heap
+ */
+void heap_reset(MinHeap* heap);
+
+/**
+ * @def HEAP_ARITY
+ * @brief Number of children of every node of the indexed heap
+ *
+ * May be set to 2, 4 or 8 at compile time. Wider heaps are shallower, and
+ * since the areas are stored with the children of every node aligned to a
+ * single cache line, finding the smallest child costs one cache miss.
+ * Defining HEAP_SIMD additionally selects the smallest child with AVX
+ * instructions when the compiler targets them.
+ */
+#ifndef HEAP_ARITY
+#define HEAP_ARITY 4
+#endif
+
+#if HEAP_ARITY != 2 && HEAP_ARITY != 4 && HEAP_ARITY != 8
+#error "HEAP_ARITY must be 2, 4 or 8"
+#endif
+
+/**
+ * @struct IndexedMinHeap
+ * @brief Minimum heap addressable by vertex index
+ *
+ * Holds at most one entry per vertex and records where each vertex sits
+ * in the heap, so a changed area can be updated in place instead of
+ * pushing a second entry and discarding the stale one later. Areas and
+ * vertex indices are kept in separate arrays so the comparisons during a
+ * sift only touch the areas.
+ *
+ * @param areas      Area of the item at every heap position
+ * @param indices    Vertex index of the item at every heap position
+ * @param positions  Heap position of every vertex, -1 if not in the heap
+ * @param areas_base Allocation backing the aligned areas array
+ * @param size       Current number of items in the heap
+ * @param capacity   Number of vertex indices the heap can hold
+ */
+typedef struct {
+    double* areas;
+    VertexIndex* indices;
+    VertexIndex* positions;
+    void* areas_base;
+    VertexIndex size;
+    VertexIndex capacity;
+} IndexedMinHeap;
+
+/**
+ * @brief Initialize a new indexed minimum heap
+ *
+ * @param capacity Number of vertex indices the heap must hold
+ * @return IndexedMinHeap* Pointer to the newly created heap or NULL on failure
+ */
+IndexedMinHeap* indexed_heap_create(VertexIndex capacity);
+
+/**
+ * @brief Free all memory associated with the indexed heap
+ *
+ * @param heap Pointer to the heap to destroy
+ */
+void indexed_heap_destroy(IndexedMinHeap* heap);
+
+/**
+ * @brief Grow the heap so it can hold vertex indices below capacity
+ *
+ * @param heap     Target heap
+ * @param capacity Required number of vertex indices
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int indexed_heap_reserve(IndexedMinHeap* heap, VertexIndex capacity);
+
+/**
+ * @brief Push a vertex that is not yet in the heap
+ *
+ * @param heap  Target heap
+ * @param area  Area value for the new item
+ * @param index Vertex index, below the heap capacity
+ */
+void indexed_heap_push(IndexedMinHeap* heap, double area, VertexIndex index);
+
+/**
+ * @brief Replace the heap contents with a run of consecutive vertices
+ *
+ * Loads vertices first to first + count - 1, whose areas the caller has
+ * already written to heap->areas[0] to heap->areas[count - 1], and
+ * restores the heap property bottom-up with Floyd's method, which takes
+ * O(count) instead of the O(count log count) of pushing them one by one.
+ * Writing the areas in place spares the caller a separate per-vertex
+ * area array.
+ *
+ * @param heap  Target heap, able to hold vertex indices below first + count
+ * @param first First vertex to load
+ * @param count Number of vertices to load
+ */
+void indexed_heap_build(IndexedMinHeap* heap, VertexIndex first, VertexIndex count);
+
+/**
+ * @brief Remove and return the minimum item from the indexed heap
+ *
+ * @param heap Target heap
+ * @return HeapItem The item with the smallest area
+ */
+HeapItem indexed_heap_pop(IndexedMinHeap* heap);
+
+/**
+ * @brief Change the area of a vertex already in the heap
+ *
+ * Moves the entry up or down to restore the heap property.
+ *
+ * @param heap     Target heap
+ * @param index    Vertex index to update
+ * @param new_area New area value for the vertex
+ */
+void indexed_heap_update(IndexedMinHeap* heap, VertexIndex index, double new_area);
+
 #endif /* MIN_HEAP_H */
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include <stdlib.h>
+#include "parallel.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/**
+ * @struct ThreadStart
+ * @brief Arguments handed to a worker thread
+ */
+typedef struct {
+    ParallelTask task;
+    void* ctx;
+    int thread_id;
+} ThreadStart;
+
+#ifdef _WIN32
+
+void mutex_init(Mutex* mutex) { InitializeCriticalSection(mutex); }
+void mutex_destroy(Mutex* mutex) { DeleteCriticalSection(mutex); }
+void mutex_lock(Mutex* mutex) { EnterCriticalSection(mutex); }
+void mutex_unlock(Mutex* mutex) { LeaveCriticalSection(mutex); }
+
+int cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+static DWORD WINAPI thread_main(LPVOID arg) {
+    ThreadStart* start = (ThreadStart*)arg;
+    start->task(start->ctx, start->thread_id);
+    return 0;
+}
+
+typedef HANDLE Thread;
+
+static int thread_start(Thread* thread, ThreadStart* start) {
+    *thread = CreateThread(NULL, 0, thread_main, start, 0, NULL);
+    return *thread ? 0 : -1;
+}
+
+static void thread_join(Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+#else
+
+void mutex_init(Mutex* mutex) { pthread_mutex_init(mutex, NULL); }
+void mutex_destroy(Mutex* mutex) { pthread_mutex_destroy(mutex); }
+void mutex_lock(Mutex* mutex) { pthread_mutex_lock(mutex); }
+void mutex_unlock(Mutex* mutex) { pthread_mutex_unlock(mutex); }
+
+int cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+static void* thread_main(void* arg) {
+    ThreadStart* start = (ThreadStart*)arg;
+    start->task(start->ctx, start->thread_id);
+    return NULL;
+}
+
+typedef pthread_t Thread;
+
+static int thread_start(Thread* thread, ThreadStart* start) {
+    return pthread_create(thread, NULL, thread_main, start) == 0 ? 0 : -1;
+}
+
+static void thread_join(Thread thread) {
+    pthread_join(thread, NULL);
+}
+
+#endif
+
+int parallel_run(int num_threads, ParallelTask task, void* ctx) {
+    if (num_threads <= 1) {
+        task(ctx, 0);
+        return 1;
+    }
+
+    Thread* threads = malloc((num_threads - 1) * sizeof(Thread));
+    ThreadStart* starts = malloc((num_threads - 1) * sizeof(ThreadStart));
+    int started = 0;
+
+    if (threads && starts) {
+        for (int i = 0; i < num_threads - 1; i++) {
+            starts[started].task = task;
+            starts[started].ctx = ctx;
+            starts[started].thread_id = started + 1;
+            if (thread_start(&threads[started], &starts[started]) != 0)
+                break;
+            started++;
+        }
+    }
+
+    // The calling thread takes part as thread 0
+    task(ctx, 0);
+
+    for (int i = 0; i < started; i++)
+        thread_join(threads[i]);
+
+    free(threads);
+    free(starts);
+    return started + 1;
+}
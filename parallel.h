@@ -0,0 +1,55 @@
+/**
+ * @file parallel.h
+ * @brief Minimal portable threading helpers
+ *
+ * This header wraps the few threading primitives the simplifier needs
+ * (a mutex, a CPU count and a fork/join helper) over pthreads and the
+ * Windows API.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#ifdef _WIN32
+#include <windows.h>
+typedef CRITICAL_SECTION Mutex;
+#else
+#include <pthread.h>
+typedef pthread_mutex_t Mutex;
+#endif
+
+/**
+ * @brief Function run by every thread of parallel_run
+ *
+ * @param ctx       Shared context passed to parallel_run
+ * @param thread_id Index of the calling thread, 0 for the calling thread
+ */
+typedef void (*ParallelTask)(void* ctx, int thread_id);
+
+void mutex_init(Mutex* mutex);
+void mutex_destroy(Mutex* mutex);
+void mutex_lock(Mutex* mutex);
+void mutex_unlock(Mutex* mutex);
+
+/**
+ * @brief Number of processors available to the process
+ *
+ * @return int Online processor count, at least 1
+ */
+int cpu_count(void);
+
+/**
+ * @brief Run a task on several threads and wait for all of them
+ *
+ * The calling thread runs the task as thread 0. If some worker threads
+ * cannot be started the task simply runs on fewer threads, so callers
+ * must not rely on every thread id being used.
+ *
+ * @param num_threads Requested number of threads
+ * @param task        Function to run on every thread
+ * @param ctx         Context passed to every invocation
+ * @return int Number of threads that actually ran the task
+ */
+int parallel_run(int num_threads, ParallelTask task, void* ctx);
+
+#endif /* PARALLEL_H */
@@ -0,0 +1,106 @@
+#include "pycache.h"
+
+/**
+ * @struct VWCacheObject
+ * @brief Python object owning this process's handle on an order cache
+ */
+typedef struct {
+    PyObject_HEAD
+    OrderCache* cache;
+    int shared;
+} VWCacheObject;
+
+static void VWCache_dealloc(VWCacheObject* self) {
+    order_cache_destroy(self->cache);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* VWCache_clear(VWCacheObject* self, PyObject* unused) {
+    order_cache_clear(self->cache);
+    Py_RETURN_NONE;
+}
+
+static PyObject* VWCache_get_stats(VWCacheObject* self, void* closure) {
+    OrderCacheStats stats;
+    order_cache_stats(self->cache, &stats);
+    return Py_BuildValue("{s:L,s:L,s:L,s:L,s:L,s:L}",
+                         "hits", (long long)stats.hits,
+                         "misses", (long long)stats.misses,
+                         "evictions", (long long)stats.evictions,
+                         "entries", (long long)stats.entries,
+                         "used", (long long)stats.used,
+                         "capacity", (long long)stats.capacity);
+}
+
+static PyObject* VWCache_get_shared(VWCacheObject* self, void* closure) {
+    return PyBool_FromLong(self->shared);
+}
+
+static PyMethodDef VWCache_methods[] = {
+    {"clear", (PyCFunction)VWCache_clear, METH_NOARGS,
+     "Drop every cached order and reset the counters"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef VWCache_getset[] = {
+    {"stats", (getter)VWCache_get_stats, NULL,
+     "Dict of hits, misses, evictions, entries, used and capacity bytes", NULL},
+    {"shared", (getter)VWCache_get_shared, NULL,
+     "True if the cache is shared with processes forked after its creation", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+PyTypeObject VWCacheType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "visvalingam_c.VWCache",
+    .tp_basicsize = sizeof(VWCacheObject),
+    .tp_dealloc = (destructor)VWCache_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Bounded LRU cache of elimination orders keyed by ring content",
+    .tp_methods = VWCache_methods,
+    .tp_getset = VWCache_getset,
+};
+
+PyObject* create_cache_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"max_bytes", "shared", NULL};
+    Py_ssize_t max_bytes = 64 << 20;
+    int shared = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|np", kwlist, &max_bytes, &shared))
+        return NULL;
+#ifdef _WIN32
+    if (shared) {
+        PyErr_SetString(PyExc_NotImplementedError, "Shared caches need fork and POSIX");
+        return NULL;
+    }
+#endif
+    if (max_bytes < 4 * CACHE_BLOCK_SIZE) {
+        PyErr_Format(PyExc_ValueError, "Cache size must be at least %d bytes, is: %zd",
+                     4 * CACHE_BLOCK_SIZE, max_bytes);
+        return NULL;
+    }
+
+    VWCacheObject* cache_obj = PyObject_New(VWCacheObject, &VWCacheType);
+    if (!cache_obj)
+        return NULL;
+    cache_obj->shared = shared;
+    cache_obj->cache = order_cache_create((size_t)max_bytes, shared);
+    if (!cache_obj->cache) {
+        Py_DECREF(cache_obj);
+        return PyErr_NoMemory();
+    }
+    return (PyObject*)cache_obj;
+}
+
+int cache_from_object(PyObject* obj, OrderCache** cache) {
+    if (obj == Py_None) {
+        *cache = NULL;
+        return 0;
+    }
+    if (!PyObject_TypeCheck(obj, &VWCacheType)) {
+        PyErr_SetString(PyExc_TypeError, "cache must be a VWCache from create_cache, or None");
+        return -1;
+    }
+    *cache = ((VWCacheObject*)obj)->cache;
+    return 0;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file pycache.h
+ * @brief Python VWCache type wrapping a bounded elimination order cache
+ *
+ * A VWCache is returned by create_cache and passed to simplify_multi and
+ * build_index through their cache keyword, so rings seen before skip the
+ * elimination and are served from their cached order.
+ */
+
+#ifndef PYCACHE_H
+#define PYCACHE_H
+
+#include <Python.h>
+#include "cache.h"
+
+/** The VWCache Python type, readied by the module init function */
+extern PyTypeObject VWCacheType;
+
+/**
+ * @brief Python-callable function creating a VWCache
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple optionally containing the size of the cache in bytes
+ * @param kwargs Optional keyword arguments (max_bytes, shared)
+ * @return PyObject* New VWCache object
+ */
+PyObject* create_cache_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+/**
+ * @brief Read the cache keyword of an entry point
+ *
+ * @param obj   VWCache object or None
+ * @param cache Receives the cache, or NULL for None
+ * @return int 0 on success, -1 with a TypeError set for any other object
+ */
+int cache_from_object(PyObject* obj, OrderCache** cache);
+
+#endif /* PYCACHE_H */
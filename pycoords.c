@@ -0,0 +1,185 @@
+// The numpy C API is imported once, by the module init in visvalingam.c
+#define NO_IMPORT_ARRAY
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include "pycoords.h"
+
+/**
+ * @brief Describe an (n, 2), or with any_dims an (n, D >= 2), array as a Coords view
+ */
+static PyArrayObject* view_from_object(PyObject* obj, const char* name, int any_dims,
+                                       Coords* coords) {
+    PyArrayObject* array = NULL;
+
+    if (PyArray_Check(obj)) {
+        PyArrayObject* input = (PyArrayObject*)obj;
+        int type = PyArray_TYPE(input);
+        if ((type == NPY_DOUBLE || type == NPY_FLOAT) &&
+            PyArray_ISALIGNED(input) && PyArray_ISNOTSWAPPED(input)) {
+            Py_INCREF(input);
+            array = input;
+        }
+    }
+
+    // Buffer-protocol objects such as memoryview, array.array or mmap are
+    // viewed with their own format first, so float32 buffers stay float32
+    int from_buffer = !PyArray_Check(obj) && PyObject_CheckBuffer(obj);
+    PyObject* source = obj;
+    if (from_buffer) {
+        PyArrayObject* view = (PyArrayObject*)PyArray_FromAny(obj, NULL, 0, 0, 0, NULL);
+        if (!view)
+            return NULL;
+        int type = PyArray_TYPE(view);
+        if ((type == NPY_DOUBLE || type == NPY_FLOAT) &&
+            PyArray_ISALIGNED(view) && PyArray_ISNOTSWAPPED(view)) {
+            array = view;
+        } else {
+            source = (PyObject*)view;
+        }
+    }
+
+    if (!array) {
+        array = (PyArrayObject*)PyArray_FROMANY(source, NPY_DOUBLE, 0, 0, NPY_ARRAY_IN_ARRAY);
+        if (source != obj)
+            Py_DECREF(source);
+        if (!array)
+            return NULL;
+    }
+
+    // A flat buffer of 2n values holds n interleaved points
+    if (from_buffer && PyArray_NDIM(array) == 1 && PyArray_DIM(array, 0) % 2 == 0) {
+        npy_intp dims[2] = {PyArray_DIM(array, 0) / 2, 2};
+        PyArray_Dims shape = {dims, 2};
+        PyArrayObject* points = (PyArrayObject*)PyArray_Newshape(array, &shape, NPY_CORDER);
+        Py_DECREF(array);
+        if (!points)
+            return NULL;
+        array = points;
+    }
+
+    // Validate input dimensions
+    if (PyArray_NDIM(array) != 2 || PyArray_DIM(array, 1) < 2 ||
+        (!any_dims && PyArray_DIM(array, 1) != 2)) {
+        PyErr_Format(PyExc_ValueError, any_dims ? "%s array must be of shape (n, D) with D >= 2"
+                                                : "%s array must be of shape (n, 2)", name);
+        Py_DECREF(array);
+        return NULL;
+    }
+    if (PyArray_DIM(array, 1) > INT_MAX) {
+        PyErr_Format(PyExc_ValueError, "%s array has too many columns", name);
+        Py_DECREF(array);
+        return NULL;
+    }
+
+    coords->data = (const char*)PyArray_BYTES(array);
+    coords->stride = PyArray_STRIDE(array, 0);
+    coords->col_stride = PyArray_STRIDE(array, 1);
+    coords->type = PyArray_TYPE(array) == NPY_FLOAT ? COORD_FLOAT32 : COORD_FLOAT64;
+    coords->dims = (int)PyArray_DIM(array, 1);
+    return array;
+}
+
+PyArrayObject* coords_from_object(PyObject* obj, const char* name, Coords* coords) {
+    return view_from_object(obj, name, 0, coords);
+}
+
+PyArrayObject* points_from_object(PyObject* obj, const char* name, Coords* coords) {
+    return view_from_object(obj, name, 1, coords);
+}
+
+int* int_values_from_object(PyObject* obj, const char* name, int* count) {
+    PyArrayObject* array = NULL;
+
+    if (PyArray_Check(obj)) {
+        PyArrayObject* input = (PyArrayObject*)obj;
+        int itemsize = PyArray_ITEMSIZE(input);
+        if (PyArray_ISINTEGER(input) && PyArray_ISSIGNED(input) &&
+            (itemsize == 4 || itemsize == 8) &&
+            PyArray_ISALIGNED(input) && PyArray_ISNOTSWAPPED(input)) {
+            Py_INCREF(input);
+            array = input;
+        }
+    }
+
+    if (!array) {
+        array = (PyArrayObject*)PyArray_FROMANY(obj, NPY_INT64, 0, 0, NPY_ARRAY_IN_ARRAY);
+        if (!array)
+            return NULL;
+    }
+
+    if (PyArray_NDIM(array) != 1) {
+        PyErr_Format(PyExc_ValueError, "%s must be 1-dimensional array", name);
+        Py_DECREF(array);
+        return NULL;
+    }
+
+    npy_intp num_values = PyArray_DIM(array, 0);
+    if (num_values > INT_MAX) {
+        PyErr_Format(PyExc_ValueError, "%s has too many entries", name);
+        Py_DECREF(array);
+        return NULL;
+    }
+
+    int* values = malloc((num_values > 0 ? num_values : 1) * sizeof(int));
+    if (!values) {
+        Py_DECREF(array);
+        return (int*)PyErr_NoMemory();
+    }
+
+    const char* data = (const char*)PyArray_BYTES(array);
+    npy_intp stride = PyArray_STRIDE(array, 0);
+    int wide = PyArray_ITEMSIZE(array) == 8;
+
+    for (npy_intp i = 0; i < num_values; i++) {
+        int64_t value = wide ? *(const int64_t*)(data + i * stride)
+                             : *(const int32_t*)(data + i * stride);
+        if (value < INT_MIN || value > INT_MAX) {
+            PyErr_Format(PyExc_ValueError, "%s value out of range: %lld",
+                         name, (long long)value);
+            free(values);
+            Py_DECREF(array);
+            return NULL;
+        }
+        values[i] = (int)value;
+    }
+
+    Py_DECREF(array);
+    *count = (int)num_values;
+    return values;
+}
+
+int check_ring_size(npy_intp num_points) {
+    if (num_points <= MAX_RING_VERTICES)
+        return 0;
+    PyErr_Format(PyExc_ValueError,
+                 "Ring has %lld vertices, more than the %lld this build supports; "
+                 "rebuild with VERTEX_INDEX_64 for larger rings",
+                 (long long)num_points, (long long)MAX_RING_VERTICES);
+    return -1;
+}
+
+int metric_from_name(const char* name, AreaMetric* metric) {
+    static const char* const names[NUM_METRICS] = {"area", "flatness", "convexity", "signed",
+                                                   "area3d"};
+    for (int m = 0; m < NUM_METRICS; m++) {
+        if (strcmp(name, names[m]) == 0) {
+            *metric = (AreaMetric)m;
+            return 0;
+        }
+    }
+    PyErr_Format(PyExc_ValueError,
+                 "Unknown metric '%s', expected 'area', 'flatness', 'convexity', "
+                 "'signed' or 'area3d'",
+                 name);
+    return -1;
+}
+
+int check_metric_dims(AreaMetric metric, const Coords* coords) {
+    if (metric == METRIC_AREA_3D && coords->dims < 3) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Metric 'area3d' needs coordinates of shape (n, D) with D >= 3");
+        return -1;
+    }
+    return 0;
+}
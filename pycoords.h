@@ -0,0 +1,110 @@
+/**
+ * @file pycoords.h
+ * @brief Conversion of NumPy arguments into engine views
+ *
+ * This header defines the helpers the Python bindings use to describe
+ * coordinate arrays as Coords views without copying them, to read
+ * integer argument arrays of any integer type, to check ring sizes
+ * against the vertex index type, and to parse metric names.
+ */
+
+#ifndef PYCOORDS_H
+#define PYCOORDS_H
+
+#include <Python.h>
+#include <numpy/arrayobject.h>
+#include "geometry.h"
+
+/**
+ * @brief NumPy type number matching a coordinate storage type
+ *
+ * @param type Storage type
+ * @return int NPY_FLOAT or NPY_DOUBLE
+ */
+static inline int coord_npy_type(CoordType type) {
+    return type == COORD_FLOAT32 ? NPY_FLOAT : NPY_DOUBLE;
+}
+
+/**
+ * @def NPY_VERTEX_INDEX
+ * @brief NumPy type number matching VertexIndex
+ */
+#ifdef VERTEX_INDEX_64
+#define NPY_VERTEX_INDEX NPY_INT64
+#else
+#define NPY_VERTEX_INDEX NPY_INT32
+#endif
+
+/**
+ * @brief Describe an (n, 2) coordinate array as a Coords view
+ *
+ * Aligned, native byte order float64 and float32 arrays are used in place
+ * whatever their strides, so column slices of wider arrays are not copied.
+ * Other buffer-protocol objects are read the same way, and a flat buffer
+ * of 2n values is taken as n interleaved points. Anything else is
+ * converted to a contiguous float64 array once.
+ *
+ * @param obj    Coordinate argument
+ * @param name   Argument name used in error messages
+ * @param coords Receives the view
+ * @return PyArrayObject* New reference to the array backing the view, or
+ *         NULL with an exception set
+ */
+PyArrayObject* coords_from_object(PyObject* obj, const char* name, Coords* coords);
+
+/**
+ * @brief Describe an (n, D) point array with D >= 2 as a Coords view
+ *
+ * Read like coords_from_object. Areas use the x and y columns, and every
+ * column is carried into the results of functions that extract from it.
+ *
+ * @param obj    Point argument
+ * @param name   Argument name used in error messages
+ * @param coords Receives the view, with dims set to D
+ * @return PyArrayObject* New reference to the array backing the view, or
+ *         NULL with an exception set
+ */
+PyArrayObject* points_from_object(PyObject* obj, const char* name, Coords* coords);
+
+/**
+ * @brief Read a 1D integer argument into a new int array
+ *
+ * 32 and 64-bit integer arrays are read directly, whatever their strides;
+ * other inputs are converted with NumPy's safe casting rules.
+ *
+ * @param obj   Integer array argument
+ * @param name  Argument name used in error messages
+ * @param count Receives the number of values
+ * @return int* Newly allocated values or NULL with an exception set
+ */
+int* int_values_from_object(PyObject* obj, const char* name, int* count);
+
+/**
+ * @brief Check that a ring or line fits the vertex index type of the build
+ *
+ * @param num_points Number of points of the ring or line
+ * @return int 0 if it fits, -1 with a ValueError set otherwise
+ */
+int check_ring_size(npy_intp num_points);
+
+/**
+ * @brief Parse the name of an effective area metric
+ *
+ * Accepts "area", "flatness", "convexity", "signed" and "area3d".
+ *
+ * @param name   Metric name
+ * @param metric Receives the metric
+ * @return int 0 on success, -1 with a ValueError set for unknown names
+ */
+int metric_from_name(const char* name, AreaMetric* metric);
+
+/**
+ * @brief Check that a view has the columns a metric reads
+ *
+ * @param metric Effective area metric
+ * @param coords Coordinate view
+ * @return int 0 if usable, -1 with a ValueError set if METRIC_AREA_3D has no z
+ */
+int check_metric_dims(AreaMetric metric, const Coords* coords);
+
+#endif /* PYCOORDS_H */
@@ -0,0 +1,172 @@
+#include <stdlib.h>
+#include <string.h>
+#include "pygeoarrow.h"
+
+/**
+ * @struct VWArrowArrayObject
+ * @brief Python object owning the buffers of one simplified GeoArrow array
+ */
+typedef struct {
+    PyObject_HEAD
+    GeoArrowBuffers buffers;
+} VWArrowArrayObject;
+
+static void owner_retain(void* owner) {
+    Py_INCREF((PyObject*)owner);
+}
+
+static void owner_release(void* owner) {
+    // Consumers may release exported arrays from threads without the GIL
+    PyGILState_STATE state = PyGILState_Ensure();
+    Py_DECREF((PyObject*)owner);
+    PyGILState_Release(state);
+}
+
+static void schema_capsule_destructor(PyObject* capsule) {
+    struct ArrowSchema* schema = PyCapsule_GetPointer(capsule, "arrow_schema");
+    if (schema && schema->release)
+        schema->release(schema);
+    free(schema);
+}
+
+static void array_capsule_destructor(PyObject* capsule) {
+    struct ArrowArray* array = PyCapsule_GetPointer(capsule, "arrow_array");
+    if (array && array->release)
+        array->release(array);
+    free(array);
+}
+
+/**
+ * @brief Export the schema of a VWArrowArray in a new capsule
+ *
+ * @param self VWArrowArray object
+ * @return PyObject* "arrow_schema" capsule or NULL with an exception set
+ */
+static PyObject* export_schema_capsule(VWArrowArrayObject* self) {
+    struct ArrowSchema* schema = malloc(sizeof(struct ArrowSchema));
+    if (!schema || geoarrow_export_schema(&self->buffers, schema) != 0) {
+        free(schema);
+        return PyErr_NoMemory();
+    }
+    PyObject* capsule = PyCapsule_New(schema, "arrow_schema", schema_capsule_destructor);
+    if (!capsule) {
+        schema->release(schema);
+        free(schema);
+    }
+    return capsule;
+}
+
+static void VWArrowArray_dealloc(VWArrowArrayObject* self) {
+    geoarrow_buffers_free(&self->buffers);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static Py_ssize_t VWArrowArray_length(VWArrowArrayObject* self) {
+    return (Py_ssize_t)self->buffers.level_length[0];
+}
+
+static PyObject* VWArrowArray_arrow_c_schema(VWArrowArrayObject* self, PyObject* unused) {
+    return export_schema_capsule(self);
+}
+
+static PyObject* VWArrowArray_arrow_c_array(VWArrowArrayObject* self, PyObject* args,
+                                            PyObject* kwargs) {
+    static char* kwlist[] = {"requested_schema", NULL};
+    PyObject* requested_schema = Py_None;
+
+    // The requested schema is only a hint; the layout of the input is kept
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &requested_schema))
+        return NULL;
+
+    PyObject* schema_capsule = export_schema_capsule(self);
+    if (!schema_capsule)
+        return NULL;
+
+    GeoArrowOwner owner = {owner_retain, owner_release, self};
+    struct ArrowArray* array = malloc(sizeof(struct ArrowArray));
+    if (!array || geoarrow_export_array(&self->buffers, &owner, array) != 0) {
+        free(array);
+        Py_DECREF(schema_capsule);
+        return PyErr_NoMemory();
+    }
+    PyObject* array_capsule = PyCapsule_New(array, "arrow_array", array_capsule_destructor);
+    if (!array_capsule) {
+        array->release(array);
+        free(array);
+        Py_DECREF(schema_capsule);
+        return NULL;
+    }
+
+    PyObject* result = PyTuple_Pack(2, schema_capsule, array_capsule);
+    Py_DECREF(schema_capsule);
+    Py_DECREF(array_capsule);
+    return result;
+}
+
+static PyMethodDef VWArrowArray_methods[] = {
+    {"__arrow_c_schema__", (PyCFunction)VWArrowArray_arrow_c_schema, METH_NOARGS,
+     "Export the array type as an Arrow schema capsule"},
+    {"__arrow_c_array__", (PyCFunction)(void(*)(void))VWArrowArray_arrow_c_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Export the array as Arrow schema and array capsules without copying"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PySequenceMethods VWArrowArray_as_sequence = {
+    .sq_length = (lenfunc)VWArrowArray_length,
+};
+
+PyTypeObject VWArrowArrayType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "visvalingam_c.VWArrowArray",
+    .tp_basicsize = sizeof(VWArrowArrayObject),
+    .tp_dealloc = (destructor)VWArrowArray_dealloc,
+    .tp_as_sequence = &VWArrowArray_as_sequence,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Simplified GeoArrow array exported through the Arrow PyCapsule interface",
+    .tp_methods = VWArrowArray_methods,
+};
+
+PyObject* arrow_array_new(GeoArrowBuffers** buffers) {
+    VWArrowArrayObject* array_obj = PyObject_New(VWArrowArrayObject, &VWArrowArrayType);
+    if (!array_obj)
+        return NULL;
+    memset(&array_obj->buffers, 0, sizeof(array_obj->buffers));
+    *buffers = &array_obj->buffers;
+    return (PyObject*)array_obj;
+}
+
+PyObject* arrow_capsules_from_object(PyObject* obj, const struct ArrowSchema** schema,
+                                     const struct ArrowArray** array) {
+    PyObject* method = PyObject_GetAttrString(obj, "__arrow_c_array__");
+    if (!method) {
+        PyErr_Clear();
+        PyErr_SetString(PyExc_TypeError,
+                        "Array must implement the Arrow PyCapsule interface (__arrow_c_array__)");
+        return NULL;
+    }
+    PyObject* capsules = PyObject_CallObject(method, NULL);
+    Py_DECREF(method);
+    if (!capsules)
+        return NULL;
+
+    if (!PyTuple_Check(capsules) || PyTuple_GET_SIZE(capsules) != 2) {
+        PyErr_SetString(PyExc_TypeError,
+                        "__arrow_c_array__ must return a (schema, array) tuple of capsules");
+        Py_DECREF(capsules);
+        return NULL;
+    }
+    *schema = PyCapsule_GetPointer(PyTuple_GET_ITEM(capsules, 0), "arrow_schema");
+    *array = *schema ? PyCapsule_GetPointer(PyTuple_GET_ITEM(capsules, 1), "arrow_array")
+                     : NULL;
+    if (!*array) {
+        Py_DECREF(capsules);
+        return NULL;
+    }
+    if (!(*schema)->release || !(*array)->release) {
+        PyErr_SetString(PyExc_ValueError, "Arrow array has already been released");
+        Py_DECREF(capsules);
+        return NULL;
+    }
+    return capsules;
+}
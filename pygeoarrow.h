@@ -0,0 +1,43 @@
+/**
+ * @file pygeoarrow.h
+ * @brief Python side of the Arrow PyCapsule interface
+ *
+ * This header declares the VWArrowArray type that simplify_arrow returns,
+ * which owns the buffers of one simplified GeoArrow array and exports
+ * them through __arrow_c_array__ without copying, and the helper that
+ * imports an Arrow array from any object implementing that protocol.
+ */
+
+#ifndef PYGEOARROW_H
+#define PYGEOARROW_H
+
+#include <Python.h>
+#include "geoarrow.h"
+
+/** The VWArrowArray Python type, readied by the module init function */
+extern PyTypeObject VWArrowArrayType;
+
+/**
+ * @brief Create an empty VWArrowArray
+ *
+ * @param buffers Receives the zero-initialized buffers the object owns
+ * @return PyObject* New VWArrowArray object or NULL with an exception set
+ */
+PyObject* arrow_array_new(GeoArrowBuffers** buffers);
+
+/**
+ * @brief Import an Arrow array through the object's __arrow_c_array__ method
+ *
+ * The schema and array stay owned by the returned capsules and are
+ * released with them.
+ *
+ * @param obj    Object implementing the Arrow PyCapsule interface
+ * @param schema Receives the schema
+ * @param array  Receives the array
+ * @return PyObject* Tuple of the schema and array capsules, or NULL with an
+ *                   exception set
+ */
+PyObject* arrow_capsules_from_object(PyObject* obj, const struct ArrowSchema** schema,
+                                     const struct ArrowArray** array);
+
+#endif /* PYGEOARROW_H */
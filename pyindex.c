@@ -0,0 +1,233 @@
+// The numpy C API is imported once, by the module init in visvalingam.c
+#define NO_IMPORT_ARRAY
+#include "pyindex.h"
+#include "elimination.h"
+#include "simplify.h"
+#include "pycoords.h"
+#include "pycache.h"
+
+/**
+ * @struct VWIndexObject
+ * @brief Python object owning an elimination index
+ */
+typedef struct {
+    PyObject_HEAD
+    EliminationIndex* index;
+} VWIndexObject;
+
+/**
+ * @brief Create the (target + 1, D) result array for an index extraction
+ *
+ * D is the column count of the indexed points. Open lines have no closure
+ * point and get a (target, D) array.
+ *
+ * @param self   VWIndex object
+ * @param target Number of vertices to keep
+ * @return PyObject* New numpy array or NULL on failure
+ */
+static PyObject* extract_array(VWIndexObject* self, VertexIndex target) {
+    npy_intp dims[2] = {target + (self->index->closed ? 1 : 0),  // +1 for closure point
+                        self->index->dims};
+    PyArrayObject* result_obj = (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+    if (!result_obj)
+        return NULL;
+
+    if (elimination_index_extract(self->index, target, (double*)PyArray_DATA(result_obj)) != 0) {
+        Py_DECREF(result_obj);
+        return PyErr_NoMemory();
+    }
+    return (PyObject*)result_obj;
+}
+
+static void VWIndex_dealloc(VWIndexObject* self) {
+    elimination_index_destroy(self->index);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* VWIndex_extract(VWIndexObject* self, PyObject* args) {
+    Py_ssize_t target;
+    if (!PyArg_ParseTuple(args, "n", &target))
+        return NULL;
+
+    int min_count = min_vertices(self->index->closed);
+    if (target < min_count || target > self->index->num_points) {
+        PyErr_Format(PyExc_ValueError,
+                     "Invalid resolution: must be between %d and %lld, is: %zd",
+                     min_count, (long long)self->index->num_points, target);
+        return NULL;
+    }
+    return extract_array(self, (VertexIndex)target);
+}
+
+static PyObject* VWIndex_extract_by_area(VWIndexObject* self, PyObject* args) {
+    double threshold;
+    if (!PyArg_ParseTuple(args, "d", &threshold))
+        return NULL;
+
+    return extract_array(self, elimination_index_count_for_area(self->index, threshold));
+}
+
+static PyObject* VWIndex_progressive(VWIndexObject* self, PyObject* args) {
+    npy_intp num_points = self->index->num_points;
+    npy_intp pair_dims[2] = {num_points, 2};
+    npy_intp point_dims[2] = {num_points, self->index->dims};
+    PyArrayObject* points_obj = (PyArrayObject*)PyArray_SimpleNew(2, point_dims, NPY_DOUBLE);
+    PyArrayObject* links_obj = (PyArrayObject*)PyArray_SimpleNew(2, pair_dims, NPY_VERTEX_INDEX);
+    PyArrayObject* areas_obj = (PyArrayObject*)PyArray_SimpleNew(1, pair_dims, NPY_DOUBLE);
+    if (!points_obj || !links_obj || !areas_obj)
+        goto fail;
+
+    if (elimination_index_progressive(self->index, (double*)PyArray_DATA(points_obj),
+                                      (VertexIndex*)PyArray_DATA(links_obj),
+                                      (double*)PyArray_DATA(areas_obj)) != 0) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+    return Py_BuildValue("(NNN)", points_obj, links_obj, areas_obj);
+
+fail:
+    Py_XDECREF(points_obj);
+    Py_XDECREF(links_obj);
+    Py_XDECREF(areas_obj);
+    return NULL;
+}
+
+static PyObject* VWIndex_get_num_vertices(VWIndexObject* self, void* closure) {
+    return PyLong_FromLongLong(self->index->num_points);
+}
+
+static PyObject* VWIndex_get_ranks(VWIndexObject* self, void* closure) {
+    npy_intp dims[1] = {self->index->num_points};
+    PyArrayObject* ranks_obj = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_VERTEX_INDEX);
+    if (!ranks_obj)
+        return NULL;
+
+    VertexIndex* ranks = (VertexIndex*)PyArray_DATA(ranks_obj);
+    for (VertexIndex rank = 0; rank < self->index->num_points; rank++)
+        ranks[self->index->order[rank]] = rank;
+    return (PyObject*)ranks_obj;
+}
+
+static PyObject* VWIndex_get_closed(VWIndexObject* self, void* closure) {
+    return PyBool_FromLong(self->index->closed);
+}
+
+static PyObject* VWIndex_get_areas(VWIndexObject* self, void* closure) {
+    npy_intp dims[1] = {self->index->num_points};
+    PyArrayObject* areas_obj = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if (!areas_obj)
+        return NULL;
+
+    double* areas = (double*)PyArray_DATA(areas_obj);
+    for (VertexIndex rank = 0; rank < self->index->num_points; rank++)
+        areas[self->index->order[rank]] = self->index->order_areas[rank];
+    return (PyObject*)areas_obj;
+}
+
+static PyMethodDef VWIndex_methods[] = {
+    {"extract", (PyCFunction)VWIndex_extract, METH_VARARGS,
+     "Return the ring simplified to the given number of vertices"},
+    {"extract_by_area", (PyCFunction)VWIndex_extract_by_area, METH_VARARGS,
+     "Return the ring keeping every vertex whose effective area exceeds the threshold"},
+    {"progressive", (PyCFunction)VWIndex_progressive, METH_NOARGS,
+     "Return (points, links, areas) of the ring as a progressive vertex insertion stream"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef VWIndex_getset[] = {
+    {"num_vertices", (getter)VWIndex_get_num_vertices, NULL,
+     "Number of distinct vertices in the indexed ring", NULL},
+    {"ranks", (getter)VWIndex_get_ranks, NULL,
+     "Removal rank of every vertex, 0 for the first vertex removed", NULL},
+    {"areas", (getter)VWIndex_get_areas, NULL,
+     "Effective area at which every vertex is removed, inf for those never removed", NULL},
+    {"closed", (getter)VWIndex_get_closed, NULL,
+     "False if the index was built over an open line", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+PyTypeObject VWIndexType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "visvalingam_c.VWIndex",
+    .tp_basicsize = sizeof(VWIndexObject),
+    .tp_dealloc = (destructor)VWIndex_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Precomputed Visvalingam-Whyatt elimination order of a ring",
+    .tp_methods = VWIndex_methods,
+    .tp_getset = VWIndex_getset,
+};
+
+PyObject* build_index_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"points", "closed", "metric", "cache", NULL};
+    PyObject* points_arg;
+    int closed = 1;
+    const char* metric_name = "area";
+    PyObject* cache_arg = Py_None;
+    AreaMetric metric;
+    OrderCache* cache;
+
+    // Parse input arguments
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|psO", kwlist, &points_arg, &closed,
+                                     &metric_name, &cache_arg))
+        return NULL;
+    if (metric_from_name(metric_name, &metric) != 0 || cache_from_object(cache_arg, &cache) != 0)
+        return NULL;
+
+    Coords coords;
+    PyArrayObject* points_obj = points_from_object(points_arg, "Points", &coords);
+    if (!points_obj)
+        return NULL;
+    if (check_metric_dims(metric, &coords) != 0) {
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    if (check_ring_size(PyArray_DIM(points_obj, 0)) != 0) {
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+    VertexIndex num_points = (VertexIndex)PyArray_DIM(points_obj, 0);
+    if (closed)
+        num_points = ring_vertex_count(&coords, num_points);
+    if (num_points < min_vertices(closed)) {
+        PyErr_SetString(PyExc_ValueError, closed ?
+                        "Ring must have at least 3 distinct vertices" :
+                        "Line must have at least 2 vertices");
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    VWIndexObject* index_obj = PyObject_New(VWIndexObject, &VWIndexType);
+    if (!index_obj) {
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    EliminationIndex* index;
+    Py_BEGIN_ALLOW_THREADS
+    if (cache) {
+        // A cached order replaces the elimination; the points are still copied
+        OrderKey key;
+        order_cache_key(&coords, num_points, closed, metric, &key);
+        index = elimination_index_create(&coords, num_points, closed);
+        if (index && !order_cache_lookup(cache, &key, 0, index->order, index->order_areas)) {
+            if (elimination_index_rank(index, &coords, metric) == 0) {
+                order_cache_insert(cache, &key, index->order, index->order_areas);
+            } else {
+                elimination_index_destroy(index);
+                index = NULL;
+            }
+        }
+    } else {
+        index = elimination_index_build(&coords, num_points, closed, metric);
+    }
+    Py_END_ALLOW_THREADS
+
+    Py_DECREF(points_obj);
+    index_obj->index = index;
+    if (!index) {
+        Py_DECREF(index_obj);
+        return PyErr_NoMemory();
+    }
+    return (PyObject*)index_obj;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file pyindex.h
+ * @brief Python VWIndex type wrapping a precomputed elimination order
+ *
+ * A VWIndex is returned by build_index and serves simplified rings at any
+ * vertex count or area threshold without rerunning the elimination loop.
+ */
+
+#ifndef PYINDEX_H
+#define PYINDEX_H
+
+#include <Python.h>
+#include <numpy/arrayobject.h>
+
+/** The VWIndex Python type, readied by the module init function */
+extern PyTypeObject VWIndexType;
+
+/**
+ * @brief Python-callable function building a VWIndex from a ring or open line
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing the (n, 2) points array
+ * @param kwargs Optional keyword arguments (closed, metric, cache)
+ * @return PyObject* New VWIndex object
+ */
+PyObject* build_index_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+#endif /* PYINDEX_H */
@@ -0,0 +1,261 @@
+// The numpy C API is imported once, by the module init in visvalingam.c
+#define NO_IMPORT_ARRAY
+#include <stdlib.h>
+#include <string.h>
+#include "pysimplifier.h"
+#include "incremental.h"
+#include "simplify.h"
+#include "pycoords.h"
+
+/**
+ * @struct VWSimplifierObject
+ * @brief Python object owning an incrementally updated ring
+ */
+typedef struct {
+    PyObject_HEAD
+    IncrementalRing* ring;
+} VWSimplifierObject;
+
+/**
+ * @brief Check a vertex argument against the current ring
+ *
+ * @param self   VWSimplifier object
+ * @param vertex Vertex or position argument
+ * @param limit  Largest allowed value
+ * @return int 0 if it is in range, -1 with an IndexError set otherwise
+ */
+static int check_vertex(VWSimplifierObject* self, Py_ssize_t vertex, Py_ssize_t limit) {
+    if (vertex < 0 || vertex > limit) {
+        PyErr_Format(PyExc_IndexError, "Vertex %zd out of range for a ring of %lld vertices",
+                     vertex, (long long)self->ring->num_points);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Create the (target + 1, 2) array of the ring simplified to target vertices
+ *
+ * Open lines have no closure point and get a (target, 2) array.
+ *
+ * @param self   VWSimplifier object
+ * @param target Number of vertices to keep
+ * @return PyObject* New numpy array or NULL with an exception set
+ */
+static PyObject* extract_ring(VWSimplifierObject* self, Py_ssize_t target) {
+    const IncrementalRing* ring = self->ring;
+    if (target < ring->min_resolution || target > ring->num_points) {
+        PyErr_Format(PyExc_ValueError,
+                     "Invalid resolution: must be between %lld and %lld, is: %zd",
+                     (long long)ring->min_resolution, (long long)ring->num_points, target);
+        return NULL;
+    }
+
+    npy_intp dims[2] = {target + (ring->closed ? 1 : 0), 2};  // +1 for closure point
+    PyArrayObject* result_obj = (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+    if (!result_obj)
+        return NULL;
+    incremental_extract(ring, (VertexIndex)target, (double*)PyArray_DATA(result_obj));
+    return (PyObject*)result_obj;
+}
+
+static void VWSimplifier_dealloc(VWSimplifierObject* self) {
+    incremental_destroy(self->ring);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* VWSimplifier_move(VWSimplifierObject* self, PyObject* args) {
+    Py_ssize_t vertex;
+    double x, y;
+    if (!PyArg_ParseTuple(args, "ndd", &vertex, &x, &y))
+        return NULL;
+    if (check_vertex(self, vertex, self->ring->num_points - 1) != 0)
+        return NULL;
+
+    incremental_move(self->ring, (VertexIndex)vertex, x, y);
+    Py_RETURN_NONE;
+}
+
+static PyObject* VWSimplifier_insert(VWSimplifierObject* self, PyObject* args) {
+    Py_ssize_t position;
+    double x, y;
+    if (!PyArg_ParseTuple(args, "ndd", &position, &x, &y))
+        return NULL;
+    if (check_vertex(self, position, self->ring->num_points) != 0 ||
+        check_ring_size((npy_intp)self->ring->num_points + 1) != 0)
+        return NULL;
+
+    if (incremental_insert(self->ring, (VertexIndex)position, x, y) != 0)
+        return PyErr_NoMemory();
+    Py_RETURN_NONE;
+}
+
+static PyObject* VWSimplifier_delete(VWSimplifierObject* self, PyObject* args) {
+    Py_ssize_t vertex;
+    if (!PyArg_ParseTuple(args, "n", &vertex))
+        return NULL;
+    if (check_vertex(self, vertex, self->ring->num_points - 1) != 0)
+        return NULL;
+    if (self->ring->num_points <= self->ring->min_resolution) {
+        PyErr_Format(PyExc_ValueError, "Ring must keep at least min_resolution (%lld) vertices",
+                     (long long)self->ring->min_resolution);
+        return NULL;
+    }
+
+    incremental_delete(self->ring, (VertexIndex)vertex);
+    Py_RETURN_NONE;
+}
+
+static PyObject* VWSimplifier_extract(VWSimplifierObject* self, PyObject* args) {
+    Py_ssize_t target;
+    if (!PyArg_ParseTuple(args, "n", &target))
+        return NULL;
+    return extract_ring(self, target);
+}
+
+static PyObject* VWSimplifier_simplify(VWSimplifierObject* self, PyObject* args) {
+    PyObject* resolutions_arg;
+    if (!PyArg_ParseTuple(args, "O", &resolutions_arg))
+        return NULL;
+
+    int num_resolutions;
+    int* resolutions = int_values_from_object(resolutions_arg, "Resolutions", &num_resolutions);
+    if (!resolutions)
+        return NULL;
+
+    PyObject* result_list = PyList_New(num_resolutions);
+    for (int i = 0; i < num_resolutions && result_list; i++) {
+        PyObject* result_obj = extract_ring(self, resolutions[i]);
+        if (!result_obj)
+            Py_CLEAR(result_list);
+        else
+            PyList_SET_ITEM(result_list, i, result_obj);
+    }
+    free(resolutions);
+    return result_list;
+}
+
+static PyObject* VWSimplifier_get_num_vertices(VWSimplifierObject* self, void* closure) {
+    return PyLong_FromLongLong(self->ring->num_points);
+}
+
+static PyObject* VWSimplifier_get_min_resolution(VWSimplifierObject* self, void* closure) {
+    return PyLong_FromLongLong(self->ring->min_resolution);
+}
+
+static PyObject* VWSimplifier_get_last_span(VWSimplifierObject* self, void* closure) {
+    return PyLong_FromLongLong(self->ring->last_span);
+}
+
+static PyObject* VWSimplifier_get_closed(VWSimplifierObject* self, void* closure) {
+    return PyBool_FromLong(self->ring->closed);
+}
+
+static PyObject* VWSimplifier_get_points(VWSimplifierObject* self, void* closure) {
+    npy_intp dims[2] = {self->ring->num_points, 2};
+    PyArrayObject* points_obj = (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+    if (!points_obj)
+        return NULL;
+    memcpy(PyArray_DATA(points_obj), self->ring->points,
+           2 * (size_t)self->ring->num_points * sizeof(double));
+    return (PyObject*)points_obj;
+}
+
+static PyMethodDef VWSimplifier_methods[] = {
+    {"move", (PyCFunction)VWSimplifier_move, METH_VARARGS,
+     "Move vertex i to (x, y)"},
+    {"insert", (PyCFunction)VWSimplifier_insert, METH_VARARGS,
+     "Insert a vertex at (x, y) so that it becomes vertex i"},
+    {"delete", (PyCFunction)VWSimplifier_delete, METH_VARARGS,
+     "Delete vertex i"},
+    {"extract", (PyCFunction)VWSimplifier_extract, METH_VARARGS,
+     "Return the ring simplified to the given number of vertices"},
+    {"simplify", (PyCFunction)VWSimplifier_simplify, METH_VARARGS,
+     "Return the ring simplified to every resolution of a list"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef VWSimplifier_getset[] = {
+    {"num_vertices", (getter)VWSimplifier_get_num_vertices, NULL,
+     "Number of vertices in the edited ring", NULL},
+    {"min_resolution", (getter)VWSimplifier_get_min_resolution, NULL,
+     "Smallest resolution that can be extracted", NULL},
+    {"last_span", (getter)VWSimplifier_get_last_span, NULL,
+     "Vertices re-simplified by the last edit, num_vertices if it rebuilt the ring", NULL},
+    {"closed", (getter)VWSimplifier_get_closed, NULL,
+     "False if the simplifier holds an open line", NULL},
+    {"points", (getter)VWSimplifier_get_points, NULL,
+     "Copy of the edited ring as an (n, 2) float64 array", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+PyTypeObject VWSimplifierType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "visvalingam_c.VWSimplifier",
+    .tp_basicsize = sizeof(VWSimplifierObject),
+    .tp_dealloc = (destructor)VWSimplifier_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Ring simplification state that re-simplifies only around local edits",
+    .tp_methods = VWSimplifier_methods,
+    .tp_getset = VWSimplifier_getset,
+};
+
+PyObject* build_simplifier_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"points", "min_resolution", "closed", "metric", NULL};
+    PyObject* points_arg;
+    Py_ssize_t min_resolution;
+    int closed = 1;
+    const char* metric_name = "area";
+    AreaMetric metric;
+
+    // Parse input arguments
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On|ps", kwlist, &points_arg,
+                                     &min_resolution, &closed, &metric_name))
+        return NULL;
+    if (metric_from_name(metric_name, &metric) != 0)
+        return NULL;
+    // Edits move and insert x,y points, so the record has no z to rank by
+    if (metric == METRIC_AREA_3D) {
+        PyErr_SetString(PyExc_ValueError, "Metric 'area3d' is not available in build_simplifier");
+        return NULL;
+    }
+
+    Coords coords;
+    PyArrayObject* points_obj = coords_from_object(points_arg, "Points", &coords);
+    if (!points_obj)
+        return NULL;
+
+    if (check_ring_size(PyArray_DIM(points_obj, 0)) != 0) {
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+    VertexIndex num_points = (VertexIndex)PyArray_DIM(points_obj, 0);
+    if (closed)
+        num_points = ring_vertex_count(&coords, num_points);
+    if (min_resolution < min_vertices(closed) || min_resolution > num_points) {
+        PyErr_Format(PyExc_ValueError,
+                     "Invalid min_resolution: must be between %d and %lld, is: %zd",
+                     min_vertices(closed), (long long)num_points, min_resolution);
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    VWSimplifierObject* simplifier_obj = PyObject_New(VWSimplifierObject, &VWSimplifierType);
+    if (!simplifier_obj) {
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    IncrementalRing* ring;
+    Py_BEGIN_ALLOW_THREADS
+    ring = incremental_create(&coords, num_points, closed, metric, (VertexIndex)min_resolution);
+    Py_END_ALLOW_THREADS
+
+    Py_DECREF(points_obj);
+    simplifier_obj->ring = ring;
+    if (!ring) {
+        Py_DECREF(simplifier_obj);
+        return PyErr_NoMemory();
+    }
+    return (PyObject*)simplifier_obj;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file pysimplifier.h
+ * @brief Python VWSimplifier type wrapping an incrementally updated ring
+ *
+ * A VWSimplifier is returned by build_simplifier and keeps the removal
+ * record of one ring, so local edits re-simplify only the span around
+ * them before the requested resolutions are extracted again.
+ */
+
+#ifndef PYSIMPLIFIER_H
+#define PYSIMPLIFIER_H
+
+#include <Python.h>
+#include <numpy/arrayobject.h>
+
+/** The VWSimplifier Python type, readied by the module init function */
+extern PyTypeObject VWSimplifierType;
+
+/**
+ * @brief Python-callable function building a VWSimplifier from a ring or open line
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing the (n, 2) points array and the minimum resolution
+ * @param kwargs Optional keyword arguments (closed, metric)
+ * @return PyObject* New VWSimplifier object
+ */
+PyObject* build_simplifier_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+#endif /* PYSIMPLIFIER_H */
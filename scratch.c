@@ -0,0 +1,62 @@
+#include "scratch.h"
+#include "parallel.h"
+
+static Mutex pool_mutex;
+static Workspace* pool[SCRATCH_POOL_SIZE];
+static int pool_size = 0;
+static int pool_ready = 0;
+
+void scratch_init(void) {
+    if (pool_ready)
+        return;
+    mutex_init(&pool_mutex);
+    pool_ready = 1;
+}
+
+Workspace* scratch_acquire(VertexIndex capacity) {
+    Workspace* ws = NULL;
+
+    mutex_lock(&pool_mutex);
+    if (pool_size > 0) {
+        // Largest first, so one big ring does not make every pooled workspace grow
+        int best = 0;
+        for (int i = 1; i < pool_size; i++) {
+            if (pool[i]->capacity > pool[best]->capacity)
+                best = i;
+        }
+        ws = pool[best];
+        pool[best] = pool[--pool_size];
+    }
+    mutex_unlock(&pool_mutex);
+
+    if (!ws)
+        return workspace_create(capacity);
+
+    ws->metric = METRIC_AREA;
+    if (workspace_reserve(ws, capacity) != 0) {
+        workspace_destroy(ws);
+        return NULL;
+    }
+    return ws;
+}
+
+void scratch_release(Workspace* ws) {
+    if (!ws)
+        return;
+
+    mutex_lock(&pool_mutex);
+    if (pool_size < SCRATCH_POOL_SIZE) {
+        pool[pool_size++] = ws;
+        ws = NULL;
+    }
+    mutex_unlock(&pool_mutex);
+
+    workspace_destroy(ws);
+}
+
+void scratch_clear(void) {
+    mutex_lock(&pool_mutex);
+    while (pool_size > 0)
+        workspace_destroy(pool[--pool_size]);
+    mutex_unlock(&pool_mutex);
+}
@@ -0,0 +1,59 @@
+/**
+ * @file scratch.h
+ * @brief Process-wide pool of reusable workspaces
+ *
+ * This header defines the pool every entry point takes its workspace
+ * from. A released workspace keeps its buffers, so after warming up,
+ * requests on small and medium rings simplify without allocating. The
+ * pool is shared by all threads, including batch workers.
+ */
+
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include "simplify.h"
+
+/**
+ * @def SCRATCH_POOL_SIZE
+ * @brief Most idle workspaces the pool keeps; further releases free them
+ */
+#ifndef SCRATCH_POOL_SIZE
+#define SCRATCH_POOL_SIZE 64
+#endif
+
+/**
+ * @brief Prepare the pool; must be called before any other function
+ *
+ * Later calls do nothing. Not thread-safe: call it while only one thread
+ * uses the library, e.g. from the module init function.
+ */
+void scratch_init(void);
+
+/**
+ * @brief Take a workspace able to hold rings of the given size
+ *
+ * Prefers the idle workspace with the largest capacity, and creates a new
+ * one when the pool is empty. The workspace uses METRIC_AREA until the
+ * caller changes it.
+ *
+ * @param capacity Number of vertices to reserve for
+ * @return Workspace* Workspace or NULL if memory could not be allocated
+ */
+Workspace* scratch_acquire(VertexIndex capacity);
+
+/**
+ * @brief Return a workspace to the pool
+ *
+ * @param ws Workspace from scratch_acquire (may be NULL)
+ */
+void scratch_release(Workspace* ws);
+
+/**
+ * @brief Free every idle workspace
+ *
+ * Returns the memory kept after simplifying large rings. Workspaces that
+ * are acquired stay with their callers and are pooled again on release.
+ */
+void scratch_clear(void);
+
+#endif /* SCRATCH_H */
@@ -0,0 +1,339 @@
+#include <math.h>
+#include <stdlib.h>
+#include "segment_grid.h"
+#include "stats.h"
+
+/**
+ * @def CELL_EPSILON
+ * @brief Margin, in cell units, added around every segment walk
+ *
+ * Two segments meeting on a cell boundary may round into different cells;
+ * widening each walk slightly makes both land in a common cell.
+ */
+#define CELL_EPSILON 1e-9
+
+SegmentGrid* segment_grid_create(void) {
+    return (SegmentGrid*)calloc(1, sizeof(SegmentGrid));
+}
+
+void segment_grid_destroy(SegmentGrid* grid) {
+    if (!grid)
+        return;
+    free(grid->cell_head);
+    free(grid->entry_next);
+    free(grid->entry_start);
+    free(grid->entry_end);
+    free(grid);
+}
+
+/**
+ * @brief Grow the entry arrays to hold at least capacity entries
+ *
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+static int reserve_entries(SegmentGrid* grid, VertexIndex capacity) {
+    if (capacity <= grid->capacity)
+        return 0;
+    if (grid->capacity > VERTEX_INDEX_MAX / 2)
+        return -1;
+    if (capacity < 2 * grid->capacity)
+        capacity = 2 * grid->capacity;
+
+    size_t size = (size_t)capacity * sizeof(VertexIndex);
+    VertexIndex* entry_next = realloc(grid->entry_next, size);
+    if (entry_next)
+        grid->entry_next = entry_next;
+    VertexIndex* entry_start = realloc(grid->entry_start, size);
+    if (entry_start)
+        grid->entry_start = entry_start;
+    VertexIndex* entry_end = realloc(grid->entry_end, size);
+    if (entry_end)
+        grid->entry_end = entry_end;
+
+    if (!entry_next || !entry_start || !entry_end)
+        return -1;
+    grid->capacity = capacity;
+    STATS_ADD(reallocs, 1);
+    return 0;
+}
+
+/**
+ * @brief Cell coordinate of a position in cell units, clamped to the grid
+ */
+static inline VertexIndex cell_floor(double value, VertexIndex count) {
+    if (!(value >= 0.0))  // Also catches NaN
+        return 0;
+    if (value >= (double)count)
+        return count - 1;
+    return (VertexIndex)value;
+}
+
+/**
+ * @brief Visit every cell a segment passes through
+ *
+ * Walks the columns covered by the segment and, in each, the rows covered
+ * by the part of the segment inside that column. Stops early when visit
+ * returns nonzero.
+ *
+ * @return int The nonzero value returned by visit, or 0
+ */
+static int walk_cells(const SegmentGrid* grid, const double a[2], const double b[2],
+                      int (*visit)(void* ctx, VertexIndex cell), void* ctx) {
+    double ax = (a[0] - grid->min_x) * grid->inv_cell;
+    double ay = (a[1] - grid->min_y) * grid->inv_cell;
+    double bx = (b[0] - grid->min_x) * grid->inv_cell;
+    double by = (b[1] - grid->min_y) * grid->inv_cell;
+    if (ax > bx) {
+        double tx = ax, ty = ay;
+        ax = bx;
+        ay = by;
+        bx = tx;
+        by = ty;
+    }
+
+    double dx = bx - ax;
+    double slope = dx > 0.0 ? (by - ay) / dx : 0.0;
+    VertexIndex c0 = cell_floor(ax - CELL_EPSILON, grid->cols);
+    VertexIndex c1 = cell_floor(bx + CELL_EPSILON, grid->cols);
+
+    for (VertexIndex c = c0; c <= c1; c++) {
+        double y_lo = ay, y_hi = by;
+        if (dx > 0.0) {
+            double x_lo = c == c0 ? ax : fmax(ax, (double)c);
+            double x_hi = c == c1 ? bx : fmin(bx, (double)(c + 1));
+            y_lo = ay + (x_lo - ax) * slope;
+            y_hi = ay + (x_hi - ax) * slope;
+        }
+        if (y_lo > y_hi) {
+            double t = y_lo;
+            y_lo = y_hi;
+            y_hi = t;
+        }
+
+        VertexIndex r0 = cell_floor(y_lo - CELL_EPSILON, grid->rows);
+        VertexIndex r1 = cell_floor(y_hi + CELL_EPSILON, grid->rows);
+        for (VertexIndex r = r0; r <= r1; r++) {
+            int stop = visit(ctx, r * grid->cols + c);
+            if (stop)
+                return stop;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @struct InsertContext
+ * @brief Segment being registered by insert_visit
+ */
+typedef struct {
+    SegmentGrid* grid;
+    VertexIndex start;
+    VertexIndex end;
+} InsertContext;
+
+static int insert_visit(void* ctx, VertexIndex cell) {
+    InsertContext* insert = (InsertContext*)ctx;
+    SegmentGrid* grid = insert->grid;
+
+    if (grid->num_entries == grid->capacity &&
+        reserve_entries(grid, grid->num_entries + 1) != 0) {
+        grid->failed = 1;
+        return 1;
+    }
+
+    VertexIndex entry = grid->num_entries++;
+    grid->entry_start[entry] = insert->start;
+    grid->entry_end[entry] = insert->end;
+    grid->entry_next[entry] = grid->cell_head[cell];
+    grid->cell_head[cell] = entry;
+    return 0;
+}
+
+void segment_grid_insert(SegmentGrid* grid, const Coords* coords, VertexIndex start,
+                         VertexIndex end) {
+    if (grid->failed)
+        return;
+
+    double a[2], b[2];
+    coords_point(coords, start, a);
+    coords_point(coords, end, b);
+
+    InsertContext insert = {grid, start, end};
+    walk_cells(grid, a, b, insert_visit, &insert);
+}
+
+int segment_grid_build(SegmentGrid* grid, const Coords* coords,
+                       const VertexLink* links, VertexIndex num_points) {
+    double min_x = INFINITY, min_y = INFINITY;
+    double max_x = -INFINITY, max_y = -INFINITY;
+    for (VertexIndex i = 0; i < num_points; i++) {
+        double point[2];
+        coords_point(coords, i, point);
+        min_x = fmin(min_x, point[0]);
+        min_y = fmin(min_y, point[1]);
+        max_x = fmax(max_x, point[0]);
+        max_y = fmax(max_y, point[1]);
+    }
+
+    // About one cell per vertex, square cells, never more than 4n + 16
+    double width = max_x - min_x;
+    double height = max_y - min_y;
+    VertexIndex max_cells = num_points < VERTEX_INDEX_MAX / 8 ? 4 * num_points + 16
+                                                              : VERTEX_INDEX_MAX / 2;
+    grid->cols = 1;
+    grid->rows = 1;
+    grid->min_x = 0.0;
+    grid->min_y = 0.0;
+    grid->inv_cell = 0.0;
+
+    if (isfinite(width) && isfinite(height) && (width > 0.0 || height > 0.0)) {
+        double n = num_points > 0 ? (double)num_points : 1.0;
+        double cell = fmax(sqrt(width * height / n), fmax(width, height) / n);
+        while ((width / cell + 1.0) * (height / cell + 1.0) > (double)max_cells)
+            cell *= 2.0;
+        grid->min_x = min_x;
+        grid->min_y = min_y;
+        grid->inv_cell = 1.0 / cell;
+        grid->cols = (VertexIndex)(width / cell) + 1;
+        grid->rows = (VertexIndex)(height / cell) + 1;
+    }
+
+    VertexIndex num_cells = grid->cols * grid->rows;
+    if (num_cells > grid->cell_capacity) {
+        VertexIndex* cell_head = realloc(grid->cell_head,
+                                         (size_t)num_cells * sizeof(VertexIndex));
+        if (!cell_head)
+            return -1;
+        grid->cell_head = cell_head;
+        grid->cell_capacity = num_cells;
+        STATS_ADD(reallocs, 1);
+    }
+    for (VertexIndex c = 0; c < num_cells; c++)
+        grid->cell_head[c] = -1;
+
+    grid->num_entries = 0;
+    grid->failed = 0;
+    if (reserve_entries(grid, 2 * num_points + 16) != 0)
+        return -1;
+
+    for (VertexIndex i = 0; i < num_points; i++) {
+        if (links[i].next >= 0)
+            segment_grid_insert(grid, coords, i, links[i].next);
+    }
+    return grid->failed ? -1 : 0;
+}
+
+/**
+ * @brief Twice the signed area of the triangle a, b, c, zero only if they are collinear
+ */
+static inline double orientation(const double a[2], const double b[2], const double c[2]) {
+    return triangle_cross(a, b, c);
+}
+
+/**
+ * @brief Whether p, known to be collinear with a and b, lies within segment a-b
+ */
+static inline int within_segment(const double a[2], const double b[2], const double p[2]) {
+    return fmin(a[0], b[0]) <= p[0] && p[0] <= fmax(a[0], b[0]) &&
+           fmin(a[1], b[1]) <= p[1] && p[1] <= fmax(a[1], b[1]);
+}
+
+/**
+ * @brief Whether segments p1-p2 and q1-q2 share at least one point
+ */
+static int segments_touch(const double p1[2], const double p2[2],
+                          const double q1[2], const double q2[2]) {
+    double d1 = orientation(q1, q2, p1);
+    double d2 = orientation(q1, q2, p2);
+    double d3 = orientation(p1, p2, q1);
+    double d4 = orientation(p1, p2, q2);
+
+    if (((d1 > 0.0 && d2 < 0.0) || (d1 < 0.0 && d2 > 0.0)) &&
+        ((d3 > 0.0 && d4 < 0.0) || (d3 < 0.0 && d4 > 0.0)))
+        return 1;
+
+    return (d1 == 0.0 && within_segment(q1, q2, p1)) ||
+           (d2 == 0.0 && within_segment(q1, q2, p2)) ||
+           (d3 == 0.0 && within_segment(p1, p2, q1)) ||
+           (d4 == 0.0 && within_segment(p1, p2, q2));
+}
+
+/**
+ * @struct CheckContext
+ * @brief Candidate segment a-b tested by check_visit
+ */
+typedef struct {
+    const SegmentGrid* grid;
+    const Coords* coords;
+    const VertexLink* links;
+    VertexIndex vertex;
+    VertexIndex a;
+    VertexIndex b;
+    double pa[2];
+    double pb[2];
+} CheckContext;
+
+/**
+ * @brief Test the candidate against the live segments of one cell
+ *
+ * @return int 1 if a conflicting segment was found, 0 otherwise
+ */
+static int check_visit(void* ctx, VertexIndex cell) {
+    const CheckContext* check = (const CheckContext*)ctx;
+    const SegmentGrid* grid = check->grid;
+
+    for (VertexIndex entry = grid->cell_head[cell]; entry >= 0;
+         entry = grid->entry_next[entry]) {
+        VertexIndex s = grid->entry_start[entry];
+        VertexIndex e = grid->entry_end[entry];
+
+        // Retired entries, and the two segments the candidate replaces
+        if (check->links[s].next != e)
+            continue;
+        if (s == check->vertex || e == check->vertex)
+            continue;
+
+        double ps[2], pe[2];
+        coords_point(check->coords, s, ps);
+        coords_point(check->coords, e, pe);
+
+        int shares_a = s == check->a || e == check->a;
+        int shares_b = s == check->b || e == check->b;
+        if (shares_a && shares_b)
+            continue;
+
+        if (shares_a || shares_b) {
+            // Neighbouring segments meet at the shared vertex; they only
+            // conflict when they fold back over each other
+            const double* shared = shares_a ? check->pa : check->pb;
+            const double* far = shares_a ? check->pb : check->pa;
+            const double* other = (s == check->a || s == check->b) ? pe : ps;
+            if (orientation(shared, far, other) == 0.0 &&
+                (within_segment(shared, far, other) || within_segment(shared, other, far)))
+                return 1;
+            continue;
+        }
+
+        if (segments_touch(check->pa, check->pb, ps, pe))
+            return 1;
+    }
+    return 0;
+}
+
+int segment_grid_can_remove(const SegmentGrid* grid, const Coords* coords,
+                            const VertexLink* links, VertexIndex vertex) {
+    if (grid->failed)
+        return 0;
+
+    CheckContext check;
+    check.grid = grid;
+    check.coords = coords;
+    check.links = links;
+    check.vertex = vertex;
+    check.a = links[vertex].prev;
+    check.b = links[vertex].next;
+    coords_point(coords, check.a, check.pa);
+    coords_point(coords, check.b, check.pb);
+
+    return !walk_cells(grid, check.pa, check.pb, check_visit, &check);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file segment_grid.h
+ * @brief Uniform grid over the active segments of a ring
+ *
+ * This header defines the spatial index used by the self-intersection-safe
+ * mode. Every segment is registered in each grid cell it crosses. Removing
+ * a vertex replaces its two segments with one bridging segment, and the
+ * removal is only allowed if the bridging segment touches no other active
+ * segment of the ring.
+ *
+ * Entries are never deleted: an entry for the segment start -> end is live
+ * only while the next link of start is still end, which also fails once
+ * start is removed, so unlinking a vertex retires its two segments without
+ * touching the grid.
+ */
+
+#ifndef SEGMENT_GRID_H
+#define SEGMENT_GRID_H
+
+#include "geometry.h"
+
+/**
+ * @struct SegmentGrid
+ * @brief Grid cells holding linked lists of segment entries
+ *
+ * @param min_x         Left edge of the grid
+ * @param min_y         Bottom edge of the grid
+ * @param inv_cell      Reciprocal of the cell size
+ * @param cols          Number of cell columns
+ * @param rows          Number of cell rows
+ * @param cell_head     First entry of every cell, -1 if empty
+ * @param cell_capacity Number of cells cell_head can hold
+ * @param entry_next    Next entry in the same cell, -1 at the end
+ * @param entry_start   Start vertex of the segment of every entry
+ * @param entry_end     End vertex of the segment of every entry
+ * @param num_entries   Number of entries in use
+ * @param capacity      Number of entries the arrays can hold
+ * @param failed        Set once an insertion ran out of memory
+ */
+typedef struct {
+    double min_x;
+    double min_y;
+    double inv_cell;
+    VertexIndex cols;
+    VertexIndex rows;
+    VertexIndex* cell_head;
+    VertexIndex cell_capacity;
+    VertexIndex* entry_next;
+    VertexIndex* entry_start;
+    VertexIndex* entry_end;
+    VertexIndex num_entries;
+    VertexIndex capacity;
+    int failed;
+} SegmentGrid;
+
+/**
+ * @brief Create an empty segment grid
+ *
+ * @return SegmentGrid* New grid or NULL on failure
+ */
+SegmentGrid* segment_grid_create(void);
+
+/**
+ * @brief Free all memory associated with the grid
+ *
+ * @param grid Grid to destroy (may be NULL)
+ */
+void segment_grid_destroy(SegmentGrid* grid);
+
+/**
+ * @brief Index the segments of a freshly linked ring or line
+ *
+ * Sizes the grid to the bounding box of the vertices, with about one cell
+ * per vertex, and registers the segment i -> links[i].next of every
+ * vertex that has a successor. Memory is reused between rings.
+ *
+ * @param grid       Target grid
+ * @param coords     Ring (unclosed) or line coordinates
+ * @param links      Links of the ring, next is -1 at the end of a line
+ * @param num_points Number of vertices
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int segment_grid_build(SegmentGrid* grid, const Coords* coords,
+                       const VertexLink* links, VertexIndex num_points);
+
+/**
+ * @brief Check whether removing a vertex keeps the ring free of new crossings
+ *
+ * Tests the segment that would bridge the two neighbours of vertex
+ * against every live segment in the cells it crosses.
+ * Returns 0 for every vertex once an insertion has failed, so the result
+ * stays valid even when memory runs out.
+ *
+ * @param grid   Grid built for the ring
+ * @param coords Ring coordinates passed to segment_grid_build
+ * @param links  Current links of the ring
+ * @param vertex Vertex about to be removed
+ * @return int 1 if the removal is safe, 0 otherwise
+ */
+int segment_grid_can_remove(const SegmentGrid* grid, const Coords* coords,
+                            const VertexLink* links, VertexIndex vertex);
+
+/**
+ * @brief Register the segment that bridges a removed vertex
+ *
+ * Sets grid->failed if memory could not be allocated.
+ *
+ * @param grid   Grid built for the ring
+ * @param coords Ring coordinates passed to segment_grid_build
+ * @param start  Start vertex of the new segment
+ * @param end    End vertex of the new segment
+ */
+void segment_grid_insert(SegmentGrid* grid, const Coords* coords, VertexIndex start,
+                         VertexIndex end);
+
+#endif /* SEGMENT_GRID_H */
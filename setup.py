@@ -4,31 +4,74 @@ from setuptools.command.build_ext import build_ext
 import sys
 
 
+# IEEE arithmetic without contraction into FMA, so results do not depend on
+# the machine -march=native targets and the exact area fallback stays exact.
+# The area and heap loops use explicit SIMD and need no -ffast-math.
+UNIX_FLAGS = ['-O3', '-march=native', '-fno-math-errno', '-fno-trapping-math',
+              '-ffp-contract=off', '-pthread']
+
+
+def compile_args():
+    """Compiler flags of the library and the extension for this platform."""
+    if sys.platform == 'darwin' or sys.platform.startswith('linux'):
+        return list(UNIX_FLAGS)
+    if sys.platform == 'win32':
+        return ['/O2', '/arch:AVX2', '/fp:precise']
+    return []
+
+
 class BuildExt(build_ext):
     """Custom build extension for handling compiler flags."""
 
     def build_extensions(self):
+        for ext in self.extensions:
+            ext.extra_compile_args += compile_args()
         if sys.platform == 'darwin':  # macOS
             for ext in self.extensions:
-                ext.extra_compile_args += ['-O3', '-march=native', '-ffast-math']
-                ext.extra_link_args += ['-Wl,-undefined,dynamic_lookup']
+                ext.extra_link_args += ['-Wl,-undefined,dynamic_lookup', '-pthread']
         elif sys.platform.startswith('linux'):  # Linux
             for ext in self.extensions:
-                ext.extra_compile_args += ['-O3', '-march=native', '-ffast-math']
-                ext.extra_link_args += ['-Wl,--allow-multiple-definition']
-        elif sys.platform == 'win32':  # Windows
-            for ext in self.extensions:
-                ext.extra_compile_args += ['/O2', '/arch:AVX2']
+                ext.extra_link_args += ['-Wl,--allow-multiple-definition', '-pthread']
 
         # Call the original build_extensions
         build_ext.build_extensions(self)
 
 
+# Python-free engine, built first as the static library libvisvalingam with
+# the C API of vw.h; the extension links it. See build.md for using the
+# library without Python.
+library_sources = [
+    'vw.c',
+    'simplify.c',
+    'batch.c',
+    'chunked.c',
+    'parallel.c',
+    'elimination.c',
+    'cache.c',
+    'geoarrow.c',
+    'topology.c',
+    'segment_grid.c',
+    'scratch.c',
+    'stream.c',
+    'stats.c',
+    'incremental.c',
+    'min_heap.c',
+    'geometry.c'
+]
+
+visvalingam_library = ('visvalingam', {
+    'sources': library_sources,
+    'cflags': compile_args(),
+})
+
 # Source files for the extension
 sources = [
     'visvalingam.c',
-    'min_heap.c',
-    'geometry.c'
+    'pyindex.c',
+    'pysimplifier.c',
+    'pycoords.c',
+    'pycache.c',
+    'pygeoarrow.c'
 ]
 
 # Define the extension module
@@ -42,6 +85,7 @@ visvalingam_module = Extension(
     define_macros=[
         ('NPY_NO_DEPRECATED_API', 'NPY_1_7_API_VERSION'),
         ('PY_SSIZE_T_CLEAN', None),
+        ('PY_ARRAY_UNIQUE_SYMBOL', 'visvalingam_ARRAY_API'),
     ],
     # Platform-specific compiler flags will be added by BuildExt
 )
@@ -52,6 +96,7 @@ setup(
     description='C implementation of Visvalingam-Whyatt polygon simplification',
     author='Lukas Sz',
     author_email='nahhh@bro.com.on',
+    libraries=[visvalingam_library],
     ext_modules=[visvalingam_module],
     cmdclass={'build_ext': BuildExt},
     setup_requires=['numpy'],
@@ -0,0 +1,313 @@
+#include <math.h>
+#include <stdlib.h>
+#include "simplify.h"
+#include "geometry.h"
+#include "stats.h"
+
+/**
+ * @brief Initialize the vertex linkage
+ *
+ * Sets up the circular linkage between vertices, which also marks every
+ * vertex as active. For an open line the first and last vertex link to -1
+ * instead of wrapping around.
+ *
+ * @param links Array to store the links of every vertex
+ * @param num_points Number of vertices in the polygon
+ * @param closed Nonzero for a ring, zero for an open line
+ */
+static void initialize_vertex_linkage(VertexLink* links, VertexIndex num_points, int closed) {
+    for (VertexIndex i = 0; i < num_points; i++) {
+        links[i].prev = i - 1;
+        links[i].next = i + 1;
+    }
+    if (num_points > 0) {
+        links[0].prev = closed ? num_points - 1 : -1;
+        links[num_points - 1].next = closed ? 0 : -1;
+    }
+}
+
+/**
+ * @struct KernelOps
+ * @brief Elimination kernels specialised for one storage type and metric
+ */
+typedef struct {
+    void (*initial_areas)(Workspace* ws, const Coords* coords, VertexIndex num_points);
+    void (*simplify_to)(Workspace* ws, const Coords* coords, VertexIndex target);
+    void (*simplify_to_area)(Workspace* ws, const Coords* coords, double threshold);
+    VertexIndex (*simplify_rank)(Workspace* ws, const Coords* coords, VertexIndex* order,
+                                 double* keys);
+} KernelOps;
+
+// Every metric gets its own copy of the loops, so the metric is inlined
+// into them and only selected once per call
+#define COORD_T double
+#define METRIC metric_area
+#define METRIC_BULK initial_triangle_areas
+#define KERNEL(name) name##_f64_area
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef METRIC_BULK
+#undef KERNEL
+
+#define COORD_T float
+#define METRIC metric_area
+#define METRIC_BULK initial_triangle_areas
+#define KERNEL(name) name##_f32_area
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef METRIC_BULK
+#undef KERNEL
+
+#define COORD_T double
+#define METRIC metric_flatness
+#define KERNEL(name) name##_f64_flatness
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef KERNEL
+
+#define COORD_T float
+#define METRIC metric_flatness
+#define KERNEL(name) name##_f32_flatness
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef KERNEL
+
+#define COORD_T double
+#define METRIC metric_convexity
+#define KERNEL(name) name##_f64_convexity
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef KERNEL
+
+#define COORD_T float
+#define METRIC metric_convexity
+#define KERNEL(name) name##_f32_convexity
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef KERNEL
+
+#define COORD_T double
+#define METRIC metric_signed
+#define KERNEL(name) name##_f64_signed
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef KERNEL
+
+#define COORD_T float
+#define METRIC metric_signed
+#define KERNEL(name) name##_f32_signed
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef KERNEL
+
+#define COORD_T double
+#define METRIC metric_area_3d
+#define METRIC_Z
+#define KERNEL(name) name##_f64_area3d
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef METRIC_Z
+#undef KERNEL
+
+#define COORD_T float
+#define METRIC metric_area_3d
+#define METRIC_Z
+#define KERNEL(name) name##_f32_area3d
+#include "simplify_kernel.h"
+#undef COORD_T
+#undef METRIC
+#undef METRIC_Z
+#undef KERNEL
+
+static const KernelOps* const KERNELS[NUM_METRICS][2] = {
+    {&ops_f64_area, &ops_f32_area},
+    {&ops_f64_flatness, &ops_f32_flatness},
+    {&ops_f64_convexity, &ops_f32_convexity},
+    {&ops_f64_signed, &ops_f32_signed},
+    {&ops_f64_area3d, &ops_f32_area3d},
+};
+
+/**
+ * @brief Kernels for the metric of a workspace and the storage type of a ring
+ */
+static inline const KernelOps* kernel_ops(const Workspace* ws, const Coords* coords) {
+    return KERNELS[ws->metric][coords->type == COORD_FLOAT32];
+}
+
+double ring_orientation(const Coords* coords, VertexIndex num_points) {
+    double sum = 0.0, origin[2], prev[2], curr[2];
+    if (num_points < 3)
+        return 1.0;
+
+    // Recentre on the first vertex so large projected coordinates do not
+    // swamp the area of a small ring; the edges at the origin then add 0
+    coords_point(coords, 0, origin);
+    prev[0] = 0.0;
+    prev[1] = 0.0;
+    for (VertexIndex i = 1; i < num_points; i++) {
+        coords_point(coords, i, curr);
+        curr[0] -= origin[0];
+        curr[1] -= origin[1];
+        sum += prev[0] * curr[1] - curr[0] * prev[1];
+        prev[0] = curr[0];
+        prev[1] = curr[1];
+    }
+    return sum >= 0.0 ? 1.0 : -1.0;
+}
+
+Workspace* workspace_create(VertexIndex capacity) {
+    Workspace* ws = (Workspace*)calloc(1, sizeof(Workspace));
+    if (!ws)
+        return NULL;
+
+    ws->heap = indexed_heap_create(capacity);
+    if (!ws->heap || workspace_reserve(ws, capacity) != 0) {
+        workspace_destroy(ws);
+        return NULL;
+    }
+    return ws;
+}
+
+void workspace_destroy(Workspace* ws) {
+    if (!ws)
+        return;
+    free(ws->links);
+    if (ws->heap)
+        indexed_heap_destroy(ws->heap);
+    segment_grid_destroy(ws->grid);
+    free(ws);
+}
+
+int workspace_reserve(Workspace* ws, VertexIndex num_points) {
+    if (num_points <= ws->capacity)
+        return 0;
+    if (num_points > MAX_RING_VERTICES)
+        return -1;
+
+    // Grow by at least half, so batches of growing rings reallocate rarely
+    VertexIndex capacity = num_points;
+    if (capacity - ws->capacity < ws->capacity / 2)
+        capacity = ws->capacity + ws->capacity / 2;
+    if (indexed_heap_reserve(ws->heap, capacity) != 0)
+        return -1;
+
+    VertexLink* links = malloc((size_t)capacity * sizeof(VertexLink));
+    if (!links)
+        return -1;
+    free(ws->links);
+    ws->links = links;
+    ws->capacity = capacity;
+    STATS_ADD(reallocs, 1);
+    return 0;
+}
+
+VertexIndex ring_vertex_count(const Coords* coords, VertexIndex num_points) {
+    if (num_points < 2)
+        return num_points;
+
+    double first[2], last[2];
+    if (coords->type == COORD_FLOAT32) {
+        first[0] = COORD_VALUE(coords, float, 0, 0);
+        first[1] = COORD_VALUE(coords, float, 0, 1);
+        last[0] = COORD_VALUE(coords, float, num_points - 1, 0);
+        last[1] = COORD_VALUE(coords, float, num_points - 1, 1);
+    } else {
+        first[0] = COORD_VALUE(coords, double, 0, 0);
+        first[1] = COORD_VALUE(coords, double, 0, 1);
+        last[0] = COORD_VALUE(coords, double, num_points - 1, 0);
+        last[1] = COORD_VALUE(coords, double, num_points - 1, 1);
+    }
+
+    if (first[0] == last[0] && first[1] == last[1])
+        return num_points - 1;  // Work with unclosed polygon
+    return num_points;
+}
+
+void simplify_begin(Workspace* ws, const Coords* coords, VertexIndex num_points, int closed) {
+    double orientation = ws->metric == METRIC_CONVEXITY || ws->metric == METRIC_SIGNED ?
+        ring_orientation(coords, num_points) : 1.0;
+    simplify_begin_oriented(ws, coords, num_points, closed, orientation);
+}
+
+void simplify_begin_oriented(Workspace* ws, const Coords* coords, VertexIndex num_points,
+                             int closed, double orientation) {
+    ws->heap->size = 0;
+    ws->active_count = num_points;
+    ws->closed = closed;
+    ws->safe = 0;
+    ws->orientation = orientation;
+
+    initialize_vertex_linkage(ws->links, num_points, closed);
+    kernel_ops(ws, coords)->initial_areas(ws, coords, num_points);
+}
+
+int simplify_guard_intersections(Workspace* ws, const Coords* coords) {
+    if (!ws->grid) {
+        ws->grid = segment_grid_create();
+        if (!ws->grid)
+            return -1;
+    }
+    if (segment_grid_build(ws->grid, coords, ws->links, ws->active_count) != 0)
+        return -1;
+    ws->safe = 1;
+    return 0;
+}
+
+void simplify_to(Workspace* ws, const Coords* coords, VertexIndex target) {
+    if (target < min_vertices(ws->closed))
+        target = min_vertices(ws->closed);
+
+    kernel_ops(ws, coords)->simplify_to(ws, coords, target);
+}
+
+void simplify_to_area(Workspace* ws, const Coords* coords, double threshold) {
+    kernel_ops(ws, coords)->simplify_to_area(ws, coords, threshold);
+}
+
+void simplify_rank(Workspace* ws, const Coords* coords, VertexIndex num_points, int closed,
+                   VertexIndex* order, double* order_areas) {
+    double orientation = ws->metric == METRIC_CONVEXITY || ws->metric == METRIC_SIGNED ?
+        ring_orientation(coords, num_points) : 1.0;
+    simplify_record(ws, coords, num_points, closed, orientation, order, order_areas);
+
+    // Effective areas never decrease along the elimination order, so a
+    // threshold keeps exactly a prefix of the surviving vertices
+    VertexIndex removed = num_points - min_vertices(closed);
+    double effective_area = -INFINITY;
+    for (VertexIndex rank = 0; rank < removed; rank++) {
+        if (order_areas[rank] > effective_area)
+            effective_area = order_areas[rank];
+        order_areas[rank] = effective_area;
+    }
+}
+
+void simplify_record(Workspace* ws, const Coords* coords, VertexIndex num_points, int closed,
+                     double orientation, VertexIndex* order, double* keys) {
+    simplify_begin_oriented(ws, coords, num_points, closed, orientation);
+
+    VertexIndex rank = kernel_ops(ws, coords)->simplify_rank(ws, coords, order, keys);
+
+    // The last min_vertices vertices are never removed
+    for (VertexIndex i = 0; i < num_points; i++) {
+        if (vertex_active(ws->links, i)) {
+            order[rank] = i;
+            keys[rank] = INFINITY;
+            rank++;
+        }
+    }
+}
+
+VertexIndex first_active_vertex(const Workspace* ws) {
+    VertexIndex curr_idx = 0;
+    while (!vertex_active(ws->links, curr_idx)) curr_idx++;
+    return curr_idx;
+}
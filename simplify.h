@@ -0,0 +1,232 @@
+/**
+ * @file simplify.h
+ * @brief Core Visvalingam-Whyatt elimination engine
+ *
+ * This header defines the interpreter-independent part of the algorithm:
+ * a reusable workspace holding the vertex links and the heap,
+ * and the steps used to run the elimination loop on a single ring. The
+ * Python bindings drive these steps for one or many rings.
+ */
+
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "min_heap.h"
+#include "geometry.h"
+#include "segment_grid.h"
+
+/**
+ * @struct Workspace
+ * @brief Scratch memory for simplifying one ring at a time
+ *
+ * The links and the heap are sized for the largest ring seen so far and
+ * are reused for every subsequent ring. The current effective area of a
+ * vertex lives only in the heap, so each removal touches the links and
+ * the heap and nothing else.
+ *
+ * @param links        Neighbours and removal state of every vertex
+ * @param heap         Indexed heap holding one entry per removable active vertex
+ * @param capacity     Number of vertices the arrays can hold
+ * @param active_count Number of vertices still present in the current ring
+ * @param closed       Nonzero for a ring, zero for an open line
+ * @param grid         Segment index of the intersection-safe mode, created on first use
+ * @param safe         Nonzero while removals are checked against grid
+ * @param metric       Effective area used to rank vertices, METRIC_AREA by default
+ * @param orientation  +1 for a counterclockwise ring, -1 for a clockwise one
+ */
+typedef struct {
+    VertexLink* links;
+    IndexedMinHeap* heap;
+    VertexIndex capacity;
+    VertexIndex active_count;
+    int closed;
+    SegmentGrid* grid;
+    int safe;
+    AreaMetric metric;
+    double orientation;
+} Workspace;
+
+/**
+ * @brief Fewest vertices a ring (3) or an open line (2) is reduced to
+ *
+ * @param closed Nonzero for a ring, zero for an open line
+ * @return int Minimum number of vertices kept
+ */
+static inline int min_vertices(int closed) {
+    return closed ? 3 : 2;
+}
+
+/**
+ * @brief Create a workspace able to hold rings of the given size
+ *
+ * @param capacity Initial number of vertices to allocate for
+ * @return Workspace* Pointer to the new workspace or NULL on failure
+ */
+Workspace* workspace_create(VertexIndex capacity);
+
+/**
+ * @brief Free all memory associated with the workspace
+ *
+ * @param ws Workspace to destroy (may be NULL)
+ */
+void workspace_destroy(Workspace* ws);
+
+/**
+ * @brief Grow the workspace so it can hold a ring of num_points vertices
+ *
+ * Existing buffers are kept when they are already large enough; otherwise
+ * they are replaced, by at least half again their size, and their
+ * contents are lost.
+ *
+ * @param ws         Target workspace
+ * @param num_points Required number of vertices
+ * @return int 0 on success, -1 if memory could not be allocated or
+ *         num_points exceeds MAX_RING_VERTICES
+ */
+int workspace_reserve(Workspace* ws, VertexIndex num_points);
+
+/**
+ * @brief Orientation of a ring or of a line closed by its endpoints
+ *
+ * @param coords     Ring (unclosed) or line coordinates
+ * @param num_points Number of vertices
+ * @return double +1 if the signed area is non-negative, -1 otherwise
+ */
+double ring_orientation(const Coords* coords, VertexIndex num_points);
+
+/**
+ * @brief Number of distinct vertices in a ring
+ *
+ * Returns num_points minus one when the last point repeats the first,
+ * i.e. when the ring is explicitly closed.
+ *
+ * @param coords     Ring coordinates
+ * @param num_points Number of points in coords
+ * @return VertexIndex Number of vertices to simplify
+ */
+VertexIndex ring_vertex_count(const Coords* coords, VertexIndex num_points);
+
+/**
+ * @brief Prepare the workspace for simplifying a new ring or line
+ *
+ * Links the vertices into a circular list for a ring, or a list ending at
+ * -1 on both sides for an open line, computes the initial effective areas
+ * and fills the heap. The endpoints of an open line are pinned: they never
+ * enter the heap and are never removed. Areas follow ws->metric, which
+ * callers may set at any time before this call. The workspace must have
+ * been reserved for at least num_points vertices.
+ *
+ * @param ws         Target workspace
+ * @param coords     Ring (unclosed) or line coordinates
+ * @param num_points Number of vertices
+ * @param closed     Nonzero for a ring, zero for an open line
+ */
+void simplify_begin(Workspace* ws, const Coords* coords, VertexIndex num_points, int closed);
+
+/**
+ * @brief Prepare the workspace like simplify_begin, with a given orientation
+ *
+ * For pieces of a larger ring, whose oriented metrics must judge concavity
+ * against the whole ring rather than against the piece itself.
+ *
+ * @param ws          Target workspace
+ * @param coords      Ring (unclosed) or line coordinates
+ * @param num_points  Number of vertices
+ * @param closed      Nonzero for a ring, zero for an open line
+ * @param orientation Orientation used by oriented metrics (+1 or -1)
+ */
+void simplify_begin_oriented(Workspace* ws, const Coords* coords, VertexIndex num_points,
+                             int closed, double orientation);
+
+/**
+ * @brief Refuse removals that would make the ring intersect itself
+ *
+ * Indexes the segments of the ring prepared by simplify_begin. Until the
+ * next simplify_begin, simplify_to and simplify_to_area then skip every
+ * vertex whose bridging segment would cross or touch another segment of
+ * the ring. A skipped vertex leaves the heap and re-enters it when one of
+ * its neighbours is removed, so the ring may keep more vertices than
+ * requested. Rings that are simple on input stay simple.
+ *
+ * @param ws     Workspace prepared by simplify_begin
+ * @param coords Ring coordinates passed to simplify_begin
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int simplify_guard_intersections(Workspace* ws, const Coords* coords);
+
+/**
+ * @brief Remove vertices until at most target vertices remain
+ *
+ * Can be called repeatedly with decreasing targets to produce several
+ * resolutions from a single elimination pass. Stops early, leaving more
+ * than target vertices, when simplify_guard_intersections refuses every
+ * remaining removal.
+ *
+ * @param ws     Workspace prepared by simplify_begin
+ * @param coords Ring coordinates passed to simplify_begin
+ * @param target Number of vertices to keep (at least min_vertices)
+ */
+void simplify_to(Workspace* ws, const Coords* coords, VertexIndex target);
+
+/**
+ * @brief Remove vertices while the smallest effective area is within a threshold
+ *
+ * Stops once the smallest area in the heap exceeds threshold or only
+ * min_vertices vertices remain. Can be called repeatedly with increasing thresholds; the
+ * number of vertices left is available in ws->active_count.
+ *
+ * @param ws        Workspace prepared by simplify_begin
+ * @param coords    Ring coordinates passed to simplify_begin
+ * @param threshold Largest effective area to remove
+ */
+void simplify_to_area(Workspace* ws, const Coords* coords, double threshold);
+
+/**
+ * @brief Run the elimination to completion and record the removal order
+ *
+ * Fills order with the vertices in the order they are removed, followed by
+ * the min_vertices vertices that are never removed, and order_areas with
+ * the effective area of every removal. The effective area is the largest
+ * area removed so far, so order_areas is non-decreasing; the remaining
+ * vertices get an infinite area. Keeping the last k entries of order
+ * gives the same ring as simplify_to with a target of k.
+ *
+ * @param ws          Workspace reserved for at least num_points vertices
+ * @param coords      Ring (unclosed) or line coordinates
+ * @param num_points  Number of vertices (at least min_vertices)
+ * @param closed      Nonzero for a ring, zero for an open line
+ * @param order       Receives num_points vertex indices by removal rank
+ * @param order_areas Receives num_points effective areas by removal rank
+ */
+void simplify_rank(Workspace* ws, const Coords* coords, VertexIndex num_points, int closed,
+                   VertexIndex* order, double* order_areas);
+
+/**
+ * @brief Run the elimination to completion and record every raw removal key
+ *
+ * Like simplify_rank, but keys receives the area each vertex had when it
+ * was removed rather than the running maximum, and oriented metrics use
+ * the given orientation. Records of pieces of a ring that are split at
+ * pinned vertices can be merged by key into the order a single heap over
+ * the whole ring would remove them in.
+ *
+ * @param ws          Workspace reserved for at least num_points vertices
+ * @param coords      Ring (unclosed) or line coordinates
+ * @param num_points  Number of vertices (at least min_vertices)
+ * @param closed      Nonzero for a ring, zero for an open line
+ * @param orientation Orientation used by oriented metrics (+1 or -1)
+ * @param order       Receives num_points vertex indices by removal rank
+ * @param keys        Receives num_points removal keys, infinite for survivors
+ */
+void simplify_record(Workspace* ws, const Coords* coords, VertexIndex num_points, int closed,
+                     double orientation, VertexIndex* order, double* keys);
+
+/**
+ * @brief Index of the first vertex still present in the ring
+ *
+ * @param ws Workspace prepared by simplify_begin
+ * @return VertexIndex Lowest active vertex index
+ */
+VertexIndex first_active_vertex(const Workspace* ws);
+
+#endif /* SIMPLIFY_H */
@@ -0,0 +1,173 @@
+/**
+ * @file simplify_kernel.h
+ * @brief Elimination kernels specialised for one coordinate storage type
+ *
+ * This file is included by simplify.c once per storage type and metric,
+ * with COORD_T set to the value type, METRIC to one of the metric_*
+ * functions of geometry.h and KERNEL(name) producing a unique function
+ * name, so the hot loop never branches on either. METRIC_Z makes the
+ * metric see the z column as well.
+ */
+
+/**
+ * @brief Effective area of vertex idx between prev_idx and next_idx
+ */
+static inline double KERNEL(vertex_area)(const Workspace* ws, const Coords* coords,
+                                         VertexIndex prev_idx, VertexIndex idx,
+                                         VertexIndex next_idx) {
+#ifdef METRIC_Z
+    double p1[3] = {COORD_VALUE(coords, COORD_T, prev_idx, 0),
+                    COORD_VALUE(coords, COORD_T, prev_idx, 1),
+                    COORD_VALUE(coords, COORD_T, prev_idx, 2)};
+    double p2[3] = {COORD_VALUE(coords, COORD_T, idx, 0),
+                    COORD_VALUE(coords, COORD_T, idx, 1),
+                    COORD_VALUE(coords, COORD_T, idx, 2)};
+    double p3[3] = {COORD_VALUE(coords, COORD_T, next_idx, 0),
+                    COORD_VALUE(coords, COORD_T, next_idx, 1),
+                    COORD_VALUE(coords, COORD_T, next_idx, 2)};
+#else
+    double p1[2] = {COORD_VALUE(coords, COORD_T, prev_idx, 0),
+                    COORD_VALUE(coords, COORD_T, prev_idx, 1)};
+    double p2[2] = {COORD_VALUE(coords, COORD_T, idx, 0),
+                    COORD_VALUE(coords, COORD_T, idx, 1)};
+    double p3[2] = {COORD_VALUE(coords, COORD_T, next_idx, 0),
+                    COORD_VALUE(coords, COORD_T, next_idx, 1)};
+#endif
+    return METRIC(p1, p2, p3, ws->orientation);
+}
+
+/**
+ * @brief Calculate initial effective areas for all vertices
+ *
+ * Computes the initial triangle areas for each vertex straight into the
+ * heap, where vertex first + k sits at position k, and builds the heap
+ * from them in one pass. The endpoints of an open line stay out of the
+ * heap. Kernels with METRIC_BULK defined hand the interior vertices, whose
+ * neighbours are still i - 1 and i + 1, to that function.
+ *
+ * @param ws Workspace with linked vertices
+ * @param coords Input polygon points
+ * @param num_points Number of vertices
+ */
+static void KERNEL(calculate_initial_areas)(Workspace* ws, const Coords* coords,
+                                            VertexIndex num_points) {
+    double* areas = ws->heap->areas;
+    VertexIndex first = 0, last = num_points;
+    if (!ws->closed && num_points > 0) {
+        first = 1;
+        last = num_points - 1;
+    }
+
+#ifdef METRIC_BULK
+    if (num_points >= 3) {
+        METRIC_BULK(coords, 1, num_points - 1, areas + 1 - first);
+        if (ws->closed) {
+            areas[0] = KERNEL(vertex_area)(ws, coords, num_points - 1, 0, 1);
+            areas[num_points - 1] = KERNEL(vertex_area)(ws, coords, num_points - 2,
+                                                        num_points - 1, 0);
+        }
+        indexed_heap_build(ws->heap, first, last - first);
+        return;
+    }
+#endif
+
+    for (VertexIndex i = first; i < last; i++)
+        areas[i - first] = KERNEL(vertex_area)(ws, coords, ws->links[i].prev, i,
+                                               ws->links[i].next);
+    indexed_heap_build(ws->heap, first, last - first);
+}
+
+/**
+ * @brief Whether the safe mode allows removing a vertex
+ */
+static inline int KERNEL(removal_allowed)(const Workspace* ws, const Coords* coords,
+                                          VertexIndex vertex_idx) {
+    return !ws->safe || segment_grid_can_remove(ws->grid, coords, ws->links, vertex_idx);
+}
+
+/**
+ * @brief Unlink a vertex and refresh the areas of its neighbours
+ *
+ * @param ws         Workspace prepared by simplify_begin
+ * @param coords     Ring coordinates passed to simplify_begin
+ * @param vertex_idx Vertex just popped from the heap
+ */
+static inline void KERNEL(remove_vertex)(Workspace* ws, const Coords* coords,
+                                         VertexIndex vertex_idx) {
+    VertexLink* links = ws->links;
+
+    // Update links, then mark the vertex removed
+    VertexIndex prev_idx = links[vertex_idx].prev;
+    VertexIndex next_idx = links[vertex_idx].next;
+    links[prev_idx].next = next_idx;
+    links[next_idx].prev = prev_idx;
+    links[vertex_idx].next = VERTEX_REMOVED;
+    ws->active_count--;
+    if (ws->safe)
+        segment_grid_insert(ws->grid, coords, prev_idx, next_idx);
+
+    // Update areas of adjacent vertices; pinned line endpoints keep theirs
+    for (int adj_idx = 0; adj_idx < 2; adj_idx++) {
+        VertexIndex idx = adj_idx == 0 ? prev_idx : next_idx;
+        VertexLink link = links[idx];
+        if (link.prev >= 0 && link.next >= 0) {
+            double new_area = KERNEL(vertex_area)(ws, coords, link.prev, idx, link.next);
+            // Vertices refused by the safe mode are out of the heap
+            if (ws->safe && ws->heap->positions[idx] < 0)
+                indexed_heap_push(ws->heap, new_area, idx);
+            else
+                indexed_heap_update(ws->heap, idx, new_area);
+        }
+    }
+}
+
+static void KERNEL(simplify_to)(Workspace* ws, const Coords* coords, VertexIndex target) {
+    // Simplify until we reach target resolution
+    while (ws->active_count > target && ws->heap->size > 0) {
+        HeapItem min_item = indexed_heap_pop(ws->heap);
+        if (!KERNEL(removal_allowed)(ws, coords, min_item.index)) {
+            STATS_ADD(safe_refusals, 1);
+            continue;
+        }
+        KERNEL(remove_vertex)(ws, coords, min_item.index);
+    }
+}
+
+static void KERNEL(simplify_to_area)(Workspace* ws, const Coords* coords, double threshold) {
+    // Stop as soon as the smallest remaining area exceeds the threshold
+    int min_count = min_vertices(ws->closed);
+    while (ws->active_count > min_count && ws->heap->size > 0 &&
+           ws->heap->areas[0] <= threshold) {
+        HeapItem min_item = indexed_heap_pop(ws->heap);
+        if (!KERNEL(removal_allowed)(ws, coords, min_item.index)) {
+            STATS_ADD(safe_refusals, 1);
+            continue;
+        }
+        KERNEL(remove_vertex)(ws, coords, min_item.index);
+    }
+}
+
+static VertexIndex KERNEL(simplify_rank)(Workspace* ws, const Coords* coords,
+                                         VertexIndex* order, double* keys) {
+    int min_count = min_vertices(ws->closed);
+    VertexIndex rank = 0;
+
+    // Record the key each vertex is popped with; callers derive the
+    // effective areas from these
+    while (ws->active_count > min_count) {
+        HeapItem min_item = indexed_heap_pop(ws->heap);
+        order[rank] = min_item.index;
+        keys[rank] = min_item.area;
+        rank++;
+
+        KERNEL(remove_vertex)(ws, coords, min_item.index);
+    }
+    return rank;
+}
+
+static const KernelOps KERNEL(ops) = {
+    KERNEL(calculate_initial_areas),
+    KERNEL(simplify_to),
+    KERNEL(simplify_to_area),
+    KERNEL(simplify_rank),
+};
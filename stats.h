@@ -0,0 +1,85 @@
+/**
+ * @file stats.h
+ * @brief Optional counters of the elimination hot path
+ *
+ * This header defines per-thread counters of heap traffic, buffer growth
+ * and the time spent in each phase of a call. They are compiled in only
+ * when SIMPLIFY_STATS is defined; otherwise every STATS_* macro expands
+ * to nothing, so the default build pays nothing for them. Each thread
+ * counts into its own record, so batch workers never contend on them.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Seconds elapsed on a monotonic clock, for timing phases
+ *
+ * @return double Seconds since an arbitrary fixed point
+ */
+double stats_now(void);
+
+#ifdef SIMPLIFY_STATS
+
+/**
+ * @struct SimplifyStats
+ * @brief Counters accumulated by the calling thread
+ *
+ * @param heap_pushes      Vertices pushed onto a heap, one per vertex of a bulk build
+ * @param heap_pops        Entries popped from a heap
+ * @param heap_updates     Areas changed in place in the indexed heap
+ * @param safe_refusals    Popped vertices that safe mode refused to remove
+ * @param peak_heap_size   Largest number of entries held by a heap
+ * @param reallocs         Working buffers allocated or grown
+ * @param init_seconds     Time spent linking vertices, computing initial
+ *                         areas and building the heap
+ * @param simplify_seconds Time spent in the elimination loop
+ * @param extract_seconds  Time spent writing results
+ */
+typedef struct {
+    int64_t heap_pushes;
+    int64_t heap_pops;
+    int64_t heap_updates;
+    int64_t safe_refusals;
+    int64_t peak_heap_size;
+    int64_t reallocs;
+    double init_seconds;
+    double simplify_seconds;
+    double extract_seconds;
+} SimplifyStats;
+
+#ifdef _MSC_VER
+#define STATS_THREAD_LOCAL __declspec(thread)
+#else
+#define STATS_THREAD_LOCAL _Thread_local
+#endif
+
+/** Counters of the calling thread */
+extern STATS_THREAD_LOCAL SimplifyStats simplify_stats;
+
+/**
+ * @brief Zero the counters of the calling thread
+ */
+void stats_reset(void);
+
+#define STATS_ADD(field, n) (simplify_stats.field += (n))
+#define STATS_MAX(field, value)                         \
+    do {                                                \
+        if ((int64_t)(value) > simplify_stats.field)    \
+            simplify_stats.field = (int64_t)(value);    \
+    } while (0)
+#define STATS_TIMER(name) double name = stats_now()
+#define STATS_ELAPSED(field, name) (simplify_stats.field += stats_now() - (name))
+
+#else
+
+#define STATS_ADD(field, n) ((void)0)
+#define STATS_MAX(field, value) ((void)0)
+#define STATS_TIMER(name) ((void)0)
+#define STATS_ELAPSED(field, name) ((void)0)
+
+#endif /* SIMPLIFY_STATS */
+
+#endif /* STATS_H */
@@ -0,0 +1,249 @@
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include "stream.h"
+#include "simplify.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @def STREAM_CHUNK
+ * @brief Points buffered per write to the output file
+ */
+#define STREAM_CHUNK 4096
+
+#ifdef _WIN32
+
+int mapped_file_open(MappedFile* file, const char* path) {
+    file->data = NULL;
+    file->size = 0;
+    file->mapping = NULL;
+
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        errno = GetLastError() == ERROR_FILE_NOT_FOUND ? ENOENT : EACCES;
+        return -1;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        errno = EIO;
+        return -1;
+    }
+    file->size = size.QuadPart;
+    if (file->size == 0) {
+        CloseHandle(handle);
+        return 0;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle);
+    if (!mapping) {
+        errno = ENOMEM;
+        return -1;
+    }
+    file->data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!file->data) {
+        CloseHandle(mapping);
+        errno = ENOMEM;
+        return -1;
+    }
+    file->mapping = mapping;
+    return 0;
+}
+
+void mapped_file_close(MappedFile* file) {
+    if (file->data)
+        UnmapViewOfFile(file->data);
+    if (file->mapping)
+        CloseHandle((HANDLE)file->mapping);
+    file->data = NULL;
+    file->mapping = NULL;
+}
+
+static int seek_output(FILE* out, int64_t offset) {
+    return _fseeki64(out, offset, SEEK_SET);
+}
+
+/**
+ * @brief Volume and file index of a path, 0 if it cannot be opened
+ */
+static int file_identity(const char* path, BY_HANDLE_FILE_INFORMATION* info) {
+    HANDLE handle = CreateFileA(path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (handle == INVALID_HANDLE_VALUE)
+        return 0;
+    int found = GetFileInformationByHandle(handle, info) != 0;
+    CloseHandle(handle);
+    return found;
+}
+
+int same_file(const char* path, const char* other_path) {
+    BY_HANDLE_FILE_INFORMATION a, b;
+    return file_identity(path, &a) && file_identity(other_path, &b) &&
+           a.dwVolumeSerialNumber == b.dwVolumeSerialNumber &&
+           a.nFileIndexHigh == b.nFileIndexHigh && a.nFileIndexLow == b.nFileIndexLow;
+}
+
+#else
+
+int mapped_file_open(MappedFile* file, const char* path) {
+    file->data = NULL;
+    file->size = 0;
+    file->mapping = NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return -1;
+    }
+    file->size = (int64_t)info.st_size;
+    if (file->size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void* data = mmap(NULL, (size_t)file->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return -1;
+    file->data = (const char*)data;
+    return 0;
+}
+
+void mapped_file_close(MappedFile* file) {
+    if (file->data)
+        munmap((void*)file->data, (size_t)file->size);
+    file->data = NULL;
+}
+
+static int seek_output(FILE* out, int64_t offset) {
+    return fseeko(out, (off_t)offset, SEEK_SET);
+}
+
+int same_file(const char* path, const char* other_path) {
+    struct stat a, b;
+    return stat(path, &a) == 0 && stat(other_path, &b) == 0 && a.st_dev == b.st_dev &&
+           a.st_ino == b.st_ino;
+}
+
+#endif
+
+/**
+ * @def WRITE_LOOP
+ * @brief Body of write_ring for one storage type
+ *
+ * Follows the links from first when they are given, otherwise takes the
+ * vertices in order, and flushes the buffer every STREAM_CHUNK points.
+ */
+#define WRITE_LOOP(COORD_T)                                                     \
+    do {                                                                        \
+        COORD_T buffer[2 * STREAM_CHUNK];                                       \
+        VertexIndex idx = first, filled = 0;                                    \
+        for (VertexIndex i = 0; i < count; i++) {                               \
+            buffer[2 * filled] = COORD_VALUE(coords, COORD_T, idx, 0);          \
+            buffer[2 * filled + 1] = COORD_VALUE(coords, COORD_T, idx, 1);      \
+            idx = links ? links[idx].next : idx + 1;                            \
+            if (++filled == STREAM_CHUNK) {                                     \
+                if (fwrite(buffer, 2 * sizeof(COORD_T), STREAM_CHUNK, out) !=   \
+                    STREAM_CHUNK)                                               \
+                    return -1;                                                  \
+                filled = 0;                                                     \
+            }                                                                   \
+        }                                                                       \
+        if (filled > 0 &&                                                       \
+            fwrite(buffer, 2 * sizeof(COORD_T), (size_t)filled, out) !=         \
+            (size_t)filled)                                                     \
+            return -1;                                                          \
+        if (closed && count > 0) {                                              \
+            COORD_T closure[2] = {COORD_VALUE(coords, COORD_T, first, 0),       \
+                                  COORD_VALUE(coords, COORD_T, first, 1)};      \
+            if (fwrite(closure, 2 * sizeof(COORD_T), 1, out) != 1)              \
+                return -1;                                                      \
+        }                                                                       \
+    } while (0)
+
+/**
+ * @brief Write count vertices of a ring, starting at first, to a file
+ *
+ * @param out    Output file positioned where the ring goes
+ * @param coords Source points view
+ * @param links  Links of the working ring, or NULL to write vertices in order
+ * @param first  First vertex to write
+ * @param count  Number of vertices to write
+ * @param closed Nonzero to append a closure point
+ * @return int 0 on success, -1 if writing failed
+ */
+static int write_ring(FILE* out, const Coords* coords, const VertexLink* links,
+                      VertexIndex first, VertexIndex count, int closed) {
+    if (coords->type == COORD_FLOAT32)
+        WRITE_LOOP(float);
+    else
+        WRITE_LOOP(double);
+    return 0;
+}
+
+int stream_simplify(const Coords* coords, VertexIndex num_points, int closed,
+                    AreaMetric metric, const int* resolutions, const int* order,
+                    int num_resolutions, FILE* out, int64_t* out_offsets) {
+    int64_t point_size = 2 * (int64_t)coord_size(coords->type);
+
+    // Results go in input order, so lay out every block before simplifying
+    out_offsets[0] = 0;
+    for (int j = 0; j < num_resolutions; j++) {
+        VertexIndex target = resolutions[j] < num_points ? resolutions[j] : num_points;
+        out_offsets[j + 1] = out_offsets[j] + (target > 0 ? target + (closed ? 1 : 0) : 0);
+    }
+
+    Workspace* ws = NULL;
+    int status = 0;
+    for (int k = 0; k < num_resolutions && status == 0; k++) {
+        int j = order[k];
+        if (seek_output(out, out_offsets[j] * point_size) != 0) {
+            status = -2;
+            break;
+        }
+
+        if (resolutions[j] >= num_points) {
+            status = write_ring(out, coords, NULL, 0, num_points, closed) != 0 ? -2 : 0;
+            continue;
+        }
+
+        if (!ws) {
+            ws = workspace_create(num_points);
+            if (!ws) {
+                status = -1;
+                break;
+            }
+            ws->metric = metric;
+            simplify_begin(ws, coords, num_points, closed);
+        }
+        simplify_to(ws, coords, resolutions[j]);
+        if (write_ring(out, coords, ws->links, first_active_vertex(ws), ws->active_count,
+                       closed) != 0)
+            status = -2;
+    }
+
+    workspace_destroy(ws);
+    if (status == 0 && fflush(out) != 0)
+        status = -2;
+    return status;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file stream.h
+ * @brief Out-of-core simplification of a ring stored in a raw file
+ *
+ * This header defines a read-only memory mapping of a coordinate file and
+ * a driver that simplifies the ring it holds to several resolutions,
+ * writing every result straight to an output file. The coordinates are
+ * read in place from the mapping, so they stay in the page cache instead
+ * of the process heap, and the results are streamed out in small chunks;
+ * only the workspace grows with the ring.
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "geometry.h"
+
+/**
+ * @struct MappedFile
+ * @brief Read-only mapping of a whole file
+ *
+ * @param data    First byte of the file, NULL for an empty file
+ * @param size    Size of the file in bytes
+ * @param mapping Platform handle of the mapping, unused on POSIX
+ */
+typedef struct {
+    const char* data;
+    int64_t size;
+    void* mapping;
+} MappedFile;
+
+/**
+ * @brief Map a file read-only
+ *
+ * @param file Receives the mapping
+ * @param path Path of the file
+ * @return int 0 on success, -1 with errno set otherwise
+ */
+int mapped_file_open(MappedFile* file, const char* path);
+
+/**
+ * @brief Unmap a file mapped by mapped_file_open
+ *
+ * @param file Mapping to release
+ */
+void mapped_file_close(MappedFile* file);
+
+/**
+ * @brief Whether two paths name the same file
+ *
+ * Compares device and inode, or volume and file index on Windows, so hard
+ * links and different spellings of a path are recognised.
+ *
+ * @param path       Path of an existing file
+ * @param other_path Path that may not exist
+ * @return int 1 if both name the same existing file, 0 otherwise
+ */
+int same_file(const char* path, const char* other_path);
+
+/**
+ * @brief Simplify one ring or line to several resolutions into a file
+ *
+ * Runs a single elimination pass, highest resolution first, and writes
+ * every result as interleaved x,y pairs of the input storage type,
+ * followed by a closure point for rings. Resolution j is written after
+ * the points of the resolutions before it in input order; resolutions
+ * of at least num_points copy the ring unchanged. The workspace is
+ * allocated for this call only and freed before returning.
+ *
+ * @param coords          Ring (unclosed) or line coordinates
+ * @param num_points      Number of vertices (at least min_vertices)
+ * @param closed          Nonzero for a ring, zero for an open line
+ * @param metric          Effective area used to rank vertices
+ * @param resolutions     Target resolutions, each at least min_vertices
+ * @param order           Resolution indices sorted by descending resolution
+ * @param num_resolutions Number of resolutions
+ * @param out             Output file opened for binary writing, seekable
+ * @param out_offsets     Receives num_resolutions + 1 point offsets into out
+ * @return int 0 on success, -1 if memory could not be allocated, -2 with
+ *         errno set if writing to out failed
+ */
+int stream_simplify(const Coords* coords, VertexIndex num_points, int closed,
+                    AreaMetric metric, const int* resolutions, const int* order,
+                    int num_resolutions, FILE* out, int64_t* out_offsets);
+
+#endif /* STREAM_H */
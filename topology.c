@@ -0,0 +1,337 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "topology.h"
+#include "simplify.h"
+#include "scratch.h"
+
+/**
+ * @brief Finalizer of the splitmix64 generator, used as an integer hash
+ */
+static uint64_t mix_bits(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Hash of a point that agrees with exact coordinate equality
+ */
+static uint64_t point_hash(const double point[2]) {
+    // Adding zero folds -0.0 into 0.0, which compare equal
+    double x = point[0] + 0.0;
+    double y = point[1] + 0.0;
+    uint64_t bits_x, bits_y;
+    memcpy(&bits_x, &x, sizeof(bits_x));
+    memcpy(&bits_y, &y, sizeof(bits_y));
+    return mix_bits(bits_x ^ mix_bits(bits_y));
+}
+
+/**
+ * @brief Power-of-two open addressing table size for count keys
+ */
+static int64_t table_capacity(int64_t count) {
+    int64_t capacity = 16;
+    while (capacity < 2 * count)
+        capacity <<= 1;
+    return capacity;
+}
+
+/**
+ * @brief Give every distinct point one id, shared by all its occurrences
+ *
+ * @return int64_t Number of distinct points, -1 if memory could not be allocated
+ */
+static int64_t assign_point_ids(const Coords* coords, const int64_t* offsets,
+                                const VertexIndex* ring_vertices, int64_t num_rings,
+                                int64_t* point_ids) {
+    int64_t capacity = table_capacity(offsets[num_rings]);
+    int64_t mask = capacity - 1;
+    int64_t* slots = malloc(capacity * sizeof(int64_t));
+    if (!slots)
+        return -1;
+    memset(slots, 0xff, capacity * sizeof(int64_t));  // -1 marks an empty slot
+
+    int64_t num_points = 0;
+    for (int64_t r = 0; r < num_rings; r++) {
+        for (VertexIndex i = 0; i < ring_vertices[r]; i++) {
+            int64_t v = offsets[r] + i;
+            double point[2], other[2];
+            coords_point(coords, v, point);
+
+            int64_t slot = (int64_t)(point_hash(point) & (uint64_t)mask);
+            for (;;) {
+                if (slots[slot] < 0) {
+                    slots[slot] = v;
+                    point_ids[v] = num_points++;
+                    break;
+                }
+                coords_point(coords, slots[slot], other);
+                if (point[0] == other[0] && point[1] == other[1]) {
+                    point_ids[v] = point_ids[slots[slot]];
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+    }
+
+    free(slots);
+    return num_points;
+}
+
+/**
+ * @brief Mark the points whose neighbours differ between occurrences
+ *
+ * Also pins every point of rings too small to simplify, and adds pinned
+ * points to rings with fewer than three junctions so every arc has two
+ * distinct pinned ends and no ring can collapse.
+ *
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+static int find_junctions(const int64_t* offsets, const VertexIndex* ring_vertices,
+                          int64_t num_rings, const int64_t* point_ids,
+                          int64_t num_points, char* junction) {
+    int64_t* pair_lo = malloc((num_points > 0 ? num_points : 1) * sizeof(int64_t));
+    int64_t* pair_hi = malloc((num_points > 0 ? num_points : 1) * sizeof(int64_t));
+    if (!pair_lo || !pair_hi) {
+        free(pair_lo);
+        free(pair_hi);
+        return -1;
+    }
+    memset(pair_lo, 0xff, num_points * sizeof(int64_t));
+
+    for (int64_t r = 0; r < num_rings; r++) {
+        const int64_t* ids = point_ids + offsets[r];
+        VertexIndex n = ring_vertices[r];
+
+        for (VertexIndex i = 0; i < n; i++) {
+            if (n < 3) {
+                junction[ids[i]] = 1;
+                continue;
+            }
+            int64_t a = ids[(i - 1 + n) % n];
+            int64_t b = ids[(i + 1) % n];
+            int64_t lo = a < b ? a : b;
+            int64_t hi = a < b ? b : a;
+            int64_t id = ids[i];
+
+            if (pair_lo[id] < 0) {
+                pair_lo[id] = lo;
+                pair_hi[id] = hi;
+            } else if (pair_lo[id] != lo || pair_hi[id] != hi) {
+                junction[id] = 1;
+            }
+        }
+    }
+    free(pair_lo);
+    free(pair_hi);
+
+    for (int64_t r = 0; r < num_rings; r++) {
+        const int64_t* ids = point_ids + offsets[r];
+        VertexIndex n = ring_vertices[r];
+        if (n < 3)
+            continue;
+
+        VertexIndex first = -1, count = 0;
+        for (VertexIndex i = 0; i < n; i++) {
+            if (junction[ids[i]]) {
+                if (first < 0)
+                    first = i;
+                count++;
+            }
+        }
+        if (count < 3) {
+            if (first < 0)
+                first = 0;
+            junction[ids[first]] = 1;
+            junction[ids[(first + n / 3) % n]] = 1;
+            junction[ids[(first + 2 * n / 3) % n]] = 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Insert an arc key into the set of arcs already simplified
+ *
+ * @return int 1 if the key was new, 0 if it was already present
+ */
+static int arc_set_insert(int64_t* keys, int64_t mask, int64_t lo, int64_t hi) {
+    int64_t slot = (int64_t)(mix_bits((uint64_t)lo ^ mix_bits((uint64_t)hi)) & (uint64_t)mask);
+    while (keys[2 * slot] >= 0) {
+        if (keys[2 * slot] == lo && keys[2 * slot + 1] == hi)
+            return 0;
+        slot = (slot + 1) & mask;
+    }
+    keys[2 * slot] = lo;
+    keys[2 * slot + 1] = hi;
+    return 1;
+}
+
+int coverage_vertex_areas(const Coords* coords, const int64_t* offsets,
+                          const VertexIndex* ring_vertices, int64_t num_rings,
+                          double* vertex_areas, CoverageStats* stats) {
+    int64_t total = offsets[num_rings];
+    VertexIndex max_ring = 0;
+    for (int64_t r = 0; r < num_rings; r++)
+        if (ring_vertices[r] > max_ring)
+            max_ring = ring_vertices[r];
+
+    int status = -1;
+    int64_t num_points = 0, num_arcs = 0, unique_arcs = 0;
+    int64_t arc_capacity = table_capacity(total);
+    int64_t* point_ids = malloc((total > 0 ? total : 1) * sizeof(int64_t));
+    int64_t* arc_keys = malloc(2 * arc_capacity * sizeof(int64_t));
+    int64_t* arc = malloc((max_ring + 1) * sizeof(int64_t));
+    double* arc_points = malloc(2 * (size_t)(max_ring + 1) * sizeof(double));
+    VertexIndex* order = malloc((size_t)(max_ring + 1) * sizeof(VertexIndex));
+    double* order_areas = malloc((max_ring + 1) * sizeof(double));
+    Workspace* ws = scratch_acquire(max_ring + 1);
+    char* junction = NULL;
+    double* point_areas = NULL;
+
+    if (!point_ids || !arc_keys || !arc || !arc_points || !order || !order_areas || !ws)
+        goto cleanup;
+
+    num_points = assign_point_ids(coords, offsets, ring_vertices, num_rings, point_ids);
+    if (num_points < 0)
+        goto cleanup;
+
+    junction = calloc(num_points > 0 ? num_points : 1, sizeof(char));
+    point_areas = malloc((num_points > 0 ? num_points : 1) * sizeof(double));
+    if (!junction || !point_areas ||
+        find_junctions(offsets, ring_vertices, num_rings, point_ids, num_points, junction) != 0)
+        goto cleanup;
+
+    for (int64_t p = 0; p < num_points; p++)
+        point_areas[p] = INFINITY;
+    memset(arc_keys, 0xff, 2 * arc_capacity * sizeof(int64_t));
+
+    // Walk every ring from junction to junction and simplify each arc once
+    for (int64_t r = 0; r < num_rings; r++) {
+        const int64_t* ids = point_ids + offsets[r];
+        VertexIndex n = ring_vertices[r];
+        if (n < 3)
+            continue;
+
+        VertexIndex start = 0;
+        while (!junction[ids[start]])
+            start++;
+
+        VertexIndex s = start;
+        do {
+            VertexIndex len = 1, i = s;
+            arc[0] = s;
+            do {
+                i = (i + 1) % n;
+                arc[len++] = i;
+            } while (!junction[ids[i]]);
+            num_arcs++;
+
+            // Shared arcs are met once in each direction; key them by
+            // whichever end pair is smaller
+            int64_t fwd_lo = ids[arc[0]], fwd_hi = ids[arc[1]];
+            int64_t rev_lo = ids[arc[len - 1]], rev_hi = ids[arc[len - 2]];
+            int forward = fwd_lo < rev_lo || (fwd_lo == rev_lo && fwd_hi <= rev_hi);
+            int64_t key_lo = forward ? fwd_lo : rev_lo;
+            int64_t key_hi = forward ? fwd_hi : rev_hi;
+
+            if (arc_set_insert(arc_keys, arc_capacity - 1, key_lo, key_hi)) {
+                unique_arcs++;
+                if (len > 2) {
+                    for (VertexIndex k = 0; k < len; k++)
+                        coords_point(coords, offsets[r] + arc[k], &arc_points[2 * k]);
+
+                    Coords line = coords_interleaved(arc_points);
+                    simplify_rank(ws, &line, len, 0, order, order_areas);
+                    for (VertexIndex k = 0; k < len; k++) {
+                        VertexIndex vi = order[k];
+                        if (vi > 0 && vi < len - 1)
+                            point_areas[ids[arc[vi]]] = order_areas[k];
+                    }
+                }
+            }
+            s = i;
+        } while (s != start);
+    }
+
+    for (int64_t r = 0; r < num_rings; r++) {
+        for (VertexIndex i = 0; i < ring_vertices[r]; i++) {
+            int64_t id = point_ids[offsets[r] + i];
+            vertex_areas[offsets[r] + i] = junction[id] ? INFINITY : point_areas[id];
+        }
+    }
+
+    if (stats) {
+        stats->num_points = num_points;
+        stats->num_junctions = 0;
+        for (int64_t p = 0; p < num_points; p++)
+            stats->num_junctions += junction[p];
+        stats->num_arcs = num_arcs;
+        stats->unique_arcs = unique_arcs;
+    }
+    status = 0;
+
+cleanup:
+    free(point_ids);
+    free(arc_keys);
+    free(arc);
+    free(arc_points);
+    free(order);
+    free(order_areas);
+    free(junction);
+    free(point_areas);
+    scratch_release(ws);
+    return status;
+}
+
+/**
+ * @brief Whether a vertex with the given area survives a threshold
+ *
+ * Pinned vertices survive every threshold, infinite ones included.
+ */
+static inline int vertex_kept(double area, double threshold) {
+    return area > threshold || area == INFINITY;
+}
+
+VertexIndex coverage_count_kept(const double* ring_areas, VertexIndex num_points,
+                                double threshold) {
+    VertexIndex count = 0;
+    for (VertexIndex i = 0; i < num_points; i++)
+        count += vertex_kept(ring_areas[i], threshold);
+    return count;
+}
+
+/**
+ * @def KEPT_LOOP
+ * @brief Body of coverage_extract for one storage type
+ */
+#define KEPT_LOOP(COORD_T)                                                      \
+    do {                                                                        \
+        COORD_T* out = (COORD_T*)result_data;                                   \
+        const int dims = ring->dims;                                            \
+        VertexIndex k = 0;                                                      \
+        for (VertexIndex i = 0; i < num_points; i++) {                          \
+            if (vertex_kept(ring_areas[i], threshold)) {                        \
+                COORD_T* row = out + (ptrdiff_t)dims * k;                       \
+                for (int d = 0; d < dims; d++)                                  \
+                    row[d] = COORD_VALUE(ring, COORD_T, i, d);                  \
+                k++;                                                            \
+            }                                                                   \
+        }                                                                       \
+        if (k > 0) {                                                            \
+            for (int d = 0; d < dims; d++)                                      \
+                out[(ptrdiff_t)dims * k + d] = out[d];                          \
+        }                                                                       \
+    } while (0)
+
+void coverage_extract(const Coords* ring, const double* ring_areas, VertexIndex num_points,
+                      double threshold, void* result_data) {
+    if (ring->type == COORD_FLOAT32)
+        KEPT_LOOP(float);
+    else
+        KEPT_LOOP(double);
+}
@@ -0,0 +1,85 @@
+/**
+ * @file topology.h
+ * @brief Topology-preserving simplification of polygon coverages
+ *
+ * Rings of a coverage that share a boundary share its vertices. This header
+ * defines the pass that splits all rings into arcs at junction vertices,
+ * simplifies every distinct arc once as an open line with pinned endpoints,
+ * and records the resulting effective area of every input vertex. Rings
+ * filtered by these areas stay free of gaps and slivers along shared edges.
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <stdint.h>
+#include "geometry.h"
+
+/**
+ * @struct CoverageStats
+ * @brief Summary of the arc decomposition of a coverage
+ *
+ * @param num_points    Number of distinct points
+ * @param num_junctions Number of pinned points
+ * @param num_arcs      Number of arcs over all rings
+ * @param unique_arcs   Number of distinct arcs, each simplified once
+ */
+typedef struct {
+    int64_t num_points;
+    int64_t num_junctions;
+    int64_t num_arcs;
+    int64_t unique_arcs;
+} CoverageStats;
+
+/**
+ * @brief Compute the effective area of every vertex of a coverage
+ *
+ * Points are matched by exact coordinate equality, so the coverage must be
+ * noded: a shared boundary has the same vertices in every ring along it.
+ * A point is a junction if its neighbours differ between its occurrences.
+ * Rings with fewer than three junctions get extra pinned vertices, so no
+ * ring ever drops below three vertices. Junctions get an infinite area;
+ * every other vertex gets the effective area at which it is removed from
+ * its arc. A vertex is kept at a threshold if its area exceeds it.
+ *
+ * @param coords        Coordinates of all rings
+ * @param offsets       Ring offsets into coords, num_rings + 1 entries
+ * @param ring_vertices Number of distinct vertices of every ring
+ * @param num_rings     Number of rings
+ * @param vertex_areas  Receives one area per coordinate, offsets[num_rings]
+ *                      entries; closure points are left untouched
+ * @param stats         Receives the decomposition summary (may be NULL)
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int coverage_vertex_areas(const Coords* coords, const int64_t* offsets,
+                          const VertexIndex* ring_vertices, int64_t num_rings,
+                          double* vertex_areas, CoverageStats* stats);
+
+/**
+ * @brief Number of vertices of a ring kept at a threshold
+ *
+ * @param ring_areas Vertex areas of the ring
+ * @param num_points Number of distinct vertices of the ring
+ * @param threshold  Largest effective area that is removed
+ * @return VertexIndex Number of kept vertices, excluding the closure point
+ */
+VertexIndex coverage_count_kept(const double* ring_areas, VertexIndex num_points,
+                                double threshold);
+
+/**
+ * @brief Write the vertices of a ring kept at a threshold
+ *
+ * Kept vertices are written in ring order, followed by a closure point when
+ * any vertex is kept. The result holds every column of each vertex,
+ * interleaved, in the same storage type as the source.
+ *
+ * @param ring        Ring coordinates (unclosed)
+ * @param ring_areas  Vertex areas of the ring
+ * @param num_points  Number of distinct vertices of the ring
+ * @param threshold   Largest effective area that is removed
+ * @param result_data Destination array for the kept vertices and closure point
+ */
+void coverage_extract(const Coords* ring, const double* ring_areas, VertexIndex num_points,
+                      double threshold, void* result_data);
+
+#endif /* TOPOLOGY_H */
@@ -0,0 +1,40 @@
+/**
+ * @file vertex_index.h
+ * @brief Integer type of vertex indices and counts
+ *
+ * This header selects the type the engine uses for vertex indices, ring
+ * sizes and heap positions. The default build uses int, which keeps the
+ * links and the heap compact. Defining VERTEX_INDEX_64 switches every
+ * one of them to int64_t for rings of more than MAX_RING_VERTICES
+ * vertices in the 32-bit build.
+ */
+
+#ifndef VERTEX_INDEX_H
+#define VERTEX_INDEX_H
+
+#include <limits.h>
+#include <stdint.h>
+
+/**
+ * @typedef VertexIndex
+ * @brief Vertex index, vertex count or heap position
+ */
+#ifdef VERTEX_INDEX_64
+typedef int64_t VertexIndex;
+#define VERTEX_INDEX_MAX INT64_MAX
+#else
+typedef int VertexIndex;
+#define VERTEX_INDEX_MAX INT_MAX
+#endif
+
+/**
+ * @def MAX_RING_VERTICES
+ * @brief Largest ring or line the build can simplify
+ *
+ * Leaves room for the counts derived from the ring size, such as the 2n
+ * values of an interleaved output ring and the workspace growing by half
+ * again, so none of them overflow.
+ */
+#define MAX_RING_VERTICES (VERTEX_INDEX_MAX / 4)
+
+#endif /* VERTEX_INDEX_H */
@@ -1,283 +1,1545 @@
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include "visvalingam.h"
-#include "min_heap.h"
+#include "simplify.h"
+#include "scratch.h"
 #include "geometry.h"
+#include "batch.h"
+#include "chunked.h"
+#include "parallel.h"
+#include "pyindex.h"
+#include "pycache.h"
+#include "elimination.h"
+#include "pysimplifier.h"
+#include "pygeoarrow.h"
+#include "pycoords.h"
+#include "topology.h"
+#include "stream.h"
+#include "stats.h"
 
 /**
- * @brief Sort resolutions in descending order
+ * @brief Create the result array of one ring at one resolution
  *
- * Creates a new array containing the resolutions sorted from highest to lowest.
- * This ordering is important for the simplification process as we need to process
- * higher resolutions before lower ones.
+ * @param target_vertices Number of vertices to keep
+ * @param coords Input coordinates, whose storage type and columns are kept
+ * @param closed Nonzero to leave room for a closure point
+ * @param indices Nonzero for a 1D int64 array of input positions instead
+ * @return PyArrayObject* New numpy array or NULL on failure
+ */
+static PyArrayObject* create_result_array(VertexIndex target_vertices, const Coords* coords,
+                                          int closed, int indices) {
+    npy_intp dims[2] = {target_vertices + (closed ? 1 : 0), coords->dims};  // +1 for closure point
+    if (indices)
+        return (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_INT64);
+    return (PyArrayObject*)PyArray_SimpleNew(2, dims, coord_npy_type(coords->type));
+}
+
+/**
+ * @brief Write the remaining vertices of a workspace to a result array
+ *
+ * @param ws      Workspace holding the simplified ring
+ * @param coords  Input coordinates
+ * @param closed  Nonzero to append a closure point
+ * @param indices Nonzero to write int64 input positions instead of coordinates
+ * @param data    Result array data
+ */
+static void extract_result(const Workspace* ws, const Coords* coords, int closed,
+                           int indices, void* data) {
+    if (indices)
+        extract_indices(ws->links, first_active_vertex(ws), ws->active_count, closed, 0,
+                        (int64_t*)data);
+    else
+        extract_simplified(coords, ws->links, first_active_vertex(ws), ws->active_count,
+                           closed, data);
+}
+
+#ifdef SIMPLIFY_STATS
+/** Counters of the most recent simplify_multi call, guarded by the GIL */
+static SimplifyStats last_stats;
+#endif
+
+/**
+ * @brief Whether the k-th resolution in descending order repeats the one before
  *
  * @param resolutions Array of target resolutions
+ * @param order Resolution indices from order_resolutions
+ * @param k Position in order
+ * @return int Nonzero if resolutions[order[k]] equals resolutions[order[k - 1]]
+ */
+static inline int repeated_target(const int* resolutions, const int* order, int k) {
+    return k > 0 && resolutions[order[k]] == resolutions[order[k - 1]];
+}
+
+/**
+ * @brief Simplify a ring to every resolution from its cached elimination order
+ *
+ * On a miss the elimination runs to completion instead of stopping at the
+ * smallest target, and its order is added to the cache. Either way each
+ * distinct target is then extracted by selecting its highest ranks, which
+ * gives the same rings as simplify_to.
+ *
+ * @param cache           Order cache
+ * @param ws              Workspace reserved for num_points vertices
+ * @param coords          Ring (unclosed) or line coordinates
+ * @param num_points      Number of vertices
+ * @param closed          Nonzero for a ring, zero for an open line
+ * @param metric          Effective area used to rank vertices
+ * @param resolutions     Target resolutions
+ * @param order           Resolution indices from order_resolutions
  * @param num_resolutions Number of resolutions
- * @return int* Newly allocated array containing sorted resolutions
+ * @param indices         Nonzero to write int64 input positions instead of coordinates
+ * @param result_data     Result array data by position in order
+ * @return int 0 on success, -1 if memory could not be allocated
  */
-static int* sort_resolutions(const int* resolutions, int num_resolutions) {
-    int* sorted = malloc(num_resolutions * sizeof(int));
-    memcpy(sorted, resolutions, num_resolutions * sizeof(int));
+static int simplify_cached(OrderCache* cache, Workspace* ws, const Coords* coords,
+                           VertexIndex num_points, int closed, AreaMetric metric,
+                           const int* resolutions, const int* order, int num_resolutions,
+                           int indices, void** result_data) {
+    if (num_resolutions == 0)
+        return 0;
+
+    OrderKey key;
+    order_cache_key(coords, num_points, closed, metric, &key);
+    VertexIndex max_target = resolutions[order[0]];
+    VertexIndex* ranks = malloc((size_t)num_points * sizeof(VertexIndex));
+    VertexIndex* kept = malloc((size_t)max_target * sizeof(VertexIndex));
+    double* order_areas = NULL;
+    int failed = !ranks || !kept;
+
+    // A hit only needs the ranks every target keeps
+    if (!failed && !order_cache_lookup(cache, &key, num_points - max_target, ranks, NULL)) {
+        order_areas = malloc((size_t)num_points * sizeof(double));
+        if (!order_areas) {
+            failed = 1;
+        } else {
+            ws->metric = metric;
+            simplify_rank(ws, coords, num_points, closed, ranks, order_areas);
+            order_cache_insert(cache, &key, ranks, order_areas);
+        }
+    }
+
+    for (int res_idx = 0; res_idx < num_resolutions && !failed; res_idx++) {
+        if (repeated_target(resolutions, order, res_idx))
+            continue;
+        VertexIndex target = resolutions[order[res_idx]];
+        if (elimination_order_kept(ranks, num_points, target, kept) != 0) {
+            failed = 1;
+            break;
+        }
+        if (indices) {
+            int64_t* out = (int64_t*)result_data[res_idx];
+            for (VertexIndex k = 0; k < target; k++)
+                out[k] = kept[k];
+            if (closed)
+                out[target] = out[0];
+        } else {
+            gather_points(coords, kept, target, closed, result_data[res_idx]);
+        }
+    }
+
+    free(ranks);
+    free(kept);
+    free(order_areas);
+    return failed ? -1 : 0;
+}
+
+PyObject* visvalingam_whyatt_multi_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"points", "resolutions", "closed", "safe", "metric",
+                             "return_indices", "cache", NULL};
+    PyObject *points_arg, *resolutions_arg;
+    int closed = 1;
+    int safe = 0;
+    const char* metric_name = "area";
+    int return_indices = 0;
+    PyObject* cache_arg = Py_None;
+    AreaMetric metric;
+    OrderCache* cache;
+
+    // Parse input arguments
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|ppspO", kwlist, &points_arg,
+                                     &resolutions_arg, &closed, &safe, &metric_name,
+                                     &return_indices, &cache_arg))
+        return NULL;
+    if (metric_from_name(metric_name, &metric) != 0 || cache_from_object(cache_arg, &cache) != 0)
+        return NULL;
+    if (cache && safe) {
+        PyErr_SetString(PyExc_ValueError, "cache cannot be combined with safe=True");
+        return NULL;
+    }
 
-    // Simple insertion sort since num_resolutions is typically small
+    // Describe the points in place; float32 and strided views are not copied
+    Coords coords;
+    PyArrayObject* points_obj = points_from_object(points_arg, "Points", &coords);
+    if (!points_obj)
+        return NULL;
+    if (check_metric_dims(metric, &coords) != 0) {
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    int num_resolutions;
+    int* resolutions = int_values_from_object(resolutions_arg, "Resolutions", &num_resolutions);
+    if (!resolutions) {
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    if (check_ring_size(PyArray_DIM(points_obj, 0)) != 0) {
+        free(resolutions);
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    // Work with unclosed polygon; open lines keep every point
+    VertexIndex num_points = (VertexIndex)PyArray_DIM(points_obj, 0);
+    if (closed)
+        num_points = ring_vertex_count(&coords, num_points);
+
+    // Validate resolutions
     for (int i = 0; i < num_resolutions; i++) {
-        for (int j = i + 1; j < num_resolutions; j++) {
-            if (sorted[i] < sorted[j]) {
-                int temp = sorted[i];
-                sorted[i] = sorted[j];
-                sorted[j] = temp;
+        if (resolutions[i] >= num_points) {
+            PyErr_SetString(PyExc_ValueError,
+                          "Invalid resolution: must be < input vertices");
+            free(resolutions);
+            Py_DECREF(points_obj);
+            return NULL;
+        }
+        else if (resolutions[i] < min_vertices(closed)){
+            char error_str[100];
+            sprintf(error_str, "Invalid resolution: must be >= %d, is: %d",
+                    min_vertices(closed), resolutions[i]);
+            PyErr_SetString(PyExc_ValueError,
+                          error_str);
+            free(resolutions);
+            Py_DECREF(points_obj);
+            return NULL;
+        }
+    }
+
+#ifdef SIMPLIFY_STATS
+    stats_reset();
+#endif
+
+    // Allocate working memory
+    Workspace* ws = scratch_acquire(num_points);
+    if (!ws) {
+        PyErr_NoMemory();
+        free(resolutions);
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    // Create result list
+    PyObject* result_list = PyList_New(num_resolutions);
+    if (!result_list) {
+        scratch_release(ws);
+        free(resolutions);
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    int* order = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(int));
+    void** result_data = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(void*));
+    PyArrayObject** result_objs = calloc(num_resolutions > 0 ? num_resolutions : 1,
+                                         sizeof(PyArrayObject*));
+    if (!order || !result_data || !result_objs) {
+        PyErr_NoMemory();
+        Py_DECREF(result_list);
+        scratch_release(ws);
+        free(order);
+        free(result_data);
+        free(result_objs);
+        free(resolutions);
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+    order_resolutions(resolutions, num_resolutions, order);
+
+    // Create result arrays up front so the loop can run without the GIL;
+    // in safe mode their sizes are only known once each target is reached.
+    // Result k belongs to resolutions[order[k]], and repeats of a target
+    // share the array of its first occurrence, so only those are allocated
+    for (int res_idx = 0; res_idx < num_resolutions && !safe; res_idx++) {
+        if (repeated_target(resolutions, order, res_idx))
+            continue;
+        result_objs[res_idx] = create_result_array(resolutions[order[res_idx]], &coords,
+                                                   closed, return_indices);
+        if (!result_objs[res_idx]) {
+            for (int i = 0; i < res_idx; i++)
+                Py_XDECREF(result_objs[i]);
+            Py_DECREF(result_list);
+            scratch_release(ws);
+            free(order);
+            free(result_data);
+            free(result_objs);
+            free(resolutions);
+            Py_DECREF(points_obj);
+            return NULL;
+        }
+        result_data[res_idx] = PyArray_DATA(result_objs[res_idx]);
+    }
+
+    int failed = 0;
+    Py_BEGIN_ALLOW_THREADS
+
+    if (cache) {
+        failed = simplify_cached(cache, ws, &coords, num_points, closed, metric, resolutions,
+                                 order, num_resolutions, return_indices, result_data) != 0;
+    } else {
+        // Initialize vertex linkage, heap and initial areas
+        STATS_TIMER(init_start);
+        ws->metric = metric;
+        simplify_begin(ws, &coords, num_points, closed);
+        if (safe && simplify_guard_intersections(ws, &coords) != 0)
+            failed = 1;
+        STATS_ELAPSED(init_seconds, init_start);
+
+        // Main simplification loop
+        for (int res_idx = 0; res_idx < num_resolutions && !failed; res_idx++) {
+            if (repeated_target(resolutions, order, res_idx))
+                continue;
+            int target = resolutions[order[res_idx]];
+
+            // Simplify until we reach target resolution
+            STATS_TIMER(simplify_start);
+            simplify_to(ws, &coords, target);
+            STATS_ELAPSED(simplify_seconds, simplify_start);
+
+            if (safe) {
+                Py_BLOCK_THREADS
+                result_objs[res_idx] = create_result_array(ws->active_count, &coords, closed,
+                                                           return_indices);
+                Py_UNBLOCK_THREADS
+                if (!result_objs[res_idx]) {
+                    failed = 1;
+                    break;
+                }
+                result_data[res_idx] = PyArray_DATA(result_objs[res_idx]);
             }
+
+            // Extract simplified polygon
+            STATS_TIMER(extract_start);
+            extract_result(ws, &coords, closed, return_indices, result_data[res_idx]);
+            STATS_ELAPSED(extract_seconds, extract_start);
         }
+        if (safe && ws->grid && ws->grid->failed)
+            failed = 1;
+    }
+
+    Py_END_ALLOW_THREADS
+#ifdef SIMPLIFY_STATS
+    last_stats = simplify_stats;
+#endif
+
+    if (failed) {
+        if (!PyErr_Occurred())
+            PyErr_NoMemory();
+        for (int i = 0; i < num_resolutions; i++)
+            Py_XDECREF(result_objs[i]);
+        Py_DECREF(result_list);
+        scratch_release(ws);
+        free(order);
+        free(result_data);
+        free(result_objs);
+        free(resolutions);
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+
+    // Place every result at its input position; repeats take a new reference
+    PyArrayObject* shared = NULL;
+    for (int res_idx = 0; res_idx < num_resolutions; res_idx++) {
+        if (repeated_target(resolutions, order, res_idx))
+            Py_INCREF(shared);
+        else
+            shared = result_objs[res_idx];
+        PyList_SET_ITEM(result_list, order[res_idx], (PyObject*)shared);
     }
-    return sorted;
+
+    // Clean up
+    scratch_release(ws);
+    free(order);
+    free(result_data);
+    free(result_objs);
+    free(resolutions);
+    Py_DECREF(points_obj);
+
+    return result_list;
 }
 
 /**
- * @brief Initialize the vertex linkage arrays
+ * @struct BatchInput
+ * @brief Validated arguments shared by simplify_batch and simplify_batch_size
  *
- * Sets up the circular linkage between vertices and marks all vertices as active.
+ * The metric is not parsed by batch_input_parse; callers that simplify set
+ * it themselves, and it defaults to METRIC_AREA.
+ */
+typedef struct {
+    PyArrayObject* coords_obj;
+    PyArrayObject* offsets_obj;
+    Coords coords;
+    const npy_int64* offsets;
+    npy_intp num_rings;
+    int* resolutions;
+    int num_resolutions;
+    VertexIndex* ring_vertices;
+    int closed;
+    AreaMetric metric;
+} BatchInput;
+
+/**
+ * @brief Release the references and buffers held by a BatchInput
  *
- * @param prev_vertex Array to store previous vertex indices
- * @param next_vertex Array to store next vertex indices
- * @param active Array to mark active vertices
- * @param num_points Number of vertices in the polygon
+ * @param in Batch input, possibly partially parsed
  */
-static void initialize_vertex_linkage(int* prev_vertex, int* next_vertex,
-                                    char* active, int num_points) {
-    for (int i = 0; i < num_points; i++) {
-        prev_vertex[i] = (i - 1 + num_points) % num_points;
-        next_vertex[i] = (i + 1) % num_points;
-        active[i] = 1;
-    }
+static void batch_input_release(BatchInput* in) {
+    free(in->ring_vertices);
+    free(in->resolutions);
+    Py_XDECREF(in->coords_obj);
+    Py_XDECREF(in->offsets_obj);
 }
 
 /**
- * @brief Calculate initial effective areas for all vertices
+ * @brief Convert and validate the coordinates, offsets and resolutions of a batch
  *
- * Computes the initial triangle areas for each vertex and adds them to the heap.
+ * On failure a Python exception is set and the input must still be released
+ * with batch_input_release.
  *
- * @param heap MinHeap to store vertex areas
- * @param areas Array to store area values
- * @param points_data Input polygon points
- * @param prev_vertex Previous vertex indices
- * @param next_vertex Next vertex indices
- * @param num_points Number of vertices
+ * @param coords_arg      Flat coordinates object
+ * @param offsets_arg     Ring offsets object
+ * @param resolutions_arg Target resolutions object, or NULL for none
+ * @param closed          Nonzero for rings, zero for open lines
+ * @param in              Zero-initialized batch input to fill
+ * @return int 0 on success, -1 on failure
  */
-static void calculate_initial_areas(MinHeap* heap, double* areas,
-                                  const double* points_data,
-                                  const int* prev_vertex, const int* next_vertex,
-                                  int num_points) {
-    for (int i = 0; i < num_points; i++) {
-        double area = triangle_area(
-            &points_data[2 * prev_vertex[i]],
-            &points_data[2 * i],
-            &points_data[2 * next_vertex[i]]
-        );
-        areas[i] = area;
-        heap_push(heap, area, i);
+static int batch_input_parse(PyObject* coords_arg, PyObject* offsets_arg,
+                             PyObject* resolutions_arg, int closed, BatchInput* in) {
+    in->closed = closed;
+
+    // Convert inputs; arrays that already have a usable layout are not copied
+    in->coords_obj = points_from_object(coords_arg, "Coordinates", &in->coords);
+    if (!in->coords_obj || check_metric_dims(in->metric, &in->coords) != 0)
+        return -1;
+    in->offsets_obj = (PyArrayObject*)PyArray_FROMANY(offsets_arg, NPY_INT64, 1, 1,
+                                                      NPY_ARRAY_IN_ARRAY);
+    if (!in->offsets_obj)
+        return -1;
+    if (resolutions_arg) {
+        in->resolutions = int_values_from_object(resolutions_arg, "Resolutions",
+                                                 &in->num_resolutions);
+        if (!in->resolutions)
+            return -1;
+    }
+
+    // Validate input dimensions
+    if (PyArray_DIM(in->offsets_obj, 0) < 1) {
+        PyErr_SetString(PyExc_ValueError, "Offsets must contain at least one entry");
+        return -1;
+    }
+
+    npy_intp num_coords = PyArray_DIM(in->coords_obj, 0);
+    in->num_rings = PyArray_DIM(in->offsets_obj, 0) - 1;
+    in->offsets = (const npy_int64*)PyArray_DATA(in->offsets_obj);
+
+    // Validate resolutions
+    for (int i = 0; i < in->num_resolutions; i++) {
+        if (in->resolutions[i] < min_vertices(closed)) {
+            PyErr_Format(PyExc_ValueError, "Invalid resolution: must be >= %d, is: %d",
+                         min_vertices(closed), in->resolutions[i]);
+            return -1;
+        }
+    }
+
+    // Validate offsets and count the distinct vertices of every ring
+    in->ring_vertices = malloc((in->num_rings > 0 ? in->num_rings : 1) * sizeof(VertexIndex));
+    if (!in->ring_vertices) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    if (in->offsets[0] < 0 || in->offsets[in->num_rings] > num_coords) {
+        PyErr_SetString(PyExc_ValueError, "Offsets out of range of coordinates array");
+        return -1;
     }
+
+    for (npy_intp r = 0; r < in->num_rings; r++) {
+        npy_int64 ring_size = in->offsets[r + 1] - in->offsets[r];
+        if (ring_size < 0) {
+            PyErr_SetString(PyExc_ValueError, "Offsets must be non-decreasing");
+            return -1;
+        }
+        if (check_ring_size(ring_size) != 0)
+            return -1;
+        Coords ring = coords_slice(&in->coords, in->offsets[r]);
+        in->ring_vertices[r] = closed ? ring_vertex_count(&ring, (VertexIndex)ring_size)
+                                      : (VertexIndex)ring_size;
+    }
+    return 0;
 }
 
 /**
- * @brief Create result array for a given resolution
+ * @brief Number of output points of one ring at one resolution
  *
- * Allocates and initializes a new numpy array for storing the simplified polygon.
+ * Rings with no more vertices than the resolution are copied unchanged.
  *
- * @param target_vertices Number of vertices in simplified polygon
- * @return PyArrayObject* New numpy array or NULL on failure
+ * @param resolution    Target resolution
+ * @param ring_vertices Number of distinct vertices of the ring
+ * @param closed        Nonzero for rings, zero for open lines
+ * @return npy_int64 Output points including the closure point, 0 for empty rings
+ */
+static npy_int64 ring_output_size(int resolution, VertexIndex ring_vertices, int closed) {
+    VertexIndex target = resolution < ring_vertices ? resolution : ring_vertices;
+    return target > 0 ? target + (closed ? 1 : 0) : 0;  // +1 for closure point
+}
+
+/**
+ * @brief Check that a caller-provided output array can be written in place
+ *
+ * @param array Output array
+ * @param name  Argument name used in error messages
+ * @param type  Required numpy type
+ * @return int 0 if usable, -1 with a Python exception set otherwise
  */
-static PyArrayObject* create_result_array(int target_vertices) {
-    npy_intp dims[2] = {target_vertices + 1, 2};  // +1 for closure point
-    return (PyArrayObject*)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+static int check_output_array(PyArrayObject* array, const char* name, int type) {
+    if (PyArray_TYPE(array) != type) {
+        PyErr_Format(PyExc_TypeError, "%s has the wrong dtype", name);
+        return -1;
+    }
+    if (!PyArray_ISCARRAY(array) || !PyArray_ISNOTSWAPPED(array)) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s must be a writeable, C-contiguous array in native byte order", name);
+        return -1;
+    }
+    return 0;
 }
 
 /**
- * @brief Clean up allocated resources
+ * @brief Simplify every ring of a parsed batch and package the results
  *
- * Frees all memory allocated during the simplification process.
+ * Output arrays are either allocated or, when out_arg or out_offsets_arg
+ * is not Py_None, views into the caller-provided arrays. Coordinate
+ * outputs have the columns of the input; with indices they are 1D int64
+ * positions into the input coordinates instead.
  *
- * @param prev_vertex Previous vertex indices array
- * @param next_vertex Next vertex indices array
- * @param active Active vertices array
- * @param areas Areas array
- * @param heap MinHeap structure
- * @param sorted_resolutions Sorted resolutions array
+ * @param in              Parsed batch input
+ * @param num_threads     Number of threads, 0 for every CPU
+ * @param out_arg         Output coordinates arena or Py_None
+ * @param out_offsets_arg Output offsets array or Py_None
+ * @param indices         Nonzero to return input positions instead of coordinates
+ * @return PyObject* List with one (coords, offsets) tuple per resolution
  */
-static void cleanup_resources(int* prev_vertex, int* next_vertex, char* active,
-                            double* areas, MinHeap* heap, int* sorted_resolutions) {
-    free(prev_vertex);
-    free(next_vertex);
-    free(active);
-    free(areas);
-    heap_destroy(heap);
-    free(sorted_resolutions);
+static PyObject* batch_simplify(const BatchInput* in, int num_threads,
+                                PyObject* out_arg, PyObject* out_offsets_arg, int indices) {
+    if (num_threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "num_threads must be >= 0");
+        return NULL;
+    }
+    if ((out_arg != Py_None && !PyArray_Check(out_arg)) ||
+        (out_offsets_arg != Py_None && !PyArray_Check(out_offsets_arg))) {
+        PyErr_SetString(PyExc_TypeError, "out and out_offsets must be numpy arrays");
+        return NULL;
+    }
+
+    PyArrayObject** out_coords = NULL;
+    PyArrayObject** out_offsets = NULL;
+    void** out_data = NULL;
+    const int64_t** out_off_data = NULL;
+    int* order = NULL;
+    PyObject* result_list = NULL;
+
+    int num_resolutions = in->num_resolutions;
+    npy_intp num_rings = in->num_rings;
+    int closed = in->closed;
+    int coord_type = indices ? NPY_INT64 : coord_npy_type(in->coords.type);
+    int out_ndim = indices ? 1 : 2;
+
+    order = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(int));
+    out_coords = calloc(num_resolutions > 0 ? num_resolutions : 1, sizeof(PyArrayObject*));
+    out_offsets = calloc(num_resolutions > 0 ? num_resolutions : 1, sizeof(PyArrayObject*));
+    out_data = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(void*));
+    out_off_data = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(int64_t*));
+    if (!order || !out_coords || !out_offsets || !out_data || !out_off_data) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+
+    // Output offsets: rows of the caller's (num_resolutions, num_rings + 1)
+    // array, or one new array per resolution
+    if (out_offsets_arg != Py_None) {
+        PyArrayObject* array = (PyArrayObject*)out_offsets_arg;
+        if (check_output_array(array, "out_offsets", NPY_INT64) != 0)
+            goto fail;
+        if (PyArray_NDIM(array) != 2 || PyArray_DIM(array, 0) != num_resolutions ||
+            PyArray_DIM(array, 1) != num_rings + 1) {
+            PyErr_SetString(PyExc_ValueError,
+                            "out_offsets must be of shape (num_resolutions, num_rings + 1)");
+            goto fail;
+        }
+    }
+
+    // Check the caller's arena before writing into their offsets array
+    if (out_arg != Py_None) {
+        PyArrayObject* array = (PyArrayObject*)out_arg;
+        if (check_output_array(array, "out", coord_type) != 0)
+            goto fail;
+        if (PyArray_NDIM(array) != out_ndim ||
+            (!indices && PyArray_DIM(array, 1) != in->coords.dims)) {
+            PyErr_SetString(PyExc_ValueError, indices ?
+                            "out array must be 1-dimensional" :
+                            "out array must be of shape (n, D) with the columns of coords");
+            goto fail;
+        }
+
+        npy_intp total = 0;
+        for (int j = 0; j < num_resolutions; j++) {
+            for (npy_intp r = 0; r < num_rings; r++)
+                total += ring_output_size(in->resolutions[j], in->ring_vertices[r], closed);
+        }
+        if (PyArray_DIM(array, 0) < total) {
+            PyErr_Format(PyExc_ValueError,
+                         "out array too small: needs %zd rows, has %zd",
+                         (Py_ssize_t)total, (Py_ssize_t)PyArray_DIM(array, 0));
+            goto fail;
+        }
+    }
+
+    for (int j = 0; j < num_resolutions; j++) {
+        if (out_offsets_arg != Py_None) {
+            out_offsets[j] = (PyArrayObject*)PySequence_GetItem(out_offsets_arg, j);
+        } else {
+            npy_intp offsets_dims[1] = {num_rings + 1};
+            out_offsets[j] = (PyArrayObject*)PyArray_SimpleNew(1, offsets_dims, NPY_INT64);
+        }
+        if (!out_offsets[j])
+            goto fail;
+
+        npy_int64* out_off = (npy_int64*)PyArray_DATA(out_offsets[j]);
+        out_off[0] = 0;
+        for (npy_intp r = 0; r < num_rings; r++)
+            out_off[r + 1] = out_off[r] + ring_output_size(in->resolutions[j],
+                                                           in->ring_vertices[r], closed);
+    }
+
+    // Output coordinates: consecutive slices of the caller's arena, in
+    // resolution order, or one new array per resolution
+    npy_intp base = 0;
+    for (int j = 0; j < num_resolutions; j++) {
+        npy_intp size = ((npy_int64*)PyArray_DATA(out_offsets[j]))[num_rings];
+        if (out_arg != Py_None) {
+            out_coords[j] = (PyArrayObject*)PySequence_GetSlice(out_arg, base, base + size);
+            base += size;
+        } else {
+            npy_intp coords_dims[2] = {size, in->coords.dims};
+            out_coords[j] = (PyArrayObject*)PyArray_SimpleNew(out_ndim, coords_dims, coord_type);
+        }
+        if (!out_coords[j])
+            goto fail;
+    }
+
+    order_resolutions(in->resolutions, num_resolutions, order);
+
+    for (int j = 0; j < num_resolutions; j++) {
+        out_data[j] = PyArray_DATA(out_coords[j]);
+        out_off_data[j] = (const int64_t*)PyArray_DATA(out_offsets[j]);
+    }
+
+    BatchJob job = {
+        in->coords, (const int64_t*)in->offsets, in->ring_vertices, (int64_t)num_rings,
+        in->resolutions, order, num_resolutions, out_data, out_off_data, closed, in->metric,
+        indices
+    };
+
+    if (num_threads == 0)
+        num_threads = cpu_count();
+
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = batch_run(&job, num_threads);
+    Py_END_ALLOW_THREADS
+
+    if (status != 0) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+
+    // Package results as (coords, offsets) tuples in input order
+    result_list = PyList_New(num_resolutions);
+    if (!result_list)
+        goto fail;
+
+    for (int j = 0; j < num_resolutions; j++) {
+        PyObject* item = PyTuple_Pack(2, (PyObject*)out_coords[j], (PyObject*)out_offsets[j]);
+        if (!item)
+            goto fail;
+        PyList_SET_ITEM(result_list, j, item);
+    }
+
+fail:
+    if (out_coords && out_offsets) {
+        for (int j = 0; j < in->num_resolutions; j++) {
+            Py_XDECREF(out_coords[j]);
+            Py_XDECREF(out_offsets[j]);
+        }
+    }
+    if (PyErr_Occurred())
+        Py_CLEAR(result_list);
+    free(out_coords);
+    free(out_offsets);
+    free(out_data);
+    free(out_off_data);
+    free(order);
+    return result_list;
 }
 
-PyObject* visvalingam_whyatt_multi_c(PyObject* self, PyObject* args) {
-    PyArrayObject *points_obj, *resolutions_obj;
+PyObject* visvalingam_batch_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"coords", "offsets", "resolutions", "num_threads",
+                             "out", "out_offsets", "closed", "metric", "return_indices", NULL};
+    PyObject *coords_arg, *offsets_arg, *resolutions_arg;
+    PyObject* out_arg = Py_None;
+    PyObject* out_offsets_arg = Py_None;
+    int num_threads = 1;
+    int closed = 1;
+    const char* metric_name = "area";
+    int return_indices = 0;
 
     // Parse input arguments
-    if (!PyArg_ParseTuple(args, "O!O!", &PyArray_Type, &points_obj,
-                         &PyArray_Type, &resolutions_obj))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|iOOpsp", kwlist, &coords_arg,
+                                     &offsets_arg, &resolutions_arg, &num_threads,
+                                     &out_arg, &out_offsets_arg, &closed, &metric_name,
+                                     &return_indices))
         return NULL;
 
-    // Validate input dimensions
-    if (PyArray_NDIM(points_obj) != 2 || PyArray_DIM(points_obj, 1) != 2) {
-        PyErr_SetString(PyExc_ValueError, "Points array must be of shape (n, 2)");
+    BatchInput in = {0};
+    PyObject* result_list = NULL;
+    if (metric_from_name(metric_name, &in.metric) != 0)
         return NULL;
+
+    if (batch_input_parse(coords_arg, offsets_arg, resolutions_arg, closed, &in) == 0)
+        result_list = batch_simplify(&in, num_threads, out_arg, out_offsets_arg,
+                                     return_indices);
+
+    batch_input_release(&in);
+    return result_list;
+}
+
+PyObject* visvalingam_batch_size_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"coords", "offsets", "resolutions", "closed", NULL};
+    PyObject *coords_arg, *offsets_arg, *resolutions_arg;
+    int closed = 1;
+
+    // Parse input arguments
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|p", kwlist, &coords_arg,
+                                     &offsets_arg, &resolutions_arg, &closed))
+        return NULL;
+
+    BatchInput in = {0};
+    PyArrayObject* sizes_obj = NULL;
+
+    if (batch_input_parse(coords_arg, offsets_arg, resolutions_arg, closed, &in) == 0) {
+        npy_intp dims[1] = {in.num_resolutions};
+        sizes_obj = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_INT64);
     }
 
-    if (PyArray_NDIM(resolutions_obj) != 1) {
-        PyErr_SetString(PyExc_ValueError, "Resolutions must be 1-dimensional array");
+    if (sizes_obj) {
+        npy_int64* sizes = (npy_int64*)PyArray_DATA(sizes_obj);
+        for (int j = 0; j < in.num_resolutions; j++) {
+            sizes[j] = 0;
+            for (npy_intp r = 0; r < in.num_rings; r++)
+                sizes[j] += ring_output_size(in.resolutions[j], in.ring_vertices[r], closed);
+        }
+    }
+
+    batch_input_release(&in);
+    return (PyObject*)sizes_obj;
+}
+
+/**
+ * @brief Convert and validate an offsets array pointing into another level
+ *
+ * @param obj          Offsets object
+ * @param name         Argument name used in error messages
+ * @param num_children Number of entries of the level the offsets point into
+ * @return PyArrayObject* int64 offsets array or NULL with a Python exception set
+ */
+static PyArrayObject* nested_offsets_from_object(PyObject* obj, const char* name,
+                                                 npy_intp num_children) {
+    PyArrayObject* array = (PyArrayObject*)PyArray_FROMANY(obj, NPY_INT64, 1, 1,
+                                                           NPY_ARRAY_IN_ARRAY);
+    if (!array)
         return NULL;
+
+    const npy_int64* offsets = (const npy_int64*)PyArray_DATA(array);
+    npy_intp count = PyArray_DIM(array, 0) - 1;
+    if (count < 0) {
+        PyErr_Format(PyExc_ValueError, "%s must contain at least one entry", name);
+        goto fail;
+    }
+    if (offsets[0] < 0 || offsets[count] > num_children) {
+        PyErr_Format(PyExc_ValueError, "%s out of range", name);
+        goto fail;
+    }
+    for (npy_intp i = 0; i < count; i++) {
+        if (offsets[i + 1] < offsets[i]) {
+            PyErr_Format(PyExc_ValueError, "%s must be non-decreasing", name);
+            goto fail;
+        }
     }
+    return array;
+
+fail:
+    Py_DECREF(array);
+    return NULL;
+}
 
-    // Get input data
-    int num_points = PyArray_DIM(points_obj, 0);
-    int num_resolutions = PyArray_DIM(resolutions_obj, 0);
-    int* resolutions = (int*)PyArray_DATA(resolutions_obj);
-    double* points_data = (double*)PyArray_DATA(points_obj);
+PyObject* visvalingam_polygons_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"coords", "ring_offsets", "polygon_offsets", "resolutions",
+                             "part_offsets", "num_threads", "out", "out_offsets", "metric",
+                             "return_indices", NULL};
+    PyObject *coords_arg, *ring_offsets_arg, *polygon_offsets_arg, *resolutions_arg;
+    PyObject* part_offsets_arg = Py_None;
+    PyObject* out_arg = Py_None;
+    PyObject* out_offsets_arg = Py_None;
+    int num_threads = 1;
+    const char* metric_name = "area";
+    int return_indices = 0;
 
-    // Check if input polygon is closed
-    int is_closed = (points_data[0] == points_data[2*(num_points-1)] &&
-                    points_data[1] == points_data[2*(num_points-1)+1]);
+    // Parse input arguments
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOO|OiOOsp", kwlist, &coords_arg,
+                                     &ring_offsets_arg, &polygon_offsets_arg,
+                                     &resolutions_arg, &part_offsets_arg, &num_threads,
+                                     &out_arg, &out_offsets_arg, &metric_name,
+                                     &return_indices))
+        return NULL;
 
-    if (is_closed) {
-        num_points--;  // Work with unclosed polygon
+    BatchInput in = {0};
+    PyArrayObject* polygon_offsets = NULL;
+    PyArrayObject* part_offsets = NULL;
+    PyObject* result_list = NULL;
+    if (metric_from_name(metric_name, &in.metric) != 0)
+        return NULL;
+
+    // Every ring of every polygon is simplified as one flat batch of rings
+    if (batch_input_parse(coords_arg, ring_offsets_arg, resolutions_arg, 1, &in) != 0)
+        goto fail;
+
+    polygon_offsets = nested_offsets_from_object(polygon_offsets_arg, "Polygon offsets",
+                                                 in.num_rings);
+    if (!polygon_offsets)
+        goto fail;
+    if (part_offsets_arg != Py_None) {
+        part_offsets = nested_offsets_from_object(part_offsets_arg, "Part offsets",
+                                                  PyArray_DIM(polygon_offsets, 0) - 1);
+        if (!part_offsets)
+            goto fail;
     }
 
-    // Validate resolutions
+    result_list = batch_simplify(&in, num_threads, out_arg, out_offsets_arg, return_indices);
+    if (!result_list)
+        goto fail;
+
+    // Ring counts do not change, so the outer offsets are shared with the input
+    for (Py_ssize_t j = 0; j < PyList_GET_SIZE(result_list); j++) {
+        PyObject* rings = PyList_GET_ITEM(result_list, j);
+        PyObject* item = part_offsets ?
+            PyTuple_Pack(4, PyTuple_GET_ITEM(rings, 0), PyTuple_GET_ITEM(rings, 1),
+                         (PyObject*)polygon_offsets, (PyObject*)part_offsets) :
+            PyTuple_Pack(3, PyTuple_GET_ITEM(rings, 0), PyTuple_GET_ITEM(rings, 1),
+                         (PyObject*)polygon_offsets);
+        if (!item) {
+            Py_CLEAR(result_list);
+            goto fail;
+        }
+        PyList_SetItem(result_list, j, item);
+    }
+
+fail:
+    Py_XDECREF(polygon_offsets);
+    Py_XDECREF(part_offsets);
+    batch_input_release(&in);
+    return result_list;
+}
+
+PyObject* visvalingam_arrow_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"array", "resolutions", "num_threads", "closed", "metric", NULL};
+    PyObject *array_arg, *resolutions_arg;
+    PyObject* closed_arg = Py_None;
+    int num_threads = 1;
+    const char* metric_name = "area";
+    AreaMetric metric;
+
+    // Parse input arguments
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|iOs", kwlist, &array_arg,
+                                     &resolutions_arg, &num_threads, &closed_arg,
+                                     &metric_name))
+        return NULL;
+    if (metric_from_name(metric_name, &metric) != 0)
+        return NULL;
+    if (num_threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "num_threads must be >= 0");
+        return NULL;
+    }
+    if (num_threads == 0)
+        num_threads = cpu_count();
+
+    const struct ArrowSchema* schema;
+    const struct ArrowArray* array;
+    PyObject* capsules = arrow_capsules_from_object(array_arg, &schema, &array);
+    if (!capsules)
+        return NULL;
+
+    PyObject* result_list = NULL;
+    int* resolutions = NULL;
+    int* order = NULL;
+    int64_t* ring_offsets = NULL;
+    VertexIndex* ring_vertices = NULL;
+    int64_t** out_offsets = NULL;
+    void** out_data = NULL;
+    GeoArrowBuffers** out_buffers = NULL;
+    int num_resolutions = 0;
+
+    GeoArrowView view;
+    const char* error;
+    if (geoarrow_view_init(&view, schema, array, &error) != 0) {
+        PyErr_SetString(PyExc_ValueError, error);
+        goto fail;
+    }
+    if (check_metric_dims(metric, &view.coords) != 0)
+        goto fail;
+    int closed = view.closed;
+    if (closed_arg != Py_None && (closed = PyObject_IsTrue(closed_arg)) < 0)
+        goto fail;
+
+    resolutions = int_values_from_object(resolutions_arg, "Resolutions", &num_resolutions);
+    if (!resolutions)
+        goto fail;
     for (int i = 0; i < num_resolutions; i++) {
-        if (resolutions[i] >= num_points) {
-            PyErr_SetString(PyExc_ValueError,
-                          "Invalid resolution: must be < input vertices");
-            return NULL;
+        if (resolutions[i] < min_vertices(closed)) {
+            PyErr_Format(PyExc_ValueError, "Invalid resolution: must be >= %d, is: %d",
+                         min_vertices(closed), resolutions[i]);
+            goto fail;
         }
-        else if (resolutions[i] < 3){
-            char error_str[100];
-            sprintf(error_str, "Invalid resolution: must be >= 3, is: %d", resolutions[i]);
-            PyErr_SetString(PyExc_ValueError,
-                          error_str);
-            return NULL;
+    }
+
+    // The innermost lists are the rings
+    int depth = view.depth;
+    int64_t num_rings = view.level_length[depth - 1];
+    ring_offsets = malloc((num_rings + 1) * sizeof(int64_t));
+    ring_vertices = malloc((num_rings > 0 ? num_rings : 1) * sizeof(VertexIndex));
+    order = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(int));
+    out_offsets = calloc(num_resolutions > 0 ? num_resolutions : 1, sizeof(int64_t*));
+    out_data = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(void*));
+    out_buffers = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(GeoArrowBuffers*));
+    if (!ring_offsets || !ring_vertices || !order || !out_offsets || !out_data || !out_buffers) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+
+    for (int64_t r = 0; r <= num_rings; r++)
+        ring_offsets[r] = geoarrow_offset(&view, depth - 1, r);
+    for (int64_t r = 0; r < num_rings; r++) {
+        int64_t ring_size = ring_offsets[r + 1] - ring_offsets[r];
+        if (check_ring_size(ring_size) != 0)
+            goto fail;
+        Coords ring = coords_slice(&view.coords, ring_offsets[r]);
+        ring_vertices[r] = closed ? ring_vertex_count(&ring, (VertexIndex)ring_size)
+                                  : (VertexIndex)ring_size;
+    }
+
+    // Every resolution gets its own array with the outer levels of the input
+    result_list = PyList_New(num_resolutions);
+    if (!result_list)
+        goto fail;
+    for (int j = 0; j < num_resolutions; j++) {
+        PyObject* item = arrow_array_new(&out_buffers[j]);
+        if (!item)
+            goto fail;
+        PyList_SET_ITEM(result_list, j, item);
+
+        GeoArrowBuffers* buffers = out_buffers[j];
+        out_offsets[j] = malloc((num_rings + 1) * sizeof(int64_t));
+        if (!out_offsets[j] || geoarrow_buffers_init(buffers, &view) != 0) {
+            PyErr_NoMemory();
+            goto fail;
+        }
+        out_offsets[j][0] = 0;
+        for (int64_t r = 0; r < num_rings; r++)
+            out_offsets[j][r + 1] = out_offsets[j][r] +
+                                    ring_output_size(resolutions[j], ring_vertices[r], closed);
+
+        int64_t num_points = out_offsets[j][num_rings];
+        buffers->level_length[depth] = num_points;
+        buffers->coords = malloc((num_points > 0 ? num_points : 1) * 2 *
+                                 coord_size(view.coords.type));
+        if (!buffers->coords) {
+            PyErr_NoMemory();
+            goto fail;
         }
+        out_data[j] = buffers->coords;
     }
 
-    // Allocate working memory
-    int* prev_vertex = malloc(num_points * sizeof(int));
-    int* next_vertex = malloc(num_points * sizeof(int));
-    char* active = malloc(num_points * sizeof(char));
-    double* areas = malloc(num_points * sizeof(double));
+    order_resolutions(resolutions, num_resolutions, order);
+
+    BatchJob job = {
+        view.coords, ring_offsets, ring_vertices, num_rings, resolutions, order,
+        num_resolutions, out_data, (const int64_t* const*)out_offsets, closed, metric, 0
+    };
 
-    if (!prev_vertex || !next_vertex || !active || !areas) {
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = batch_run(&job, num_threads);
+    Py_END_ALLOW_THREADS
+    if (status != 0) {
         PyErr_NoMemory();
-        cleanup_resources(prev_vertex, next_vertex, active, areas, NULL, NULL);
+        goto fail;
+    }
+
+    // Innermost offsets in the offset width of the input
+    for (int j = 0; j < num_resolutions; j++) {
+        void* offsets = out_buffers[j]->offsets[depth - 1];
+        for (int64_t r = 0; r <= num_rings; r++) {
+            if (view.large[depth - 1])
+                ((int64_t*)offsets)[r] = out_offsets[j][r];
+            else
+                ((int32_t*)offsets)[r] = (int32_t)out_offsets[j][r];
+        }
+    }
+
+fail:
+    if (PyErr_Occurred())
+        Py_CLEAR(result_list);
+    if (out_offsets) {
+        for (int j = 0; j < num_resolutions; j++)
+            free(out_offsets[j]);
+    }
+    free(out_offsets);
+    free(out_data);
+    free(out_buffers);
+    free(order);
+    free(ring_vertices);
+    free(ring_offsets);
+    free(resolutions);
+    Py_DECREF(capsules);
+    return result_list;
+}
+
+PyObject* visvalingam_coverage_c(PyObject* self, PyObject* args) {
+    PyObject *coords_arg, *offsets_arg, *thresholds_arg;
+
+    // Parse input arguments
+    if (!PyArg_ParseTuple(args, "OOO", &coords_arg, &offsets_arg, &thresholds_arg))
         return NULL;
+
+    BatchInput in = {0};
+    PyArrayObject* thresholds_obj = NULL;
+    PyArrayObject** out_coords = NULL;
+    PyArrayObject** out_offsets = NULL;
+    double* vertex_areas = NULL;
+    PyObject* result_list = NULL;
+    int num_thresholds = 0;
+
+    if (batch_input_parse(coords_arg, offsets_arg, NULL, 1, &in) != 0)
+        goto fail;
+    thresholds_obj = (PyArrayObject*)PyArray_FROMANY(thresholds_arg, NPY_DOUBLE, 1, 1,
+                                                     NPY_ARRAY_IN_ARRAY);
+    if (!thresholds_obj)
+        goto fail;
+
+    const double* thresholds = (const double*)PyArray_DATA(thresholds_obj);
+    const int64_t* offsets = (const int64_t*)in.offsets;
+    npy_intp num_rings = in.num_rings;
+    num_thresholds = (int)PyArray_DIM(thresholds_obj, 0);
+
+    vertex_areas = malloc((offsets[num_rings] > 0 ? offsets[num_rings] : 1) * sizeof(double));
+    out_coords = calloc(num_thresholds > 0 ? num_thresholds : 1, sizeof(PyArrayObject*));
+    out_offsets = calloc(num_thresholds > 0 ? num_thresholds : 1, sizeof(PyArrayObject*));
+    if (!vertex_areas || !out_coords || !out_offsets) {
+        PyErr_NoMemory();
+        goto fail;
     }
 
-    // Initialize vertex linkage
-    initialize_vertex_linkage(prev_vertex, next_vertex, active, num_points);
+    // Split the coverage into arcs and simplify every distinct arc once
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = coverage_vertex_areas(&in.coords, offsets, in.ring_vertices, (int64_t)num_rings,
+                                   vertex_areas, NULL);
+    Py_END_ALLOW_THREADS
 
-    // Initialize heap and calculate initial areas
-    MinHeap* heap = heap_create(num_points);
-    if (!heap) {
+    if (status != 0) {
         PyErr_NoMemory();
-        cleanup_resources(prev_vertex, next_vertex, active, areas, NULL, NULL);
-        return NULL;
+        goto fail;
     }
 
-    calculate_initial_areas(heap, areas, points_data, prev_vertex, next_vertex, num_points);
+    // Size and allocate one flat output per threshold
+    for (int j = 0; j < num_thresholds; j++) {
+        npy_intp offsets_dims[1] = {num_rings + 1};
+        out_offsets[j] = (PyArrayObject*)PyArray_SimpleNew(1, offsets_dims, NPY_INT64);
+        if (!out_offsets[j])
+            goto fail;
 
-    // Create result list and sort resolutions
-    PyObject* result_list = PyList_New(num_resolutions);
-    if (!result_list) {
-        cleanup_resources(prev_vertex, next_vertex, active, areas, heap, NULL);
+        npy_int64* out_off = (npy_int64*)PyArray_DATA(out_offsets[j]);
+        out_off[0] = 0;
+        for (npy_intp r = 0; r < num_rings; r++) {
+            VertexIndex kept = coverage_count_kept(&vertex_areas[offsets[r]],
+                                                   in.ring_vertices[r], thresholds[j]);
+            out_off[r + 1] = out_off[r] + (kept > 0 ? kept + 1 : 0);  // +1 for closure point
+        }
+
+        npy_intp coords_dims[2] = {out_off[num_rings], in.coords.dims};
+        out_coords[j] = (PyArrayObject*)PyArray_SimpleNew(2, coords_dims,
+                                                          coord_npy_type(in.coords.type));
+        if (!out_coords[j])
+            goto fail;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    for (int j = 0; j < num_thresholds; j++) {
+        const npy_int64* out_off = (const npy_int64*)PyArray_DATA(out_offsets[j]);
+        size_t point_size = in.coords.dims * coord_size(in.coords.type);
+        for (npy_intp r = 0; r < num_rings; r++) {
+            Coords ring = coords_slice(&in.coords, offsets[r]);
+            coverage_extract(&ring, &vertex_areas[offsets[r]], in.ring_vertices[r],
+                             thresholds[j],
+                             (char*)PyArray_DATA(out_coords[j]) + point_size * out_off[r]);
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    // Package results as (coords, offsets) tuples in input order
+    result_list = PyList_New(num_thresholds);
+    if (!result_list)
+        goto fail;
+
+    for (int j = 0; j < num_thresholds; j++) {
+        PyObject* item = PyTuple_Pack(2, (PyObject*)out_coords[j], (PyObject*)out_offsets[j]);
+        if (!item)
+            goto fail;
+        PyList_SET_ITEM(result_list, j, item);
+    }
+
+fail:
+    if (out_coords && out_offsets) {
+        for (int j = 0; j < num_thresholds; j++) {
+            Py_XDECREF(out_coords[j]);
+            Py_XDECREF(out_offsets[j]);
+        }
+    }
+    if (PyErr_Occurred())
+        Py_CLEAR(result_list);
+    free(out_coords);
+    free(out_offsets);
+    free(vertex_areas);
+    Py_XDECREF(thresholds_obj);
+    batch_input_release(&in);
+    return result_list;
+}
+
+PyObject* visvalingam_tolerance_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"points", "areas", "closed", "safe", "metric", "return_indices",
+                             NULL};
+    PyObject *points_arg, *thresholds_arg;
+    int closed = 1;
+    int safe = 0;
+    const char* metric_name = "area";
+    int return_indices = 0;
+    AreaMetric metric;
+
+    // Parse input arguments
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|ppsp", kwlist, &points_arg,
+                                     &thresholds_arg, &closed, &safe, &metric_name,
+                                     &return_indices))
+        return NULL;
+    if (metric_from_name(metric_name, &metric) != 0)
+        return NULL;
+
+    Coords coords;
+    PyArrayObject* points_obj = points_from_object(points_arg, "Points", &coords);
+    if (!points_obj)
+        return NULL;
+    if (check_metric_dims(metric, &coords) != 0) {
+        Py_DECREF(points_obj);
+        return NULL;
+    }
+    PyArrayObject* thresholds_obj = (PyArrayObject*)PyArray_FROMANY(
+        thresholds_arg, NPY_DOUBLE, 1, 1, NPY_ARRAY_IN_ARRAY);
+    if (!thresholds_obj) {
+        Py_DECREF(points_obj);
         return NULL;
     }
 
-    int* sorted_resolutions = sort_resolutions(resolutions, num_resolutions);
-    if (!sorted_resolutions) {
-        Py_DECREF(result_list);
-        cleanup_resources(prev_vertex, next_vertex, active, areas, heap, NULL);
+    PyObject* result_list = NULL;
+    Workspace* ws = NULL;
+    int* order = NULL;
+
+    const double* thresholds = (const double*)PyArray_DATA(thresholds_obj);
+    int num_thresholds = (int)PyArray_DIM(thresholds_obj, 0);
+    if (check_ring_size(PyArray_DIM(points_obj, 0)) != 0)
+        goto fail;
+    VertexIndex num_points = (VertexIndex)PyArray_DIM(points_obj, 0);
+    if (closed)
+        num_points = ring_vertex_count(&coords, num_points);
+
+    if (num_points < min_vertices(closed)) {
+        PyErr_SetString(PyExc_ValueError, closed ?
+                        "Ring must have at least 3 distinct vertices" :
+                        "Line must have at least 2 vertices");
+        goto fail;
+    }
+
+    ws = scratch_acquire(num_points);
+    order = malloc((num_thresholds > 0 ? num_thresholds : 1) * sizeof(int));
+    if (!ws || !order) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+
+    result_list = PyList_New(num_thresholds);
+    if (!result_list)
+        goto fail;
+
+    order_thresholds(thresholds, num_thresholds, order);
+
+    int failed = 0;
+    Py_BEGIN_ALLOW_THREADS
+
+    ws->metric = metric;
+    simplify_begin(ws, &coords, num_points, closed);
+    if (safe && simplify_guard_intersections(ws, &coords) != 0)
+        failed = 1;
+
+    // Smallest threshold first, so every result continues the same pass
+    for (int k = 0; k < num_thresholds && !failed; k++) {
+        int i = order[k];
+        simplify_to_area(ws, &coords, thresholds[i]);
+
+        // The output size is only known now, so briefly take the GIL back
+        Py_BLOCK_THREADS
+        PyArrayObject* result_obj = create_result_array(ws->active_count, &coords, closed,
+                                                        return_indices);
+        if (result_obj)
+            PyList_SET_ITEM(result_list, i, (PyObject*)result_obj);
+        else
+            failed = 1;
+        Py_UNBLOCK_THREADS
+
+        if (result_obj)
+            extract_result(ws, &coords, closed, return_indices, PyArray_DATA(result_obj));
+    }
+    if (safe && ws->grid && ws->grid->failed)
+        failed = 1;
+
+    Py_END_ALLOW_THREADS
+
+    if (failed) {
+        if (!PyErr_Occurred())
+            PyErr_NoMemory();
+        Py_CLEAR(result_list);
+    }
+
+fail:
+    scratch_release(ws);
+    free(order);
+    Py_DECREF(points_obj);
+    Py_DECREF(thresholds_obj);
+    return result_list;
+}
+
+PyObject* visvalingam_parallel_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"points", "resolutions", "num_threads", "closed", "metric", NULL};
+    PyObject *points_arg, *resolutions_arg;
+    int num_threads = 0;
+    int closed = 1;
+    const char* metric_name = "area";
+    AreaMetric metric;
+
+    // Parse input arguments
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|ips", kwlist, &points_arg,
+                                     &resolutions_arg, &num_threads, &closed, &metric_name))
+        return NULL;
+    if (metric_from_name(metric_name, &metric) != 0)
+        return NULL;
+    if (num_threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "num_threads must be >= 0");
         return NULL;
     }
+    if (num_threads == 0)
+        num_threads = cpu_count();
 
-    // Main simplification loop
-    int active_count = num_points;
-    int res_idx = 0;
+    Coords coords;
+    PyArrayObject* points_obj = points_from_object(points_arg, "Points", &coords);
+    if (!points_obj)
+        return NULL;
 
-    while (res_idx < num_resolutions && active_count > 3) {
-        int target = sorted_resolutions[res_idx];
+    PyObject* result_list = NULL;
+    int* order = NULL;
+    void** result_data = NULL;
+    int num_resolutions;
+    int* resolutions = int_values_from_object(resolutions_arg, "Resolutions", &num_resolutions);
+    if (!resolutions || check_metric_dims(metric, &coords) != 0)
+        goto fail;
 
-        // Simplify until we reach target resolution
-        while (active_count > target) {
-            HeapItem min_item = heap_pop(heap);
-            int vertex_idx = min_item.index;
+    if (check_ring_size(PyArray_DIM(points_obj, 0)) != 0)
+        goto fail;
+    VertexIndex num_points = (VertexIndex)PyArray_DIM(points_obj, 0);
+    if (closed)
+        num_points = ring_vertex_count(&coords, num_points);
 
-            // Skip if vertex already removed or area outdated
-            if (!active[vertex_idx] || min_item.area != areas[vertex_idx])
-                continue;
+    for (int i = 0; i < num_resolutions; i++) {
+        if (resolutions[i] >= num_points || resolutions[i] < min_vertices(closed)) {
+            PyErr_Format(PyExc_ValueError,
+                         "Invalid resolution: must be between %d and %lld, is: %d",
+                         min_vertices(closed), (long long)num_points - 1, resolutions[i]);
+            goto fail;
+        }
+    }
 
-            // Remove vertex
-            active[vertex_idx] = 0;
-            active_count--;
-
-            // Update links
-            int prev_idx = prev_vertex[vertex_idx];
-            int next_idx = next_vertex[vertex_idx];
-            next_vertex[prev_idx] = next_idx;
-            prev_vertex[next_idx] = prev_idx;
-
-            // Update areas of adjacent vertices
-            for (int adj_idx = 0; adj_idx < 2; adj_idx++) {
-                int idx = adj_idx == 0 ? prev_idx : next_idx;
-                if (active[idx]) {
-                    double new_area = triangle_area(
-                        &points_data[2 * prev_vertex[idx]],
-                        &points_data[2 * idx],
-                        &points_data[2 * next_vertex[idx]]
-                    );
-                    areas[idx] = new_area;
-                    heap_push(heap, new_area, idx);
-                }
+    order = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(int));
+    result_data = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(void*));
+    if (!order || !result_data) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+    result_list = PyList_New(num_resolutions);
+    if (!result_list)
+        goto fail;
+    order_resolutions(resolutions, num_resolutions, order);
+
+    // Repeats of a target share the array of its first occurrence
+    PyArrayObject* shared = NULL;
+    for (int k = 0; k < num_resolutions; k++) {
+        int j = order[k];
+        if (repeated_target(resolutions, order, k)) {
+            Py_INCREF(shared);
+        } else {
+            shared = create_result_array(resolutions[j], &coords, closed, 0);
+            if (!shared) {
+                Py_CLEAR(result_list);
+                goto fail;
             }
         }
+        PyList_SET_ITEM(result_list, j, (PyObject*)shared);
+        result_data[j] = PyArray_DATA(shared);
+    }
 
-        // Create result array for current resolution
-        PyArrayObject* result_obj = create_result_array(target);
-        if (!result_obj) {
-            Py_DECREF(result_list);
-            cleanup_resources(prev_vertex, next_vertex, active, areas, heap, sorted_resolutions);
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = chunked_simplify(&coords, num_points, closed, metric, resolutions, order,
+                              num_resolutions, num_threads, result_data);
+    Py_END_ALLOW_THREADS
+    if (status != 0) {
+        PyErr_NoMemory();
+        Py_CLEAR(result_list);
+    }
+
+fail:
+    free(order);
+    free(result_data);
+    free(resolutions);
+    Py_DECREF(points_obj);
+    return result_list;
+}
+
+PyObject* visvalingam_file_c(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"path", "resolutions", "out_path", "dtype", "offset",
+                             "stride", "closed", "metric", NULL};
+    const char *path, *out_path;
+    PyObject* resolutions_arg;
+    const char* dtype = "float64";
+    Py_ssize_t offset = 0, stride = 0;
+    int closed = 1;
+    const char* metric_name = "area";
+    AreaMetric metric;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sOs|snnps", kwlist, &path,
+                                     &resolutions_arg, &out_path, &dtype, &offset,
+                                     &stride, &closed, &metric_name))
+        return NULL;
+    if (metric_from_name(metric_name, &metric) != 0)
+        return NULL;
+
+    Coords coords;
+    if (strcmp(dtype, "float64") == 0)
+        coords.type = COORD_FLOAT64;
+    else if (strcmp(dtype, "float32") == 0)
+        coords.type = COORD_FLOAT32;
+    else {
+        PyErr_SetString(PyExc_ValueError, "dtype must be 'float64' or 'float32'");
+        return NULL;
+    }
+    Py_ssize_t item = (Py_ssize_t)coord_size(coords.type);
+    if (stride == 0)
+        stride = 2 * item;
+    if (offset < 0 || offset % item != 0 || stride < 2 * item || stride % item != 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "offset and stride must be multiples of the item size, "
+                        "with stride covering both coordinates");
+        return NULL;
+    }
+
+    int num_resolutions;
+    int* resolutions = int_values_from_object(resolutions_arg, "Resolutions", &num_resolutions);
+    if (!resolutions)
+        return NULL;
+    for (int i = 0; i < num_resolutions; i++) {
+        if (resolutions[i] < min_vertices(closed)) {
+            PyErr_Format(PyExc_ValueError, "Invalid resolution: must be >= %d, is: %d",
+                         min_vertices(closed), resolutions[i]);
+            free(resolutions);
             return NULL;
         }
+    }
 
-        // Find first active vertex
-        int curr_idx = 0;
-        while (!active[curr_idx]) curr_idx++;
+    MappedFile file;
+    if (mapped_file_open(&file, path) != 0) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+        free(resolutions);
+        return NULL;
+    }
 
-        // Extract simplified polygon
-        double* result_data = (double*)PyArray_DATA(result_obj);
-        extract_simplified(points_data, next_vertex, active, curr_idx, target, result_data);
+    PyArrayObject* offsets_obj = NULL;
+    int* order = NULL;
+    FILE* out = NULL;
 
-        // Add to result list at appropriate position
-        for (int i = 0; i < num_resolutions; i++) {
-            if (resolutions[i] == target) {
-                PyList_SET_ITEM(result_list, i, (PyObject*)result_obj);
-            }
-        }
+    // Count the points whose x and y both lie inside the file
+    int64_t available = file.size - (int64_t)offset;
+    npy_intp num_points = available >= 2 * item ?
+        (npy_intp)((available - 2 * item) / stride + 1) : 0;
+    if (check_ring_size(num_points) != 0)
+        goto fail;
+    coords.data = file.data + offset;
+    coords.stride = stride;
+    coords.col_stride = item;
+    coords.dims = 2;
+    if (check_metric_dims(metric, &coords) != 0)
+        goto fail;
 
-        res_idx++;
+    VertexIndex ring_points = (VertexIndex)num_points;
+    if (closed && ring_points > 0)
+        ring_points = ring_vertex_count(&coords, ring_points);
+    if (ring_points < min_vertices(closed)) {
+        PyErr_Format(PyExc_ValueError, "File holds %zd points, need at least %d",
+                     (Py_ssize_t)ring_points, min_vertices(closed));
+        goto fail;
     }
 
-    // Clean up
-    cleanup_resources(prev_vertex, next_vertex, active, areas, heap, sorted_resolutions);
+    npy_intp dims[1] = {num_resolutions + 1};
+    offsets_obj = (PyArrayObject*)PyArray_SimpleNew(1, dims, NPY_INT64);
+    order = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(int));
+    if (!offsets_obj || !order) {
+        if (!PyErr_Occurred())
+            PyErr_NoMemory();
+        goto fail;
+    }
+    order_resolutions(resolutions, num_resolutions, order);
 
-    return result_list;
+    // Truncating the mapped input would fault the reads below
+    if (same_file(path, out_path)) {
+        PyErr_SetString(PyExc_ValueError, "out_path must not be the input file");
+        goto fail;
+    }
+    out = fopen(out_path, "wb");
+    if (!out) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, out_path);
+        goto fail;
+    }
+
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = stream_simplify(&coords, ring_points, closed, metric, resolutions, order,
+                             num_resolutions, out, (int64_t*)PyArray_DATA(offsets_obj));
+    Py_END_ALLOW_THREADS
+
+    if (status == -2)
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, out_path);
+    else if (status != 0)
+        PyErr_NoMemory();
+    if (fclose(out) != 0 && status == 0) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, out_path);
+        status = -2;
+    }
+    out = NULL;
+    if (status != 0)
+        goto fail;
+
+    free(order);
+    free(resolutions);
+    mapped_file_close(&file);
+    return (PyObject*)offsets_obj;
+
+fail:
+    if (out)
+        fclose(out);
+    Py_XDECREF(offsets_obj);
+    free(order);
+    free(resolutions);
+    mapped_file_close(&file);
+    return NULL;
+}
+
+PyObject* get_stats_c(PyObject* self, PyObject* args) {
+#ifdef SIMPLIFY_STATS
+    const SimplifyStats* stats = &last_stats;
+    return Py_BuildValue("{s:L,s:L,s:L,s:L,s:L,s:L,s:d,s:d,s:d}",
+                         "heap_pushes", (long long)stats->heap_pushes,
+                         "heap_pops", (long long)stats->heap_pops,
+                         "heap_updates", (long long)stats->heap_updates,
+                         "safe_refusals", (long long)stats->safe_refusals,
+                         "peak_heap_size", (long long)stats->peak_heap_size,
+                         "reallocs", (long long)stats->reallocs,
+                         "init_seconds", stats->init_seconds,
+                         "simplify_seconds", stats->simplify_seconds,
+                         "extract_seconds", stats->extract_seconds);
+#else
+    Py_RETURN_NONE;
+#endif
+}
+
+PyObject* release_scratch_c(PyObject* self, PyObject* args) {
+    scratch_clear();
+    Py_RETURN_NONE;
 }
 
 // Module setup functions
 static PyMethodDef VisvalingamMethods[] = {
-    {"simplify_multi", visvalingam_whyatt_multi_c, METH_VARARGS,
+    {"simplify_multi", (PyCFunction)(void(*)(void))visvalingam_whyatt_multi_c,
+     METH_VARARGS | METH_KEYWORDS,
      "Simplify polygon to multiple resolutions using Visvalingam-Whyatt algorithm"},
+    {"simplify_batch", (PyCFunction)(void(*)(void))visvalingam_batch_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Simplify many rings stored in a flat coordinate buffer with ring offsets"},
+    {"simplify_polygons", (PyCFunction)(void(*)(void))visvalingam_polygons_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Simplify every ring of polygons and multipolygons in a flat offset layout"},
+    {"simplify_arrow", (PyCFunction)(void(*)(void))visvalingam_arrow_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Simplify a GeoArrow array from the Arrow PyCapsule interface into new Arrow arrays"},
+    {"simplify_coverage", visvalingam_coverage_c, METH_VARARGS,
+     "Simplify a polygon coverage once per shared arc, keeping shared edges identical"},
+    {"simplify_batch_size", (PyCFunction)(void(*)(void))visvalingam_batch_size_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Number of output points simplify_batch produces for each resolution"},
+    {"simplify_tolerance", (PyCFunction)(void(*)(void))visvalingam_tolerance_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Simplify polygon until the smallest effective area exceeds each threshold"},
+    {"build_index", (PyCFunction)(void(*)(void))build_index_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Precompute the elimination order of a ring for repeated extraction"},
+    {"build_simplifier", (PyCFunction)(void(*)(void))build_simplifier_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Keep the simplification state of a ring to re-simplify it after local edits"},
+    {"simplify_parallel", (PyCFunction)(void(*)(void))visvalingam_parallel_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Simplify one large ring on several threads by splitting it into chunks"},
+    {"simplify_file", (PyCFunction)(void(*)(void))visvalingam_file_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Simplify a ring stored in a raw coordinate file, streaming results to another"},
+    {"create_cache", (PyCFunction)(void(*)(void))create_cache_c,
+     METH_VARARGS | METH_KEYWORDS,
+     "Create a bounded cache of elimination orders for simplify_multi and build_index"},
+    {"get_stats", get_stats_c, METH_NOARGS,
+     "Hot-path counters of the last simplify_multi call, or None unless built with SIMPLIFY_STATS"},
+    {"release_scratch", release_scratch_c, METH_NOARGS,
+     "Free the idle workspaces of the scratch pool"},
     {NULL, NULL, 0, NULL}
 };
 
@@ -291,5 +1553,39 @@ static struct PyModuleDef visvalingam_module = {
 
 PyMODINIT_FUNC PyInit_visvalingam_c(void) {
     import_array();
-    return PyModule_Create(&visvalingam_module);
+    scratch_init();
+
+    if (PyType_Ready(&VWIndexType) < 0 || PyType_Ready(&VWSimplifierType) < 0 ||
+        PyType_Ready(&VWArrowArrayType) < 0 || PyType_Ready(&VWCacheType) < 0)
+        return NULL;
+
+    PyObject* module = PyModule_Create(&visvalingam_module);
+    if (!module)
+        return NULL;
+
+    Py_INCREF(&VWIndexType);
+    if (PyModule_AddObject(module, "VWIndex", (PyObject*)&VWIndexType) < 0) {
+        Py_DECREF(&VWIndexType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&VWSimplifierType);
+    if (PyModule_AddObject(module, "VWSimplifier", (PyObject*)&VWSimplifierType) < 0) {
+        Py_DECREF(&VWSimplifierType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&VWArrowArrayType);
+    if (PyModule_AddObject(module, "VWArrowArray", (PyObject*)&VWArrowArrayType) < 0) {
+        Py_DECREF(&VWArrowArrayType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&VWCacheType);
+    if (PyModule_AddObject(module, "VWCache", (PyObject*)&VWCacheType) < 0) {
+        Py_DECREF(&VWCacheType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    return module;
 }
\ No newline at end of file
@@ -17,12 +17,189 @@
  * @brief Python-callable function to perform multi-resolution polygon simplification
  *
  * Takes a polygon and list of target resolutions, returns a list of simplified
- * polygons at each requested resolution.
+ * polygons at each requested resolution. The GIL is released while the
+ * elimination loop runs. With closed=False the points are an open line
+ * whose endpoints are always kept and no closure point is added. With
+ * safe=True removals that would make the ring intersect itself are
+ * refused, so a result may keep more vertices than its resolution.
+ * Points may have more than two columns, all of which are carried to
+ * the output; with return_indices=True the kept rows are returned as
+ * int64 indices instead. With a VWCache as cache, rings whose
+ * elimination order is cached are served from it without the heap.
  *
- * @param self Python module self reference (unused)
- * @param args Tuple containing points array and resolutions array
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing points array and resolutions array
+ * @param kwargs Optional keyword arguments (closed, safe)
  * @return PyObject* List of numpy arrays containing simplified polygons
  */
-PyObject* visvalingam_whyatt_multi_c(PyObject* self, PyObject* args);
+PyObject* visvalingam_whyatt_multi_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+/**
+ * @brief Python-callable function to simplify many rings in one call
+ *
+ * Takes a flat (N, 2) coordinate array, a ring offsets array of length
+ * num_rings + 1 and a list of target resolutions. Rings are simplified one
+ * after another using a single shared workspace. Rings with no more
+ * vertices than a target are returned unchanged; with closed=False every
+ * ring is simplified as an open line. The optional num_threads
+ * argument spreads the rings over several threads (0 uses every CPU).
+ * The GIL is released while rings are simplified.
+ *
+ * The optional out and out_offsets arrays receive the results in place of
+ * newly allocated arrays; the returned tuples are then views into them.
+ * Resolution j is written to the rows of out following those of the
+ * resolutions before it, and its offsets to row j of out_offsets.
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing coordinates, offsets and resolutions arrays
+ * @param kwargs Optional keyword arguments (num_threads, out, out_offsets, closed)
+ * @return PyObject* List with one (coords, offsets) tuple per resolution
+ */
+PyObject* visvalingam_batch_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+/**
+ * @brief Python-callable function to size simplify_batch output buffers
+ *
+ * Takes the same coordinates, offsets and resolutions as simplify_batch
+ * and returns the number of output points, closure points included, that
+ * each resolution produces. No simplification is done.
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing coordinates, offsets and resolutions arrays
+ * @param kwargs Optional keyword arguments (closed)
+ * @return PyObject* int64 array with one point count per resolution
+ */
+PyObject* visvalingam_batch_size_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+/**
+ * @brief Python-callable function to simplify polygons and multipolygons
+ *
+ * Takes the GeoArrow polygon layout: flat (N, 2) coordinates, ring offsets
+ * into the coordinates, polygon offsets into the rings whose first ring is
+ * the exterior, and optionally multipolygon part offsets into the polygons.
+ * Every ring is simplified to each target resolution as in simplify_batch,
+ * keeping at least 3 vertices, in a single pass over shared scratch memory.
+ * Accepts the num_threads, out and out_offsets keywords of simplify_batch.
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing coordinates, ring offsets, polygon offsets
+ *               and resolutions arrays
+ * @param kwargs Optional keyword arguments (part_offsets, num_threads, out,
+ *               out_offsets)
+ * @return PyObject* List with one (coords, ring_offsets, polygon_offsets[,
+ *         part_offsets]) tuple per resolution
+ */
+PyObject* visvalingam_polygons_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+/**
+ * @brief Python-callable function to simplify a GeoArrow array
+ *
+ * Takes any object implementing the Arrow PyCapsule interface holding a
+ * native GeoArrow linestring, polygon, multilinestring or multipolygon
+ * array, with interleaved or separated float64 or float32 coordinates.
+ * The coordinates and offsets are read in place and every innermost list
+ * is simplified as in simplify_batch. Lines are kept open and polygon
+ * rings closed, from the extension name, unless closed is given. Point
+ * arrays are rejected. The GIL is released while rings are simplified.
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing the Arrow array and resolutions array
+ * @param kwargs Optional keyword arguments (num_threads, closed, metric)
+ * @return PyObject* List of VWArrowArray objects, one per resolution, that
+ *         export the simplified arrays through __arrow_c_array__
+ */
+PyObject* visvalingam_arrow_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+/**
+ * @brief Python-callable function to simplify a polygon coverage
+ *
+ * Takes the rings of a whole coverage as flat (N, 2) coordinates and ring
+ * offsets, plus a list of area thresholds. Rings are split into arcs at
+ * junctions, every distinct arc is simplified once by effective area with
+ * its junctions pinned, and every ring is rebuilt from its arcs for each
+ * threshold, so shared boundaries stay identical in all rings. The GIL is
+ * released while arcs are simplified and rings are written.
+ *
+ * @param self Python module self reference (unused)
+ * @param args Tuple containing coordinates, ring offsets and thresholds arrays
+ * @return PyObject* List with one (coords, offsets) tuple per threshold
+ */
+PyObject* visvalingam_coverage_c(PyObject* self, PyObject* args);
+
+/**
+ * @brief Python-callable function to simplify a polygon by area tolerance
+ *
+ * Takes a polygon and a list of area thresholds. For every threshold the
+ * elimination stops once the smallest remaining effective area exceeds it.
+ * Thresholds are processed in ascending order within a single pass. With
+ * safe=True removals that would make the ring intersect itself are refused.
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing points array and thresholds array
+ * @param kwargs Optional keyword arguments (closed, safe)
+ * @return PyObject* List of numpy arrays, one per threshold in input order
+ */
+PyObject* visvalingam_tolerance_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+/**
+ * @brief Python-callable function to simplify one large ring on several threads
+ *
+ * Splits the ring into chunks with pinned ends, eliminates every chunk on
+ * its own thread and replays the chunk eliminations in global area order,
+ * giving live areas to the few vertices near the joins. Results match
+ * simplify_multi up to the order of equal areas. Rings too small to split
+ * are simplified on the calling thread. The GIL is released while it runs.
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing points array and resolutions array
+ * @param kwargs Optional keyword arguments (num_threads, closed, metric)
+ * @return PyObject* List of numpy arrays, one per resolution in input order
+ */
+PyObject* visvalingam_parallel_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+/**
+ * @brief Python-callable function to simplify a ring stored in a raw file
+ *
+ * Maps a file of interleaved x,y values read-only and simplifies the ring
+ * or line it holds to every target resolution, writing the results to
+ * out_path as raw values of the same dtype, each ring followed by its
+ * closure point. Resolution j starts at the point offset returned in row
+ * j; resolutions of at least the input size copy it unchanged. Only the
+ * workspace is allocated, so the file may be far larger than the memory
+ * the process would need to load it. The GIL is released while it runs.
+ *
+ * @param self   Python module self reference (unused)
+ * @param args   Tuple containing the input path, resolutions and output path
+ * @param kwargs Optional keyword arguments (dtype, offset, stride, closed, metric)
+ * @return PyObject* int64 array of num_resolutions + 1 point offsets into out_path
+ */
+PyObject* visvalingam_file_c(PyObject* self, PyObject* args, PyObject* kwargs);
+
+/**
+ * @brief Python-callable function to read the hot-path counters
+ *
+ * Returns the counters of the most recent simplify_multi call as a dict:
+ * heap pushes, pops and in-place updates, removals refused by safe mode,
+ * the peak heap size, working buffer allocations and the seconds spent
+ * initialising, simplifying and extracting. Returns None unless the
+ * module was built with SIMPLIFY_STATS.
+ *
+ * @param self Python module self reference (unused)
+ * @param args Unused
+ * @return PyObject* Dict of counters or None
+ */
+PyObject* get_stats_c(PyObject* self, PyObject* args);
+
+/**
+ * @brief Python-callable function freeing the idle scratch workspaces
+ *
+ * Workspaces in use by other threads are kept and return to the pool
+ * when released.
+ *
+ * @param self Python module self reference (unused)
+ * @param args Unused
+ * @return PyObject* None
+ */
+PyObject* release_scratch_c(PyObject* self, PyObject* args);
 
 #endif /* VISVALINGAM_H */
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include <stdlib.h>
+#include "vw.h"
+#include "batch.h"
+#include "elimination.h"
+#include "parallel.h"
+#include "scratch.h"
+
+/**
+ * @struct VWIndex
+ * @brief Public handle of an elimination index
+ */
+struct VWIndex {
+    EliminationIndex* elimination;
+};
+
+/**
+ * @brief Check a VWPoints and describe it as a Coords view
+ *
+ * VWCoordType and VWMetric list their values in the order of CoordType
+ * and AreaMetric, so both convert by value.
+ *
+ * @param points Caller's points
+ * @param metric Metric the points will be ranked by
+ * @param coords Receives the view
+ * @return int VW_OK or VW_ERROR_INVALID
+ */
+static int points_view(const VWPoints* points, int metric, Coords* coords) {
+    if (!points || points->num_points < 0 || (points->num_points > 0 && !points->data))
+        return VW_ERROR_INVALID;
+    if ((points->type != VW_FLOAT64 && points->type != VW_FLOAT32) || points->dims < 2)
+        return VW_ERROR_INVALID;
+    if (metric < 0 || metric >= NUM_METRICS || (metric == METRIC_AREA_3D && points->dims < 3))
+        return VW_ERROR_INVALID;
+
+    coords->type = (CoordType)points->type;
+    coords->dims = points->dims;
+    coords->data = (const char*)points->data;
+    coords->col_stride = (ptrdiff_t)coord_size(coords->type);
+    coords->stride = points->stride != 0 ? (ptrdiff_t)points->stride
+                                         : coords->dims * coords->col_stride;
+    return VW_OK;
+}
+
+/**
+ * @brief Number of distinct vertices of the ring starting at a view
+ *
+ * @param coords     Ring or line coordinates
+ * @param num_points Number of points, at most MAX_RING_VERTICES
+ * @param closed     Nonzero for a ring, zero for an open line
+ * @return VertexIndex Vertices to simplify
+ */
+static VertexIndex ring_points(const Coords* coords, int64_t num_points, int closed) {
+    return closed ? ring_vertex_count(coords, (VertexIndex)num_points) : (VertexIndex)num_points;
+}
+
+/**
+ * @brief Number of output points of one ring at one resolution
+ *
+ * @param resolution    Target resolution
+ * @param ring_vertices Number of distinct vertices of the ring
+ * @param closed        Nonzero for rings, zero for open lines
+ * @return int64_t Output points including the closure point, 0 for empty rings
+ */
+static int64_t output_size(int resolution, VertexIndex ring_vertices, int closed) {
+    VertexIndex target = resolution < ring_vertices ? resolution : ring_vertices;
+    return target > 0 ? target + (closed ? 1 : 0) : 0;  // +1 for closure point
+}
+
+/**
+ * @brief Check resolutions and order them by descending resolution
+ *
+ * @param resolutions     Target resolutions
+ * @param num_resolutions Number of resolutions
+ * @param closed          Nonzero for rings, zero for open lines
+ * @param order           Receives num_resolutions indices, as from order_resolutions
+ * @return int VW_OK, or VW_ERROR_INVALID if a resolution is below min_vertices(closed)
+ */
+static int check_resolutions(const int* resolutions, int num_resolutions, int closed,
+                             int* order) {
+    if (num_resolutions > 0 && !resolutions)
+        return VW_ERROR_INVALID;
+    for (int i = 0; i < num_resolutions; i++) {
+        if (resolutions[i] < min_vertices(closed))
+            return VW_ERROR_INVALID;
+    }
+    order_resolutions(resolutions, num_resolutions, order);
+    return VW_OK;
+}
+
+/**
+ * @brief Check the ring offsets of a batch against its coordinates
+ *
+ * @param points    Coordinates of the batch
+ * @param offsets   num_rings + 1 point offsets
+ * @param num_rings Number of rings
+ * @return int VW_OK or VW_ERROR_INVALID
+ */
+static int check_offsets(const VWPoints* points, const int64_t* offsets, int64_t num_rings) {
+    if (!offsets || num_rings < 0 || offsets[0] < 0 || offsets[num_rings] > points->num_points)
+        return VW_ERROR_INVALID;
+    for (int64_t r = 0; r < num_rings; r++) {
+        int64_t ring_size = offsets[r + 1] - offsets[r];
+        if (ring_size < 0 || ring_size > MAX_RING_VERTICES)
+            return VW_ERROR_INVALID;
+    }
+    return VW_OK;
+}
+
+void vw_init(void) {
+    scratch_init();
+}
+
+void vw_release_scratch(void) {
+    scratch_clear();
+}
+
+int vw_api_version(void) {
+    return VW_API_VERSION;
+}
+
+int64_t vw_max_ring_vertices(void) {
+    return MAX_RING_VERTICES;
+}
+
+int64_t vw_output_size(const VWPoints* points, int closed, int resolution) {
+    Coords coords;
+    if (points_view(points, METRIC_AREA, &coords) != VW_OK ||
+        points->num_points > MAX_RING_VERTICES || resolution < min_vertices(closed))
+        return VW_ERROR_INVALID;
+    return output_size(resolution, ring_points(&coords, points->num_points, closed), closed);
+}
+
+int vw_simplify(const VWPoints* points, int closed, int metric, const int* resolutions,
+                int num_resolutions, void* const* out) {
+    Coords coords;
+    int status = points_view(points, metric, &coords);
+    if (status != VW_OK)
+        return status;
+    if (points->num_points > MAX_RING_VERTICES || num_resolutions < 0 ||
+        (num_resolutions > 0 && !out))
+        return VW_ERROR_INVALID;
+
+    // One ring is a batch of one, whose every result starts at offset 0
+    static const int64_t zero_offset = 0;
+    int64_t offsets[2] = {0, points->num_points};
+    VertexIndex ring_vertices = ring_points(&coords, points->num_points, closed);
+    int* order = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(int));
+    const int64_t** out_offsets = malloc((num_resolutions > 0 ? num_resolutions : 1) *
+                                         sizeof(int64_t*));
+    Workspace* ws = NULL;
+
+    if (!order || !out_offsets) {
+        status = VW_ERROR_MEMORY;
+        goto done;
+    }
+    status = check_resolutions(resolutions, num_resolutions, closed, order);
+    if (status != VW_OK)
+        goto done;
+    for (int j = 0; j < num_resolutions; j++)
+        out_offsets[j] = &zero_offset;
+
+    BatchJob job = {
+        coords, offsets, &ring_vertices, 1, resolutions, order, num_resolutions, out,
+        out_offsets, closed, (AreaMetric)metric, 0
+    };
+    ws = scratch_acquire(ring_vertices);
+    if (!ws || batch_run_range(ws, &job, 0, 1) != 0)
+        status = VW_ERROR_MEMORY;
+
+done:
+    scratch_release(ws);
+    free(order);
+    free(out_offsets);
+    return status;
+}
+
+int vw_batch_offsets(const VWPoints* coords, const int64_t* offsets, int64_t num_rings,
+                     int closed, int resolution, int64_t* out_offsets) {
+    Coords view;
+    int status = points_view(coords, METRIC_AREA, &view);
+    if (status == VW_OK)
+        status = check_offsets(coords, offsets, num_rings);
+    if (status != VW_OK || !out_offsets || resolution < min_vertices(closed))
+        return VW_ERROR_INVALID;
+
+    out_offsets[0] = 0;
+    for (int64_t r = 0; r < num_rings; r++) {
+        Coords ring = coords_slice(&view, offsets[r]);
+        VertexIndex ring_vertices = ring_points(&ring, offsets[r + 1] - offsets[r], closed);
+        out_offsets[r + 1] = out_offsets[r] + output_size(resolution, ring_vertices, closed);
+    }
+    return VW_OK;
+}
+
+int vw_simplify_batch(const VWPoints* coords, const int64_t* offsets, int64_t num_rings,
+                      int closed, int metric, const int* resolutions, int num_resolutions,
+                      int num_threads, void* const* out_coords,
+                      const int64_t* const* out_offsets) {
+    Coords view;
+    int status = points_view(coords, metric, &view);
+    if (status == VW_OK)
+        status = check_offsets(coords, offsets, num_rings);
+    if (status != VW_OK || num_threads < 0 || num_resolutions < 0 ||
+        (num_resolutions > 0 && (!out_coords || !out_offsets)))
+        return VW_ERROR_INVALID;
+
+    int* order = malloc((num_resolutions > 0 ? num_resolutions : 1) * sizeof(int));
+    VertexIndex* ring_vertices = malloc((num_rings > 0 ? num_rings : 1) * sizeof(VertexIndex));
+    if (!order || !ring_vertices) {
+        status = VW_ERROR_MEMORY;
+        goto done;
+    }
+    status = check_resolutions(resolutions, num_resolutions, closed, order);
+    if (status != VW_OK)
+        goto done;
+
+    for (int64_t r = 0; r < num_rings; r++) {
+        Coords ring = coords_slice(&view, offsets[r]);
+        ring_vertices[r] = ring_points(&ring, offsets[r + 1] - offsets[r], closed);
+    }
+
+    BatchJob job = {
+        view, offsets, ring_vertices, num_rings, resolutions, order, num_resolutions,
+        out_coords, out_offsets, closed, (AreaMetric)metric, 0
+    };
+    if (batch_run(&job, num_threads > 0 ? num_threads : cpu_count()) != 0)
+        status = VW_ERROR_MEMORY;
+
+done:
+    free(order);
+    free(ring_vertices);
+    return status;
+}
+
+int vw_index_build(const VWPoints* points, int closed, int metric, VWIndex** index) {
+    Coords coords;
+    int status = points_view(points, metric, &coords);
+    if (status != VW_OK)
+        return status;
+    if (!index || points->num_points > MAX_RING_VERTICES)
+        return VW_ERROR_INVALID;
+    *index = NULL;
+
+    VertexIndex num_points = ring_points(&coords, points->num_points, closed);
+    if (num_points < min_vertices(closed))
+        return VW_ERROR_INVALID;
+
+    VWIndex* handle = malloc(sizeof(VWIndex));
+    if (!handle)
+        return VW_ERROR_MEMORY;
+    handle->elimination = elimination_index_build(&coords, num_points, closed,
+                                                  (AreaMetric)metric);
+    if (!handle->elimination) {
+        free(handle);
+        return VW_ERROR_MEMORY;
+    }
+    *index = handle;
+    return VW_OK;
+}
+
+void vw_index_destroy(VWIndex* index) {
+    if (!index)
+        return;
+    elimination_index_destroy(index->elimination);
+    free(index);
+}
+
+int64_t vw_index_num_points(const VWIndex* index) {
+    return index->elimination->num_points;
+}
+
+int vw_index_dims(const VWIndex* index) {
+    return index->elimination->dims;
+}
+
+int64_t vw_index_count_for_area(const VWIndex* index, double threshold) {
+    return elimination_index_count_for_area(index->elimination, threshold);
+}
+
+int vw_index_extract(const VWIndex* index, int64_t target, double* out) {
+    const EliminationIndex* elimination = index->elimination;
+    if (!out || target < min_vertices(elimination->closed) || target > elimination->num_points)
+        return VW_ERROR_INVALID;
+    if (elimination_index_extract(elimination, (VertexIndex)target, out) != 0)
+        return VW_ERROR_MEMORY;
+    return VW_OK;
+}
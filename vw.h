@@ -0,0 +1,246 @@
+/**
+ * @file vw.h
+ * @brief Python-free C API of the Visvalingam-Whyatt engine
+ *
+ * This header is the stable interface of the visvalingam static library,
+ * for C and C++ programs that link the engine directly instead of going
+ * through the Python extension. It depends on no other header of the
+ * repository: points are described by VWPoints, counts are 64-bit in
+ * every build, and every function reports failure with a VWStatus.
+ * Call vw_init once before anything else.
+ */
+
+#ifndef VW_H
+#define VW_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def VW_API_VERSION
+ * @brief Version of this interface, raised on incompatible changes
+ */
+#define VW_API_VERSION 1
+
+/**
+ * @enum VWStatus
+ * @brief Result of every fallible function
+ */
+typedef enum {
+    VW_OK = 0,
+    VW_ERROR_MEMORY = -1,
+    VW_ERROR_INVALID = -2
+} VWStatus;
+
+/**
+ * @enum VWCoordType
+ * @brief Storage type of coordinate values
+ */
+typedef enum {
+    VW_FLOAT64,
+    VW_FLOAT32
+} VWCoordType;
+
+/**
+ * @enum VWMetric
+ * @brief Effective area used to rank vertices, as the metric names of the
+ *        Python module: area, flatness, convexity, signed and area3d
+ */
+typedef enum {
+    VW_METRIC_AREA,
+    VW_METRIC_FLATNESS,
+    VW_METRIC_CONVEXITY,
+    VW_METRIC_SIGNED,
+    VW_METRIC_AREA_3D
+} VWMetric;
+
+/**
+ * @struct VWPoints
+ * @brief Interleaved points read in place
+ *
+ * Every point is dims values of one type; columns past x and y, such as
+ * z or m, are carried into results and only VW_METRIC_AREA_3D reads z.
+ * A ring may repeat its first point at the end or not.
+ *
+ * @param data       Address of the x value of point 0
+ * @param num_points Number of points
+ * @param stride     Bytes between consecutive points, 0 for packed points
+ * @param dims       Values per point, at least 2
+ * @param type       VWCoordType of the values
+ */
+typedef struct {
+    const void* data;
+    int64_t num_points;
+    int64_t stride;
+    int32_t dims;
+    int32_t type;
+} VWPoints;
+
+/** Opaque elimination order of one ring, from vw_index_build */
+typedef struct VWIndex VWIndex;
+
+/**
+ * @brief Prepare the library; later calls do nothing
+ *
+ * Not thread-safe: call it once while a single thread uses the library.
+ */
+void vw_init(void);
+
+/**
+ * @brief Free the idle workspaces the library keeps between calls
+ *
+ * Each pooled workspace keeps the buffers of the largest ring it has
+ * simplified; this returns them. Safe to call from any thread.
+ */
+void vw_release_scratch(void);
+
+/**
+ * @brief Version the library was built with
+ *
+ * @return int VW_API_VERSION of the library
+ */
+int vw_api_version(void);
+
+/**
+ * @brief Largest number of vertices of one ring the library supports
+ *
+ * @return int64_t 2^29 - 1, or more for a VERTEX_INDEX_64 build
+ */
+int64_t vw_max_ring_vertices(void);
+
+/**
+ * @brief Number of points vw_simplify writes for one resolution
+ *
+ * Rings with no more vertices than the resolution are copied unchanged,
+ * and rings get a closure point.
+ *
+ * @param points     Ring or line
+ * @param closed     Nonzero for a ring, zero for an open line
+ * @param resolution Target number of vertices
+ * @return int64_t Points of the result, or VW_ERROR_INVALID
+ */
+int64_t vw_output_size(const VWPoints* points, int closed, int resolution);
+
+/**
+ * @brief Simplify one ring or line to several resolutions
+ *
+ * Runs a single elimination pass on the calling thread. Result j is
+ * written to out[j] as packed points with the type and dims of the input.
+ *
+ * @param points          Ring or line
+ * @param closed          Nonzero for a ring, zero for an open line
+ * @param metric          VWMetric used to rank vertices
+ * @param resolutions     Target resolutions, each at least 3 for rings and 2 for lines
+ * @param num_resolutions Number of resolutions
+ * @param out             out[j] holds vw_output_size(points, closed, resolutions[j]) points
+ * @return int VW_OK, VW_ERROR_MEMORY or VW_ERROR_INVALID
+ */
+int vw_simplify(const VWPoints* points, int closed, int metric, const int* resolutions,
+                int num_resolutions, void* const* out);
+
+/**
+ * @brief Output offsets of a batch at one resolution
+ *
+ * @param coords      Points of every ring, back to back
+ * @param offsets     num_rings + 1 non-decreasing point offsets into coords
+ * @param num_rings   Number of rings
+ * @param closed      Nonzero for rings, zero for open lines
+ * @param resolution  Target number of vertices
+ * @param out_offsets Receives num_rings + 1 point offsets into the output,
+ *                    the last one being the number of output points
+ * @return int VW_OK or VW_ERROR_INVALID
+ */
+int vw_batch_offsets(const VWPoints* coords, const int64_t* offsets, int64_t num_rings,
+                     int closed, int resolution, int64_t* out_offsets);
+
+/**
+ * @brief Simplify many rings to several resolutions
+ *
+ * Rings are balanced over num_threads threads, each with its own
+ * workspace; the results do not depend on the thread count.
+ *
+ * @param coords          Points of every ring, back to back
+ * @param offsets         num_rings + 1 non-decreasing point offsets into coords
+ * @param num_rings       Number of rings
+ * @param closed          Nonzero for rings, zero for open lines
+ * @param metric          VWMetric used to rank vertices
+ * @param resolutions     Target resolutions, each at least 3 for rings and 2 for lines
+ * @param num_resolutions Number of resolutions
+ * @param num_threads     Number of threads, 0 for every CPU
+ * @param out_coords      out_coords[j] holds the packed output points of resolution j
+ * @param out_offsets     out_offsets[j] as filled by vw_batch_offsets for resolution j
+ * @return int VW_OK, VW_ERROR_MEMORY or VW_ERROR_INVALID
+ */
+int vw_simplify_batch(const VWPoints* coords, const int64_t* offsets, int64_t num_rings,
+                      int closed, int metric, const int* resolutions, int num_resolutions,
+                      int num_threads, void* const* out_coords,
+                      const int64_t* const* out_offsets);
+
+/**
+ * @brief Run the elimination of a ring to completion and keep its order
+ *
+ * The index keeps a float64 copy of every column, so points may be freed
+ * afterwards, and serves any vertex count or area threshold without
+ * running the elimination again. Indices are immutable and may be read
+ * from several threads at once.
+ *
+ * @param points Ring or line of at least 3 (ring) or 2 (line) vertices
+ * @param closed Nonzero for a ring, zero for an open line
+ * @param metric VWMetric used to rank vertices
+ * @param index  Receives the new index
+ * @return int VW_OK, VW_ERROR_MEMORY or VW_ERROR_INVALID
+ */
+int vw_index_build(const VWPoints* points, int closed, int metric, VWIndex** index);
+
+/**
+ * @brief Free an index
+ *
+ * @param index Index from vw_index_build (may be NULL)
+ */
+void vw_index_destroy(VWIndex* index);
+
+/**
+ * @brief Number of distinct vertices of the indexed ring
+ *
+ * @param index Index
+ * @return int64_t Vertex count, without a repeated closure point
+ */
+int64_t vw_index_num_points(const VWIndex* index);
+
+/**
+ * @brief Values per point of the indexed ring
+ *
+ * @param index Index
+ * @return int dims of the points the index was built from
+ */
+int vw_index_dims(const VWIndex* index);
+
+/**
+ * @brief Vertex count kept when removing every vertex of area <= threshold
+ *
+ * @param index     Index
+ * @param threshold Effective area threshold
+ * @return int64_t Number of vertices kept, at least 3 (ring) or 2 (line)
+ */
+int64_t vw_index_count_for_area(const VWIndex* index, double threshold);
+
+/**
+ * @brief Write the indexed ring simplified to target vertices
+ *
+ * @param index  Index
+ * @param target Number of vertices, from 3 (ring) or 2 (line) to
+ *               vw_index_num_points
+ * @param out    Receives target packed float64 points of vw_index_dims
+ *               values, plus a closure point for rings
+ * @return int VW_OK, VW_ERROR_MEMORY or VW_ERROR_INVALID
+ */
+int vw_index_extract(const VWIndex* index, int64_t target, double* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VW_H */